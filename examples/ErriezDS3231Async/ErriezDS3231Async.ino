@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*!
+ * \brief DS3231 high accurate RTC asynchronous read example for Arduino
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Time, status and temperature reads are queued and executed in small steps from loop(),
+ *      so the application is not blocked for a complete I2C read.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Async.h>
+
+// Create DS3231 RTC object
+ErriezDS3231 rtc;
+
+// Create asynchronous read engine
+ErriezDS3231Async rtcAsync(&rtc);
+
+// Number of loop() iterations between two results
+unsigned long loopCount = 0;
+
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC asynchronous read example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(100000);
+
+    // Initialize RTC
+    while (!rtc.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Queue first reads
+    rtcAsync.beginReadTime();
+    rtcAsync.beginReadStatus();
+    rtcAsync.beginReadTemperature();
+}
+
+void loop()
+{
+    static unsigned long lastPrint = 0;
+    struct tm dt;
+    uint8_t status;
+    int8_t temperature;
+    uint8_t fraction;
+
+    // Execute next I2C transfer, then continue with application work
+    if (rtcAsync.poll()) {
+        loopCount++;
+        return;
+    }
+
+    // All reads completed
+    if (rtcAsync.resultTime(&dt) && rtcAsync.resultStatus(&status) &&
+        rtcAsync.resultTemperature(&temperature, &fraction)) {
+        Serial.print(dt.tm_hour);
+        Serial.print(F(":"));
+        Serial.print(dt.tm_min);
+        Serial.print(F(":"));
+        Serial.print(dt.tm_sec);
+        Serial.print(F("  Status: 0x"));
+        Serial.print(status, HEX);
+        Serial.print(F("  Temperature: "));
+        Serial.print(temperature);
+        Serial.print(F("."));
+        Serial.print(fraction);
+        Serial.print(F("C  Loops: "));
+        Serial.println(loopCount);
+    }
+
+    // Queue next reads every second
+    if ((millis() - lastPrint) >= 1000) {
+        lastPrint = millis();
+        loopCount = 0;
+        rtcAsync.beginReadTime();
+        rtcAsync.beginReadStatus();
+        rtcAsync.beginReadTemperature();
+    }
+}
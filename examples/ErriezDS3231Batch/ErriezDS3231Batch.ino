@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC batched register writes example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *
+ *    Configures alarm 1, the alarm 1 interrupt and a disabled square wave with one batch.
+ *    The batch needs 2 I2C transactions instead of 9.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Batch.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) or D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#endif
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create register write batch
+ErriezDS3231Batch batch(&ds3231);
+
+// Alarm interrupt flag must be volatile
+volatile bool alarmInterrupt = false;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void alarmHandler()
+{
+    // Set global interrupt flag
+    alarmInterrupt = true;
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC batch example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!ds3231.isRunning()) {
+        Serial.println(F("Clock reset"));
+        ds3231.clockEnable();
+    }
+
+    // Attach to INT0 interrupt falling edge
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), alarmHandler, FALLING);
+
+    // Record alarm 1 every minute at 30 seconds with interrupt
+    batch.setAlarm1(Alarm1MatchSeconds, 0, 0, 0, 30);
+    batch.alarmInterruptEnable(Alarm1, true);
+    batch.setSquareWave(SquareWaveDisable);
+
+    // Write all edits
+    if (!batch.commit()) {
+        Serial.println(F("Commit failed"));
+    }
+
+    Serial.print(F("I2C transactions: "));
+    Serial.print(batch.getTransactions());
+    Serial.print(F(", saved: "));
+    Serial.println(batch.getSavedTransactions());
+}
+
+void loop()
+{
+    // Wait for alarm 1 interrupt
+    if (alarmInterrupt) {
+        alarmInterrupt = false;
+
+        Serial.print(F("Alarm 1: "));
+        Serial.println((uint32_t)ds3231.getEpoch());
+
+        // Clear alarm 1 flag to release the nINT/SQW pin
+        ds3231.clearAlarmFlag(Alarm1);
+    }
+}
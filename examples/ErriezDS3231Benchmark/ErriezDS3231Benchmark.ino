@@ -0,0 +1,331 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*!
+ * \brief DS3231 high accurate RTC epoch conversion benchmark for Arduino
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Compares the CPU cycles per conversion between the libc mktime() / gmtime() functions
+ *      and the built-in ErriezDS3231 calendar conversion, which converts directly between the
+ *      BCD register image and Unix epoch. No RTC is required for this benchmark.
+ *
+ *      It also compares the per-field BCD conversion of the 7 date and time registers with the
+ *      packed time image codec, which converts all registers at once on 32-bit and 64-bit
+ *      targets.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+
+// Number of conversions per test
+#define NUM_CONVERSIONS     1000
+
+// First test epoch: Sunday, September 6, 2020 18:20:30
+#define EPOCH_TEST          1599416430UL
+
+// Epoch increment per conversion: 1 day, 1 hour, 1 minute and 1 second
+#define EPOCH_STEP          90061UL
+
+// Number of logged register images per bulk decode
+#define NUM_RECORDS         16
+
+// Prevent the compiler from optimizing conversions away
+volatile uint32_t sink;
+
+// Logged register images and decoded fields
+uint8_t records[NUM_RECORDS * DS3231_TIME_IMAGE_SIZE];
+uint8_t fields[NUM_RECORDS * DS3231_TIME_IMAGE_SIZE];
+
+
+void printResult(const __FlashStringHelper *name, unsigned long duration)
+{
+    Serial.print(name);
+    Serial.print(F(": "));
+    Serial.print(duration);
+    Serial.print(F("us total, "));
+#ifdef F_CPU
+    Serial.print((float)duration * (F_CPU / 1000000UL) / NUM_CONVERSIONS);
+    Serial.println(F(" cycles per conversion"));
+#else
+    Serial.print((float)duration / NUM_CONVERSIONS);
+    Serial.println(F("us per conversion"));
+#endif
+}
+
+unsigned long benchmarkLibcToEpoch()
+{
+    struct tm dt;
+    time_t t = EPOCH_TEST;
+    unsigned long start;
+
+    memset(&dt, 0, sizeof(dt));
+    dt.tm_mday = 6;
+    dt.tm_mon = 8;
+    dt.tm_year = 120;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        dt.tm_sec = i % 60;
+        t = mktime(&dt);
+#ifdef ARDUINO_ARCH_AVR
+        t += UNIX_OFFSET;
+#endif
+        sink = t;
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkLibcFromEpoch()
+{
+    struct tm *dt;
+    time_t t = EPOCH_TEST;
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+#ifdef ARDUINO_ARCH_AVR
+        t = EPOCH_TEST - UNIX_OFFSET + (i * EPOCH_STEP);
+#else
+        t = EPOCH_TEST + (i * EPOCH_STEP);
+#endif
+        dt = gmtime(&t);
+        sink = dt->tm_mday;
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkRegistersToEpoch()
+{
+    uint8_t buffer[7];
+    time_t t;
+    unsigned long start;
+
+    ErriezDS3231::encodeEpochRegisters(EPOCH_TEST, buffer);
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        buffer[0] = ErriezDS3231::decToBcd(i % 60);
+        ErriezDS3231::decodeEpochRegisters(buffer, &t);
+        sink = t;
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkEpochToRegisters()
+{
+    uint8_t buffer[7];
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        ErriezDS3231::encodeEpochRegisters(EPOCH_TEST + (i * EPOCH_STEP), buffer);
+        sink = buffer[4];
+    }
+    return micros() - start;
+}
+
+void decodePerField(const uint8_t *buffer, uint8_t *dec)
+{
+    dec[0] = ErriezDS3231::bcdToDec(buffer[0] & 0x7F);
+    dec[1] = ErriezDS3231::bcdToDec(buffer[1] & 0x7F);
+    dec[2] = ErriezDS3231::bcdToDec(buffer[2] & 0x3F);
+    dec[3] = ErriezDS3231::bcdToDec(buffer[3] & 0x07);
+    dec[4] = ErriezDS3231::bcdToDec(buffer[4] & 0x3F);
+    dec[5] = ErriezDS3231::bcdToDec(buffer[5] & 0x1F);
+    dec[6] = ErriezDS3231::bcdToDec(buffer[6]);
+}
+
+void encodePerField(const uint8_t *dec, uint8_t *buffer)
+{
+    buffer[0] = ErriezDS3231::decToBcd(dec[0]) & 0x7F;
+    buffer[1] = ErriezDS3231::decToBcd(dec[1]) & 0x7F;
+    buffer[2] = ErriezDS3231::decToBcd(dec[2]) & 0x3F;
+    buffer[3] = ErriezDS3231::decToBcd(dec[3]) & 0x07;
+    buffer[4] = ErriezDS3231::decToBcd(dec[4]) & 0x3F;
+    buffer[5] = ErriezDS3231::decToBcd(dec[5]) & 0x1F;
+    buffer[6] = ErriezDS3231::decToBcd(dec[6]);
+}
+
+unsigned long benchmarkDecodePerField()
+{
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        decodePerField(&records[(i % NUM_RECORDS) * DS3231_TIME_IMAGE_SIZE], fields);
+        sink = fields[0];
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkDecodeImage()
+{
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        ErriezDS3231::decodeTimeImage(&records[(i % NUM_RECORDS) * DS3231_TIME_IMAGE_SIZE],
+                                      fields);
+        sink = fields[0];
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkDecodeImages()
+{
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i += NUM_RECORDS) {
+        ErriezDS3231::decodeTimeImages(records, fields, NUM_RECORDS);
+        sink = fields[0];
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkEncodePerField()
+{
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        encodePerField(&fields[(i % NUM_RECORDS) * DS3231_TIME_IMAGE_SIZE], buffer);
+        sink = buffer[0];
+    }
+    return micros() - start;
+}
+
+unsigned long benchmarkEncodeImage()
+{
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < NUM_CONVERSIONS; i++) {
+        ErriezDS3231::encodeTimeImage(&fields[(i % NUM_RECORDS) * DS3231_TIME_IMAGE_SIZE], buffer);
+        sink = buffer[0];
+    }
+    return micros() - start;
+}
+
+bool verifyTimeImage()
+{
+    uint8_t dec[DS3231_TIME_IMAGE_SIZE];
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+    uint8_t expected[DS3231_TIME_IMAGE_SIZE];
+
+    // Every value 0..99 in every register must match the per-field conversion
+    for (uint8_t value = 0; value < 100; value++) {
+        for (uint8_t i = 0; i < DS3231_TIME_IMAGE_SIZE; i++) {
+            dec[i] = (value + i * 13) % 100;
+        }
+        encodePerField(dec, expected);
+        ErriezDS3231::encodeTimeImage(dec, buffer);
+        if (memcmp(buffer, expected, sizeof(buffer)) != 0) {
+            return false;
+        }
+
+        decodePerField(buffer, expected);
+        ErriezDS3231::decodeTimeImage(buffer, dec);
+        if (memcmp(dec, expected, sizeof(dec)) != 0) {
+            return false;
+        }
+    }
+
+    // Bulk decode must match the single image decode
+    ErriezDS3231::decodeTimeImages(records, fields, NUM_RECORDS);
+    for (uint8_t i = 0; i < NUM_RECORDS; i++) {
+        decodePerField(&records[i * DS3231_TIME_IMAGE_SIZE], expected);
+        if (memcmp(&fields[i * DS3231_TIME_IMAGE_SIZE], expected, sizeof(expected)) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool verify()
+{
+    uint8_t buffer[7];
+    time_t t;
+
+    // Round trip every day in the years 2000..2099
+    for (uint16_t days = DAYS_FROM_1970_TO_2000; days < (DAYS_FROM_1970_TO_2000 + 36525U); days++) {
+        if (!ErriezDS3231::encodeEpochRegisters(days * 86400UL + 43199UL, buffer) ||
+            !ErriezDS3231::decodeEpochRegisters(buffer, &t) ||
+            ((uint32_t)t != (days * 86400UL + 43199UL))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC epoch conversion benchmark\n"));
+
+    // Verify built-in conversion
+    Serial.print(F("Verify 2000..2099: "));
+    Serial.println(verify() ? F("Passed") : F("Failed"));
+
+    // Run benchmarks
+    printResult(F("libc mktime()               "), benchmarkLibcToEpoch());
+    printResult(F("ErriezDS3231 registers->epoch"), benchmarkRegistersToEpoch());
+    printResult(F("libc gmtime()               "), benchmarkLibcFromEpoch());
+    printResult(F("ErriezDS3231 epoch->registers"), benchmarkEpochToRegisters());
+
+    // Log one register image per day
+    for (uint8_t i = 0; i < NUM_RECORDS; i++) {
+        ErriezDS3231::encodeEpochRegisters(EPOCH_TEST + (i * EPOCH_STEP),
+                                           &records[i * DS3231_TIME_IMAGE_SIZE]);
+    }
+
+    // Verify time image codec
+    Serial.print(F("\nVerify time image codec: "));
+    Serial.println(verifyTimeImage() ? F("Passed") : F("Failed"));
+    Serial.print(F("Packed word size: "));
+    Serial.print(DS3231_BCD_SWAR_BITS);
+    Serial.println(F(" bits"));
+
+    // Run time image benchmarks
+    printResult(F("Per-field registers->fields "), benchmarkDecodePerField());
+    printResult(F("Time image registers->fields"), benchmarkDecodeImage());
+    printResult(F("Bulk registers->fields      "), benchmarkDecodeImages());
+    printResult(F("Per-field fields->registers "), benchmarkEncodePerField());
+    printResult(F("Time image fields->registers"), benchmarkEncodeImage());
+}
+
+void loop()
+{
+}
@@ -0,0 +1,182 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC aging offset calibration example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *    Connect a 1Hz PPS reference, for example from a GPS receiver, to a second interrupt pin
+ *
+ *    Measures the 1Hz SQW edges against the PPS reference and steps the aging offset register
+ *    until the RTC frequency error is below half an aging offset LSB (about 50ppb).
+ *    Calibrate at a stable temperature, preferably 25 degree Celsius.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Calibration.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) and D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4) and D1 (INT3)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0) and D5 (GPIO14)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#define PPS_PIN     3
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#define PPS_PIN     1
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#define PPS_PIN     14
+#endif
+
+// Measurement window in seconds
+#define WINDOW_SECONDS  120
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create aging offset calibration
+ErriezDS3231Calibration calibration(&ds3231);
+
+// Interrupt variables must be volatile
+volatile uint32_t ppsMicros = 0;
+volatile uint32_t ppsCount = 0;
+volatile uint32_t sqwRefMicros = 0;
+volatile bool sqwInterrupt = false;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void ppsHandler()
+{
+    // Start of a reference second
+    ppsMicros = micros();
+    ppsCount++;
+}
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void sqwHandler()
+{
+    // Reference timestamp of the SQW edge: reference seconds plus time since the PPS edge
+    sqwRefMicros = (ppsCount * 1000000UL) + (micros() - ppsMicros);
+    sqwInterrupt = true;
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC aging offset calibration example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable oscillator
+    ds3231.clockEnable(true);
+
+    // Attach to SQW and PPS interrupt falling edges
+    pinMode(INT_PIN, INPUT_PULLUP);
+    pinMode(PPS_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(PPS_PIN), ppsHandler, RISING);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), sqwHandler, FALLING);
+
+    // Start calibration, enables the 1Hz SQW output
+    if (!calibration.begin(WINDOW_SECONDS)) {
+        Serial.println(F("Calibration start failed"));
+    }
+
+    Serial.print(F("Aging offset: "));
+    Serial.println(calibration.getAgingOffset());
+    Serial.println(F("Measuring..."));
+}
+
+void loop()
+{
+    uint32_t refMicros;
+    uint8_t steps;
+
+    if (!sqwInterrupt) {
+        return;
+    }
+
+    // Copy reference timestamp with interrupts disabled
+    noInterrupts();
+    refMicros = sqwRefMicros;
+    sqwInterrupt = false;
+    interrupts();
+
+    steps = calibration.getSteps();
+
+    if (!calibration.addEdge(refMicros)) {
+        Serial.println(F("Aging offset write failed"));
+    }
+
+    // Print result of each measurement window
+    if (calibration.getSteps() != steps) {
+        Serial.print(F("Error: "));
+        Serial.print(calibration.getErrorPpb());
+        Serial.print(F("ppb, new aging offset: "));
+        Serial.println(calibration.getAgingOffset());
+    }
+
+    switch (calibration.getState()) {
+        case CalConverged:
+            Serial.print(F("Calibrated, error: "));
+            Serial.print(calibration.getErrorPpb());
+            Serial.print(F("ppb, aging offset: "));
+            Serial.println(calibration.getAgingOffset());
+            while (1) {
+                ;
+            }
+        case CalFailed:
+            Serial.print(F("Calibration failed, error: "));
+            Serial.print(calibration.getErrorPpb());
+            Serial.println(F("ppb"));
+            while (1) {
+                ;
+            }
+        default:
+            break;
+    }
+}
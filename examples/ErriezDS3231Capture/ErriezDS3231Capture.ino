@@ -0,0 +1,166 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC event timestamp capture example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *    Connect a push button between the event pin and GND
+ *
+ *    The event interrupt handler stores a timestamp without I2C transfer. The loop converts
+ *    all queued events to RTC time with a single register read.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Capture.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) and D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4) and D1 (INT3)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0) and D5 (GPIO14)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#define EVENT_PIN   3
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#define EVENT_PIN   1
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#define EVENT_PIN   14
+#endif
+
+// Number of queued events + 1
+#define CAPTURE_SIZE    16
+
+// Create DS3231 RTC object
+ErriezDS3231 rtc;
+
+// Create capture queue
+DS3231CaptureEvent captureBuffer[CAPTURE_SIZE];
+ErriezDS3231Capture capture(&rtc, captureBuffer, CAPTURE_SIZE, micros);
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void sqwHandler()
+{
+    // Count SQW edges
+    capture.tick();
+}
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void eventHandler()
+{
+    // Store event timestamp
+    capture.capture(0);
+}
+
+void printTime(const DS3231CaptureTime *t)
+{
+    uint32_t div = 100000UL;
+
+    Serial.print(F("Event "));
+    Serial.print(t->source);
+    Serial.print(F(": "));
+    Serial.print(t->epoch);
+    Serial.print(F("."));
+    while ((div > 1) && (t->micros < div)) {
+        Serial.print(F("0"));
+        div /= 10;
+    }
+    Serial.println(t->micros);
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 event capture example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!rtc.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!rtc.isRunning()) {
+        Serial.println(F("Clock reset"));
+        rtc.clockEnable();
+    }
+
+    // Disable 32kHz output pin which is not needed for this example
+    rtc.outputClockPinEnable(false);
+
+    // Attach to SQW and event interrupt falling edges
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), sqwHandler, FALLING);
+    pinMode(EVENT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(EVENT_PIN), eventHandler, FALLING);
+
+    // Enable 1Hz square wave and align with the seconds register
+    while (!capture.begin(SquareWave1Hz)) {
+        Serial.println(F("Capture begin failed"));
+        delay(3000);
+    }
+
+    Serial.println(F("Press the button..."));
+}
+
+void loop()
+{
+    static uint16_t overflowsLast = 0;
+    DS3231CaptureTime times[CAPTURE_SIZE];
+    uint8_t count;
+
+    // Convert queued events with one register read
+    count = capture.drain(times, CAPTURE_SIZE);
+    for (uint8_t i = 0; i < count; i++) {
+        printTime(&times[i]);
+    }
+
+    if (capture.getOverflows() != overflowsLast) {
+        overflowsLast = capture.getOverflows();
+        Serial.print(F("Lost events: "));
+        Serial.println(overflowsLast);
+    }
+
+    delay(100);
+}
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC cron schedule example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *
+ *    Runs a job every 15 minutes on weekdays with alarm 2. Alarm 2 is programmed with the next
+ *    fire time after every match, so the MCU only wakes up when the job must run.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Cron.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) or D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#endif
+
+// Cron expression: minute hour day-of-month month day-of-week
+#define CRON_EXPRESSION     "0,15,30,45 * * * 1-5"
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create cron schedule on alarm 2
+ErriezDS3231Cron cron(&ds3231);
+
+// Alarm interrupt flag must be volatile
+volatile bool alarmInterrupt = false;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void alarmHandler()
+{
+    // Set global interrupt flag
+    alarmInterrupt = true;
+}
+
+void setup()
+{
+    uint32_t next;
+
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC cron example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!ds3231.isRunning()) {
+        Serial.println(F("Clock reset"));
+        ds3231.clockEnable();
+    }
+
+    // Parse schedule
+    if (!cron.parse(CRON_EXPRESSION)) {
+        Serial.println(F("Invalid cron expression"));
+        while (1) {
+            ;
+        }
+    }
+
+    // Attach to INT0 interrupt falling edge
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), alarmHandler, FALLING);
+
+    // Program alarm 2
+    if (!cron.begin()) {
+        Serial.println(F("Cron begin failed"));
+    }
+
+    Serial.print(F("Alarm 2 programmed "));
+    Serial.println(cron.isPersistent() ? F("once") : F("after every match"));
+
+    if (cron.nextFire((uint32_t)ds3231.getEpoch(), &next)) {
+        Serial.print(F("Next: "));
+        Serial.println(next);
+    }
+}
+
+void loop()
+{
+    bool matched;
+
+    // Handle alarm 2 on every nINT/SQW pin falling edge
+    if (alarmInterrupt) {
+        alarmInterrupt = false;
+
+        if (!cron.service(&matched)) {
+            Serial.println(F("Cron service failed"));
+        } else if (matched) {
+            Serial.print(F("Job "));
+            Serial.print(cron.getMatches());
+            Serial.print(F(", spurious wakeups: "));
+            Serial.println(cron.getSpuriousWakeups());
+        }
+    }
+
+    // The MCU could sleep here until the next alarm interrupt
+}
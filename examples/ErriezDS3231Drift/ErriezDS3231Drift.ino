@@ -0,0 +1,165 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC temperature drift compensation example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Measures the temperature every 64 seconds and prints the RTC time corrected by the drift
+ *    model. A host sends the measured RTC offset to a time reference as a line with the offset
+ *    in microseconds, RTC minus reference, for example "1250" when the RTC is 1.25ms ahead.
+ *    The model is stored in EEPROM on AVR targets.
+ */
+
+#include <Wire.h>
+#if defined(ARDUINO_ARCH_AVR)
+#include <EEPROM.h>
+#endif
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Drift.h>
+#include <ErriezDS3231TempMonitor.h>
+
+// Temperature measurement interval in ms
+#define INTERVAL_MS     64000
+
+// EEPROM address of the drift model
+#define EEPROM_ADDR     0
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create drift model and temperature monitor
+ErriezDS3231Drift drift(&ds3231);
+int16_t history[4];
+ErriezDS3231TempMonitor monitor(&ds3231, history, sizeof(history) / sizeof(history[0]));
+
+unsigned long lastStart;
+
+
+void printCorrectedTime()
+{
+    uint32_t epoch;
+    uint16_t ms;
+
+    if (!drift.getEpoch(&epoch, &ms)) {
+        Serial.println(F("RTC read failed"));
+        return;
+    }
+
+    Serial.print(F("Corrected epoch: "));
+    Serial.print(epoch);
+    Serial.print(F("."));
+    if (ms < 100) {
+        Serial.print(F("0"));
+    }
+    if (ms < 10) {
+        Serial.print(F("0"));
+    }
+    Serial.println(ms);
+}
+
+void handleSerial()
+{
+    static char line[12];
+    static uint8_t len = 0;
+    int c;
+
+    while ((c = Serial.read()) >= 0) {
+        if ((c != '\n') && (c != '\r')) {
+            if (len < (sizeof(line) - 1)) {
+                line[len++] = (char)c;
+            }
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+
+        // Fit the model with the reference offset
+        drift.sync((uint32_t)ds3231.getEpoch(), atol(line));
+        Serial.println(F("Synchronized"));
+
+#if defined(ARDUINO_ARCH_AVR)
+        EEPROM.put(EEPROM_ADDR, *drift.getModel());
+#endif
+    }
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC drift compensation example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+#if defined(ARDUINO_ARCH_AVR)
+    // Load drift model
+    DS3231DriftModel model;
+    EEPROM.get(EEPROM_ADDR, model);
+    if (!drift.setModel(&model)) {
+        Serial.println(F("No drift model in EEPROM"));
+    }
+#endif
+
+    // Start first conversion
+    monitor.start();
+    lastStart = millis();
+}
+
+void loop()
+{
+    int16_t centiDegrees;
+
+    // Add temperature measurement to the model
+    if (monitor.poll(&centiDegrees)) {
+        drift.update((uint32_t)ds3231.getEpoch(), centiDegrees);
+        printCorrectedTime();
+    }
+
+    // Start next conversion
+    if ((millis() - lastStart) >= INTERVAL_MS) {
+        lastStart = millis();
+        monitor.start();
+    }
+
+    handleSerial();
+}
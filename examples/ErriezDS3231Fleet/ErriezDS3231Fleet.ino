@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC fleet example for Arduino
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Four DS3231 RTCs are connected to channels 0..3 of a TCA9548A I2C multiplexer at address
+ *      0x70. All RTCs are polled every 5 ms in one sweep. Every second the date/time, oscillator
+ *      stop flag and the skew to the RTC on channel 0 are printed.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Fleet.h>
+
+// Number of RTCs on mux channels 0..NUM_RTCS-1
+#define NUM_RTCS        4
+
+// Poll interval in us, the skew resolution is half the interval
+#define POLL_US         5000UL
+
+// Create mux on the Wire bus
+ErriezDS3231WireTransport wireBus(Wire);
+ErriezDS3231Mux mux(&wireBus, DS3231_MUX_ADDR);
+
+// Create one transport and RTC per mux channel
+ErriezDS3231MuxTransport channels[NUM_RTCS] = {
+    ErriezDS3231MuxTransport(&mux, 0),
+    ErriezDS3231MuxTransport(&mux, 1),
+    ErriezDS3231MuxTransport(&mux, 2),
+    ErriezDS3231MuxTransport(&mux, 3),
+};
+ErriezDS3231 rtcs[NUM_RTCS] = {
+    ErriezDS3231(&channels[0]),
+    ErriezDS3231(&channels[1]),
+    ErriezDS3231(&channels[2]),
+    ErriezDS3231(&channels[3]),
+};
+
+// Create fleet
+ErriezDS3231Fleet fleet(&mux, micros);
+
+unsigned long lastPoll;
+unsigned long lastPrint;
+
+
+void printFleet()
+{
+    for (uint8_t i = 0; i < fleet.count(); i++) {
+        Serial.print(F("Channel "));
+        Serial.print(fleet.getChannel(i));
+        if (!fleet.isValid(i)) {
+            Serial.println(F(": read failed"));
+            continue;
+        }
+        Serial.print(F(": epoch "));
+        Serial.print(fleet.getEpoch(i));
+        if (fleet.getStatus(i) & (1 << DS3231_STAT_OSF)) {
+            Serial.print(F(" OSF"));
+        }
+        if (fleet.isSkewValid(i)) {
+            Serial.print(F(", skew "));
+            Serial.print(fleet.getSkew(i));
+            Serial.print(F("us, min "));
+            Serial.print(fleet.getSkewMin(i));
+            Serial.print(F("us, max "));
+            Serial.print(fleet.getSkewMax(i));
+            Serial.print(F("us, mean "));
+            Serial.print(fleet.getSkewMean(i));
+            Serial.print(F("us"));
+        }
+        Serial.println();
+    }
+
+    Serial.print(F("Spread: "));
+    Serial.print(fleet.getSpread());
+    Serial.print(F("us, sweeps: "));
+    Serial.print(fleet.getSweeps());
+    Serial.print(F(", channel switches: "));
+    Serial.print(mux.getSwitches());
+    Serial.print(F(", errors: "));
+    Serial.println(fleet.getErrors());
+    Serial.println();
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC fleet example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTCs
+    for (uint8_t i = 0; i < NUM_RTCS; i++) {
+        if (!rtcs[i].begin()) {
+            Serial.print(F("RTC not found on channel "));
+            Serial.println(i);
+            continue;
+        }
+        fleet.add(&rtcs[i], i);
+    }
+
+    lastPoll = micros();
+    lastPrint = millis();
+}
+
+void loop()
+{
+    // Poll all RTCs in one sweep
+    if ((micros() - lastPoll) >= POLL_US) {
+        lastPoll += POLL_US;
+        fleet.poll();
+    }
+
+    // Print results
+    if ((millis() - lastPrint) >= 1000) {
+        lastPrint += 1000;
+        printFleet();
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC software alarm scheduler example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *
+ *    Schedules more events than hardware alarms with alarm 1:
+ *      Sample every 10 seconds
+ *      Uplink every minute
+ *      Maintenance once, 95 seconds after startup
+ *    The MCU could sleep between alarm interrupts.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Scheduler.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) or D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#endif
+
+// Application event IDs
+#define EVENT_SAMPLE        0
+#define EVENT_UPLINK        1
+#define EVENT_MAINTENANCE   2
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create scheduler with a static event pool
+DS3231Event events[4];
+ErriezDS3231Scheduler scheduler(&ds3231, events, sizeof(events) / sizeof(events[0]));
+
+// Alarm interrupt flag must be volatile
+volatile bool alarmInterrupt = false;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void alarmHandler()
+{
+    // Set global interrupt flag
+    alarmInterrupt = true;
+}
+
+void eventHandler(uint8_t id, uint32_t epoch)
+{
+    switch (id) {
+        case EVENT_SAMPLE:
+            Serial.print(F("Sample: "));
+            break;
+        case EVENT_UPLINK:
+            Serial.print(F("Uplink: "));
+            break;
+        case EVENT_MAINTENANCE:
+            Serial.print(F("Maintenance: "));
+            break;
+        default:
+            break;
+    }
+    Serial.println(epoch);
+}
+
+void setup()
+{
+    uint32_t now;
+
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC scheduler example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!ds3231.isRunning()) {
+        Serial.println(F("Clock reset"));
+        ds3231.clockEnable();
+    }
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    // Skip read-modify-write of the alarm and status registers
+    ds3231.shadowCacheEnable(true);
+#endif
+
+    // Attach to INT0 interrupt falling edge
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), alarmHandler, FALLING);
+
+    // Schedule events
+    now = (uint32_t)ds3231.getEpoch();
+    scheduler.begin();
+    scheduler.schedule(EVENT_SAMPLE, now + 10, 10, eventHandler);
+    scheduler.schedule(EVENT_UPLINK, now + 60, 60, eventHandler);
+    scheduler.schedule(EVENT_MAINTENANCE, now + 95, 0, eventHandler);
+
+    Serial.println(F("Waiting for events..."));
+}
+
+void loop()
+{
+    // Dispatch due events on every nINT/SQW pin falling edge
+    if (alarmInterrupt) {
+        alarmInterrupt = false;
+
+        if (!scheduler.service()) {
+            Serial.println(F("Scheduler failed"));
+        }
+    }
+
+    // The MCU could sleep here until the next alarm interrupt
+}
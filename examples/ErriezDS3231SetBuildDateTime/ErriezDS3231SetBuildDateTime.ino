@@ -27,10 +27,14 @@
  * \details
  *    Source:         https://github.com/Erriez/ErriezDS3231
  *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    The build date and time are converted to a BCD register image at compile time, so no
+ *    date/time parsing code is linked in.
  */
 
 #include <Wire.h>
 #include <ErriezDS3231.h>
+#include <ErriezDS3231BuildTime.h>
 
 // Create DS3231 RTC object
 ErriezDS3231 rtc;
@@ -38,6 +42,9 @@ ErriezDS3231 rtc;
 // Global date/time object
 struct tm dt;
 
+// The RTC supports years 2000..2099
+static_assert(DS3231_BUILD_TIME_VALID, "Build date out of range");
+
 
 void rtcInit()
 {
@@ -55,83 +62,24 @@ void rtcInit()
     rtc.setSquareWave(SquareWaveDisable);
 }
 
-bool getBuildTime(const char *str)
-{
-    int hour;
-    int minute;
-    int second;
-
-    // Convert build time macro to time
-    if (sscanf(str, "%d:%d:%d", &hour, &minute, &second) != 3) {
-        return false;
-    }
-
-    dt.tm_hour = hour;
-    dt.tm_min = minute;
-    dt.tm_sec = second;
-
-    return true;
-}
-
-bool getBuildDate(const char *str)
-{
-    const char *monthName[] = {
-        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-    };
-    uint8_t monthIndex;
-    char month[12];
-    int dayMonth;
-    int year;
-    time_t t;
-
-    // Convert build time macro to date
-    if (sscanf(str, "%s %d %d", month, &dayMonth, &year) != 3) {
-        return false;
-    }
-
-    // Convert month string to month number
-    for (monthIndex = 0; monthIndex < 12; monthIndex++) {
-        if (strcmp(month, monthName[monthIndex]) == 0) {
-            break;
-        }
-    }
-    if (monthIndex >= 12) {
-        // Not found
-        return false;
-    }
-
-    // Set date
-    dt.tm_mday = dayMonth;
-    dt.tm_mon = monthIndex;
-    dt.tm_year = year - 1900;
-
-    // Calculate day of the week
-    t = mktime(&dt);
-    dt.tm_wday = localtime(&t)->tm_wday;
-
-    return true;
-}
-
 bool rtcSetDateTime()
 {
-    // Convert compile date/time to date/time string
-    if (!getBuildDate(__DATE__) || !getBuildTime(__TIME__)) {
-        Serial.print(F("Build date/time error"));
-        return false;
-    }
+    // Date and time registers calculated by the compiler from __DATE__ and __TIME__
+    constexpr uint8_t buildTime[DS3231_TIME_IMAGE_SIZE] = DS3231_BUILD_TIME_IMAGE;
 
     // Print build date/time
     Serial.print(F("Build date time: "));
-    Serial.println(asctime(&dt));
+    Serial.print(F(__DATE__ " " __TIME__));
+    Serial.print(F(", epoch "));
+    Serial.println(DS3231_BUILD_EPOCH);
 
-    // Set new date time
+    // Set new date time in a single register write
     Serial.print(F("Set RTC date time..."));
-    if (!rtc.write(&dt)) {
+    if (!rtc.writeBuffer(DS3231_REG_SECONDS, buildTime, sizeof(buildTime))) {
         Serial.println(F("FAILED"));
-    } else {
-        Serial.println(F("OK"));
+        return false;
     }
+    Serial.println(F("OK"));
 
     return true;
 }
@@ -155,7 +103,7 @@ void setup()
 
     // Set date/time
     if (!rtcSetDateTime()) {
-        // Could not parse build date/time to program RTC
+        // Could not program RTC
         while (1) {
             delay(1000);
         }
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC simulator example for Arduino
+ * \details
+ *      Runs the library against the behavioural DS3231 simulator without RTC hardware. Prints
+ *      the I2C transactions and bytes per API call, then simulates one year of operation with
+ *      virtual time and counts the alarm matches.
+ *
+ *      The simulator has no platform dependencies and can also be linked in a Linux host program
+ *      together with the library sources.
+ *
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <ErriezDS3231Simulator.h>
+
+// Create simulated DS3231 RTC
+ErriezDS3231Simulator sim;
+ErriezDS3231 ds3231(&sim);
+
+
+void printCost(const __FlashStringHelper *name)
+{
+    Serial.print(name);
+    Serial.print(F(": transactions="));
+    Serial.print(sim.getTransactions());
+    Serial.print(F(" written="));
+    Serial.print(sim.getBytesWritten());
+    Serial.print(F(" read="));
+    Serial.println(sim.getBytesRead());
+    sim.resetCounters();
+}
+
+void setup()
+{
+    struct tm dt;
+    int8_t temperature;
+    uint8_t fraction;
+    unsigned long start;
+
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC simulator example\n"));
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Transactions and bytes per API call
+    sim.resetCounters();
+    ds3231.clockEnable(true);
+    printCost(F("clockEnable"));
+
+    ds3231.setEpoch(1577836800UL); // 1 January 2020 00:00:00
+    printCost(F("setEpoch"));
+
+    ds3231.getEpoch();
+    printCost(F("getEpoch"));
+
+    ds3231.read(&dt);
+    printCost(F("read"));
+
+    ds3231.setAlarm1(Alarm1MatchSeconds, 0, 0, 0, 0);
+    printCost(F("setAlarm1"));
+
+    ds3231.alarmInterruptEnable(Alarm1, true);
+    printCost(F("alarmInterruptEnable"));
+
+    ds3231.startTemperatureConversion();
+    ds3231.getTemperature(&temperature, &fraction);
+    printCost(F("startTemperatureConversion + getTemperature"));
+
+    // Simulate one year of operation with virtual time
+    Serial.println(F("\nSimulating one year..."));
+    start = millis();
+    sim.advanceSeconds(366UL * 24 * 60 * 60);
+
+    Serial.print(F("Alarm 1 matches: "));
+    Serial.println(sim.getAlarmMatches(Alarm1));
+    Serial.print(F("INT pin: "));
+    Serial.println(sim.getIntSqwPin() ? F("high") : F("low"));
+    Serial.print(F("Epoch: "));
+    Serial.println((uint32_t)ds3231.getEpoch());
+    Serial.print(F("Duration: "));
+    Serial.print(millis() - start);
+    Serial.println(F("ms"));
+}
+
+void loop()
+{
+}
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC low-energy wake-up example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *
+ *    Alarm 1 wakes the MCU every SLEEP_SECONDS with two I2C transactions per cycle: one to arm
+ *    the alarm and one to read the time and status after the wake-up. BBSQW is set, so the RTC
+ *    VCC may be switched off during sleep.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231Sleep.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) or D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#endif
+
+// Wake-up interval
+#define SLEEP_SECONDS   10
+
+// Create DS3231 RTC object
+ErriezDS3231 rtc;
+
+// Create sleep object
+ErriezDS3231Sleep rtcSleep(&rtc);
+
+// Wake-up interrupt flag must be volatile
+volatile bool wakeInterrupt = false;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void wakeHandler()
+{
+    // Set global interrupt flag
+    wakeInterrupt = true;
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 low-energy wake-up example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!rtc.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!rtc.isRunning()) {
+        Serial.println(F("Clock reset"));
+        rtc.clockEnable();
+    }
+
+    // Attach to INT0 interrupt falling edge
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), wakeHandler, FALLING);
+
+    // Precompute register images with wake-up on V-BAT
+    while (!rtcSleep.begin(true)) {
+        Serial.println(F("Sleep begin failed"));
+        delay(3000);
+    }
+
+    // Read time and release the INT/SQW pin
+    if (!rtcSleep.onWake() || !rtcSleep.sleepUntil(rtcSleep.getWakeEpoch() + SLEEP_SECONDS)) {
+        Serial.println(F("Arm wake-up failed"));
+    }
+}
+
+void loop()
+{
+    if (wakeInterrupt) {
+        wakeInterrupt = false;
+
+        // Clear alarm 1 and read time and status in one transaction
+        if (!rtcSleep.onWake()) {
+            Serial.println(F("Wake-up failed"));
+            return;
+        }
+
+        Serial.print(F("Wake-up: "));
+        Serial.print((uint32_t)rtcSleep.getWakeEpoch());
+        if (!rtcSleep.isAlarmWake()) {
+            Serial.print(F(" (early)"));
+        }
+        if (rtcSleep.getStatus() & (1 << DS3231_STAT_OSF)) {
+            Serial.print(F(" (oscillator stopped)"));
+        }
+        Serial.print(F("  I2C transactions: "));
+        Serial.println(rtcSleep.getTransactions());
+
+        // Arm the next wake-up in one transaction
+        if (!rtcSleep.sleepUntil(rtcSleep.getWakeEpoch() + SLEEP_SECONDS)) {
+            Serial.println(F("Arm wake-up failed"));
+        }
+        Serial.flush();
+    }
+
+    // Enter MCU deep sleep here, the INT/SQW falling edge wakes the MCU
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*!
+ * \brief DS3231 high accurate RTC SQW disciplined software clock example for Arduino
+ * \details
+ *    Source:         https://github.com/Erriez/ErriezDS3231
+ *    Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *    Connect the nINT/SQW pin to an Arduino interrupt pin
+ *
+ *    The 1Hz square wave falling edge increments a software clock. getEpoch() returns the
+ *    epoch from RAM and reads the RTC registers only every resync interval.
+ *
+ *    The software clock must be enabled for the library and the sketch with the same define, for
+ *    example in platformio.ini:
+ *        build_flags = -DERRIEZ_DS3231_SOFT_CLOCK
+ *    or by uncommenting ERRIEZ_DS3231_SOFT_CLOCK in ErriezDS3231.h.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+
+// Uno, Nano, Mini, other 328-based: pin D2 (INT0) or D3 (INT1)
+// DUE: Any digital pin
+// Leonardo: pin D7 (INT4)
+// ESP8266 / NodeMCU / WeMos D1&R2: pin D3 (GPIO0)
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_SAM_DUE)
+#define INT_PIN     2
+#elif defined(ARDUINO_AVR_LEONARDO)
+#define INT_PIN     7
+#else
+#define INT_PIN     0 // GPIO0 pin for ESP8266 / ESP32 targets
+#endif
+
+// Resync software clock with RTC registers every 10 minutes
+#define RESYNC_MINUTES  10
+
+// Create DS3231 RTC object
+ErriezDS3231 rtc;
+
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void sqwHandler()
+{
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // Increment software clock
+    rtc.softClockTick();
+#endif
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 software clock example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!rtc.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!rtc.isRunning()) {
+        Serial.println(F("Clock reset"));
+        rtc.clockEnable();
+    }
+
+    // Attach to INT0 interrupt falling edge
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), sqwHandler, FALLING);
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // Enable 1Hz square wave and software clock
+    if (!rtc.softClockEnable(RESYNC_MINUTES)) {
+        Serial.println(F("Software clock enable failed"));
+    }
+#else
+    Serial.println(F("Define ERRIEZ_DS3231_SOFT_CLOCK to enable the software clock"));
+#endif
+}
+
+void loop()
+{
+    static time_t tLast = 0;
+    time_t t;
+
+    // Read epoch from RAM
+    t = rtc.getEpoch();
+
+    if (t != tLast) {
+        tLast = t;
+
+        Serial.print(F("Epoch: "));
+        Serial.print((uint32_t)t);
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+        Serial.print(F("  Resyncs: "));
+        Serial.print(rtc.getSoftClockResyncs());
+        Serial.print(F("  Drift events: "));
+        Serial.print(rtc.getSoftClockDriftEvents());
+        Serial.print(F("  Drift: "));
+        Serial.print(rtc.getSoftClockDrift());
+        Serial.print(F("s"));
+#endif
+        Serial.println();
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC I2C instrumentation example for Arduino
+ * \details
+ *      Prints the I2C transactions per API, bytes, failures and the transaction latency
+ *      histogram.
+ *
+ *      Instrumentation must be enabled for the library and the sketch with the same define, for
+ *      example in platformio.ini:
+ *          build_flags = -DERRIEZ_DS3231_STATS
+ *      or by uncommenting ERRIEZ_DS3231_STATS in ErriezDS3231.h.
+ *
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+#ifdef ERRIEZ_DS3231_STATS
+// API group names
+const char apiNames[StatsApiNum][12] PROGMEM = {
+    "Other", "Begin", "Oscillator", "GetEpoch", "SetEpoch", "Read", "Write", "GetTime",
+    "SetTime", "Alarm", "AlarmFlag", "Output", "AgingOffset", "Temperature", "Snapshot",
+    "SoftClock", "Register"
+};
+
+void printStats()
+{
+    DS3231Stats stats;
+    char name[12];
+    unsigned long limit = DS3231_STATS_BUCKET_US;
+
+    ds3231.getStats(&stats);
+
+    Serial.println(F("Transactions per API:"));
+    for (uint8_t i = 0; i < StatsApiNum; i++) {
+        if (stats.transactions[i]) {
+            strncpy_P(name, apiNames[i], sizeof(name));
+            Serial.print(F("  "));
+            Serial.print(name);
+            Serial.print(F(": "));
+            Serial.println(stats.transactions[i]);
+        }
+    }
+
+    Serial.print(F("Bytes written: "));
+    Serial.println(stats.bytesWritten);
+    Serial.print(F("Bytes read: "));
+    Serial.println(stats.bytesRead);
+    Serial.print(F("NACK errors: "));
+    Serial.println(stats.nackErrors);
+    Serial.print(F("Short reads: "));
+    Serial.println(stats.shortReads);
+
+    Serial.println(F("Latency:"));
+    for (uint8_t i = 0; i < DS3231_STATS_BUCKETS; i++) {
+        if (i < (DS3231_STATS_BUCKETS - 1)) {
+            Serial.print(F("  <"));
+            Serial.print(limit);
+        } else {
+            Serial.print(F("  >="));
+            Serial.print(limit >> 1);
+        }
+        Serial.print(F("us: "));
+        Serial.println(stats.latency[i]);
+        limit <<= 1;
+    }
+}
+#endif
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC I2C instrumentation example\n"));
+
+#ifndef ERRIEZ_DS3231_STATS
+    Serial.println(F("Define ERRIEZ_DS3231_STATS to enable instrumentation"));
+#endif
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Enable RTC clock
+    if (!ds3231.isRunning()) {
+        ds3231.clockEnable();
+    }
+}
+
+void loop()
+{
+    struct tm dt;
+    int8_t temperature;
+    uint8_t fraction;
+
+    // Application workload
+    for (uint8_t i = 0; i < 10; i++) {
+        ds3231.getEpoch();
+        ds3231.read(&dt);
+        ds3231.getAlarmFlag(Alarm1);
+        ds3231.getTemperature(&temperature, &fraction);
+    }
+
+#ifdef ERRIEZ_DS3231_STATS
+    printStats();
+    ds3231.resetStats();
+    Serial.println();
+#endif
+
+    // Wait some time
+    delay(5000);
+}
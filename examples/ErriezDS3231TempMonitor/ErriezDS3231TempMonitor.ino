@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \brief DS3231 high accurate RTC non-blocking temperature monitor example for Arduino
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Starts a temperature conversion every 5 seconds and polls for the result without
+ *      blocking loop() during the conversion. Prints the result with minimum, maximum and the
+ *      mean of the last 8 results, without floating point.
+ */
+
+#include <Wire.h>
+
+#include <ErriezDS3231.h>
+#include <ErriezDS3231TempMonitor.h>
+
+// Conversion interval in ms
+#define INTERVAL_MS     5000
+
+// Create DS3231 RTC object
+ErriezDS3231 ds3231;
+
+// Create temperature monitor with a history of 8 results
+int16_t history[8];
+ErriezDS3231TempMonitor monitor(&ds3231, history, sizeof(history) / sizeof(history[0]));
+
+unsigned long lastStart;
+
+
+void printTemperature(int16_t centiDegrees)
+{
+    if (centiDegrees < 0) {
+        Serial.print(F("-"));
+        centiDegrees = -centiDegrees;
+    }
+    Serial.print(centiDegrees / 100);
+    Serial.print(F("."));
+    if ((centiDegrees % 100) < 10) {
+        Serial.print(F("0"));
+    }
+    Serial.print(centiDegrees % 100);
+    Serial.print(F("C"));
+}
+
+void setup()
+{
+    // Initialize serial port
+    delay(500);
+    Serial.begin(115200);
+    while (!Serial) {
+        ;
+    }
+    Serial.println(F("\nErriez DS3231 RTC temperature monitor example\n"));
+
+    // Initialize TWI
+    Wire.begin();
+    Wire.setClock(400000);
+
+    // Initialize RTC
+    while (!ds3231.begin()) {
+        Serial.println(F("RTC not found"));
+        delay(3000);
+    }
+
+    // Start first conversion
+    monitor.start();
+    lastStart = millis();
+}
+
+void loop()
+{
+    int16_t centiDegrees;
+
+    // Check conversion without waiting
+    if (monitor.poll(&centiDegrees)) {
+        printTemperature(centiDegrees);
+        Serial.print(F("  min: "));
+        printTemperature(monitor.getMin());
+        Serial.print(F("  max: "));
+        printTemperature(monitor.getMax());
+        Serial.print(F("  mean: "));
+        printTemperature(monitor.getMean());
+        Serial.println();
+    }
+
+    // Start next conversion
+    if ((millis() - lastStart) >= INTERVAL_MS) {
+        lastStart = millis();
+        if (!monitor.start()) {
+            Serial.println(F("Start conv failed"));
+        }
+    }
+
+    // Application work continues during the conversion
+    delay(10);
+}
@@ -49,6 +49,12 @@ char delimiterChar = ' ';
 // Create serial terminal object
 SerialTerminal term(newlineChar, delimiterChar);
 
+// Binary time sync frame: start, type, sequence, two uint32 little endian, checksum
+#define SYNC_FRAME_START    0xA5
+#define SYNC_FRAME_SIZE     12
+// Leave binary time sync mode when no frame is received within this time
+#define SYNC_TIMEOUT_MS     5000
+
 // Define days of the week in flash
 const char day_0[] PROGMEM = "Sunday";
 const char day_1[] PROGMEM = "Monday";
@@ -129,6 +135,7 @@ void cmdHelp()
     Serial.println(F("  set date <w d-m-Y> Set day week and date"));
     Serial.println(F("  set time <H:M:S>   Set time"));
     Serial.println(F("  set epoch <value>  Set epoch"));
+    Serial.println(F("  sync               Binary time sync with ErriezDS3231Terminal.py"));
     Serial.println();
     Serial.println(F(" Temperature functions:"));
     Serial.println(F("  tconv              Start temperature conversion"));
@@ -284,6 +291,156 @@ void cmdSetDateTime()
     }
 }
 
+uint32_t syncGetUint32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |
+           ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+void syncPutUint32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+    buffer[2] = value >> 16;
+    buffer[3] = value >> 24;
+}
+
+uint8_t syncChecksum(const uint8_t *frame)
+{
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < (SYNC_FRAME_SIZE - 1); i++) {
+        sum += frame[i];
+    }
+
+    return sum;
+}
+
+bool syncReadFrame(uint8_t *frame, unsigned long *rxMicros)
+{
+    unsigned long start = millis();
+    uint8_t len = 0;
+    int c;
+
+    while ((millis() - start) < SYNC_TIMEOUT_MS) {
+        c = Serial.read();
+        if ((c < 0) || ((len == 0) && (c != SYNC_FRAME_START))) {
+            continue;
+        }
+
+        frame[len++] = c;
+        if (len == SYNC_FRAME_SIZE) {
+            // Receive timestamp of the last byte
+            *rxMicros = micros();
+            if (frame[SYNC_FRAME_SIZE - 1] == syncChecksum(frame)) {
+                return true;
+            }
+            len = 0;
+        }
+    }
+
+    return false;
+}
+
+void syncWriteFrame(uint8_t type, uint8_t seq, uint32_t a, uint32_t b)
+{
+    uint8_t frame[SYNC_FRAME_SIZE];
+
+    frame[0] = SYNC_FRAME_START;
+    frame[1] = type;
+    frame[2] = seq;
+    syncPutUint32(&frame[3], a);
+    syncPutUint32(&frame[7], b);
+    frame[SYNC_FRAME_SIZE - 1] = syncChecksum(frame);
+
+    Serial.write(frame, sizeof(frame));
+}
+
+bool syncSetEpoch(uint32_t epoch, uint32_t epochMicros, unsigned long *writeLatency)
+{
+    // Time since the start of second epoch, which the host mapped to epochMicros on micros()
+    unsigned long elapsed = micros() - epochMicros;
+
+    if (elapsed > 60000000UL) {
+        return false;
+    }
+
+    // Write the registers at the next second boundary
+    return rtc.setEpochAligned((time_t)(epoch + (elapsed / 1000000UL)), elapsed % 1000000UL,
+                               micros, writeLatency);
+}
+
+bool syncCheck(uint32_t *epoch, uint32_t *edgeMicros)
+{
+    uint8_t secStart;
+    uint8_t sec;
+    unsigned long start;
+    unsigned long pollMicros;
+    unsigned long lastPollMicros;
+    time_t t;
+
+    // Wait for the seconds register to increment
+    start = micros();
+    pollMicros = start;
+    if (!rtc.readBuffer(DS3231_REG_SECONDS, &secStart, 1)) {
+        return false;
+    }
+    do {
+        lastPollMicros = pollMicros;
+        pollMicros = micros();
+        if (!rtc.readBuffer(DS3231_REG_SECONDS, &sec, 1)) {
+            return false;
+        }
+        if ((pollMicros - start) > 2000000UL) {
+            return false;
+        }
+    } while (sec == secStart);
+
+    // Seconds incremented between the previous and this register read
+    *edgeMicros = pollMicros - ((pollMicros - lastPollMicros) / 2);
+
+    t = rtc.getEpoch();
+    *epoch = (uint32_t)t;
+
+    return t != 0;
+}
+
+void cmdSync()
+{
+    uint8_t frame[SYNC_FRAME_SIZE];
+    unsigned long rxMicros;
+    unsigned long writeLatency = 0;
+    uint32_t epoch = 0;
+    uint32_t edgeMicros = 0;
+    bool result;
+
+    // Binary frames until quit or timeout, the periodic prints are paused
+    while (syncReadFrame(frame, &rxMicros)) {
+        switch (frame[1]) {
+            case 'P':
+                // Ping: receive and transmit timestamps
+                syncWriteFrame('p', frame[2], rxMicros, micros());
+                break;
+            case 'S':
+                // Set: epoch and the micros() value at the start of that second
+                result = syncSetEpoch(syncGetUint32(&frame[3]), syncGetUint32(&frame[7]),
+                                      &writeLatency);
+                syncWriteFrame('s', frame[2], result, writeLatency);
+                break;
+            case 'C':
+                // Check: micros() at the next seconds increment
+                result = syncCheck(&epoch, &edgeMicros);
+                syncWriteFrame('c', frame[2], result ? epoch : 0, edgeMicros);
+                break;
+            case 'Q':
+                syncWriteFrame('q', frame[2], 0, 0);
+                return;
+            default:
+                break;
+        }
+    }
+}
+
 void cmdToggle32kHzOutputClockPin()
 {
     // Toggle 32kHz output clock pin
@@ -448,6 +605,7 @@ void setup()
     term.addCommand("time", cmdPrintTime);
     term.addCommand("epoch", cmdPrintEpoch);
     term.addCommand("set", cmdSetDateTime);
+    term.addCommand("sync", cmdSync);
 
     term.addCommand("tconv", cmdStartTemperatureConversion);
     term.addCommand("temp", cmdPrintTemperature);
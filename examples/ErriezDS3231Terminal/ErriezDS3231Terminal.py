@@ -25,16 +25,31 @@
 # Documentation:  https://erriez.github.io/ErriezDS3231
 #
 
+import argparse
 import datetime
+import os
+import random
 import serial
+import struct
 import sys
+import threading
+import time
 
 SERIAL_PORT = '/dev/ttyACM0'
 BAUDRATE = 115200
 
+# Binary time sync frame: start, type, sequence, two uint32 little endian, checksum
+SYNC_FRAME_START = 0xA5
+SYNC_FRAME_SIZE = 12
+SYNC_EXCHANGES = 16
+SYNC_CHECKS = 3
+SYNC_TIMEOUT = 2.5
+
+STARTUP_STRING = 'Erriez DS3231 RTC terminal example'
+
 
 def read_line(line):
-    line = line.decode('ascii')
+    line = line.decode('ascii', 'replace')
     line = line.strip()
     return line
 
@@ -74,21 +89,321 @@ def set_time(ser):
     ser.write(newline)
 
 
-def main():
-    print('Erriez Arduino DS3213 RTC set date time via terminal example')
+def now_us():
+    # UTC in microseconds
+    return time.time_ns() // 1000
+
+
+def checksum(data):
+    return sum(data) & 0xFF
+
+
+def make_frame(frame_type, seq, a=0, b=0):
+    frame = struct.pack('<BBBII', SYNC_FRAME_START, ord(frame_type), seq & 0xFF,
+                        a & 0xFFFFFFFF, b & 0xFFFFFFFF)
+    return frame + bytes([checksum(frame)])
+
+
+def parse_frame(frame):
+    _, frame_type, seq, a, b = struct.unpack('<BBBII', frame[:-1])
+    return chr(frame_type), seq, a, b
+
+
+class FrameReader:
+    """Find frames in a byte stream, skipping text output and corrupted frames."""
+
+    def __init__(self, port):
+        self.port = port
+        self.buffer = b''
+
+    def read(self, frame_type, seq, timeout=SYNC_TIMEOUT):
+        deadline = time.monotonic() + timeout
+        while 1:
+            # Search start byte and check frame
+            while len(self.buffer) >= SYNC_FRAME_SIZE:
+                if self.buffer[0] == SYNC_FRAME_START and \
+                        self.buffer[SYNC_FRAME_SIZE - 1] == \
+                        checksum(self.buffer[:SYNC_FRAME_SIZE - 1]):
+                    frame = self.buffer[:SYNC_FRAME_SIZE]
+                    self.buffer = self.buffer[SYNC_FRAME_SIZE:]
+                    result = parse_frame(frame)
+                    if result[0] == frame_type and result[1] == seq & 0xFF:
+                        return result
+                else:
+                    self.buffer = self.buffer[1:]
+
+            if time.monotonic() > deadline:
+                return None
+
+            # Read at least the remainder of a frame
+            self.buffer += self.port.read(max(1, SYNC_FRAME_SIZE - len(self.buffer)))
+
+
+def sync_exchange(ser, reader, seq):
+    # NTP-style round trip: t1/t4 host UTC, t2/t3 device micros()
+    frame = make_frame('P', seq)
+    t1 = now_us()
+    ser.write(frame)
+    response = reader.read('p', seq)
+    t4 = now_us()
+    if response is None:
+        return None
+
+    _, _, t2, t3 = response
+    device_time = (t3 - t2) & 0xFFFFFFFF
+    delay = (t4 - t1) - device_time
+    offset = ((t2 - t1) + (t2 + device_time - t4)) // 2
+
+    return delay, offset
+
+
+def local_offset():
+    # Local time offset to UTC in seconds, including daylight saving time
+    return time.localtime().tm_gmtoff
+
+
+def sync_binary(ser, exchanges=SYNC_EXCHANGES, checks=SYNC_CHECKS, utc_offset=0):
+    """Set RTC with latency compensated binary protocol.
+
+    The RTC is programmed with UTC plus utc_offset seconds, for example local_offset() to program
+    local time like set_date() and set_time().
+
+    Returns list with measured set errors in microseconds, or None on failure.
+    """
+    reader = FrameReader(ser)
+
+    # Switch terminal to binary mode
+    ser.write(b'sync\n')
+    time.sleep(0.1)
+
+    # Round trips: the sample with the minimum delay has the smallest asymmetry error
+    samples = []
+    for seq in range(exchanges):
+        sample = sync_exchange(ser, reader, seq)
+        if sample is not None:
+            samples.append(sample)
+    if not samples:
+        print('Error: No response from device')
+        return None
+    delay, offset = min(samples)
+    print('Round trips: {}, min delay: {:.3f}ms, max delay: {:.3f}ms'.format(
+        len(samples), delay / 1000, max(samples)[0] / 1000))
+
+    # Start of the current second on the device clock, the device writes at the next second
+    epoch = now_us() // 1000000
+    epoch_micros = (epoch * 1000000 + offset) & 0xFFFFFFFF
+    epoch += utc_offset
+    ser.write(make_frame('S', exchanges, epoch, epoch_micros))
+    response = reader.read('s', exchanges)
+    if response is None or not response[2]:
+        print('Error: Set epoch failed')
+        return None
+    print('Set epoch: {}, register write {}us'.format(epoch + 1, response[3]))
+
+    # Measure the seconds increment of the RTC on the host clock
+    errors = []
+    for seq in range(checks):
+        ser.write(make_frame('C', exchanges + 1 + seq))
+        response = reader.read('c', exchanges + 1 + seq)
+        if response is None or not response[2]:
+            print('Error: Check failed')
+            return None
+        _, _, rtc_epoch, edge_micros = response
+        edge = (edge_micros - offset) & 0xFFFFFFFF
+        edge += (now_us() - edge + 0x80000000) // 0x100000000 * 0x100000000
+        errors.append(edge - (rtc_epoch - utc_offset) * 1000000)
+        print('RTC second {} starts {:+.3f}ms from host'.format(
+            rtc_epoch, errors[-1] / 1000))
+
+    # Back to text mode
+    ser.write(make_frame('Q', 0xFF))
+    reader.read('q', 0xFF)
+
+    return errors
+
+
+class FdPort:
+    """Serial port interface on a file descriptor."""
 
+    def __init__(self, fd, timeout=0.01):
+        # POSIX only
+        import select
+
+        self.fd = fd
+        self.timeout = timeout
+        self.select = select.select
+
+    def read(self, size=1):
+        data = b''
+        deadline = time.monotonic() + self.timeout
+        while len(data) < size:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not self.select([self.fd], [], [], remaining)[0]:
+                break
+            data += os.read(self.fd, size - len(data))
+        return data
+
+    def readline(self):
+        line = b''
+        while not line.endswith(b'\n'):
+            c = self.read(1)
+            if not c:
+                break
+            line += c
+        return line
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+
+class DeviceEmulator(threading.Thread):
+    """Terminal sketch with binary time sync, for testing over a pseudo-terminal pair.
+
+    The device micros() and the RTC have random offsets to the host clock. Responses are delayed
+    randomly to emulate USB and scheduling latency.
+    """
+
+    def __init__(self, port, max_latency=0.002):
+        threading.Thread.__init__(self, daemon=True)
+        self.port = port
+        self.max_latency = max_latency
+        self.micros_offset = random.randrange(1 << 32)
+        self.rtc_offset = random.randrange(-100000000, 100000000)
+
+    def micros(self):
+        return (time.monotonic_ns() // 1000 + self.micros_offset) & 0xFFFFFFFF
+
+    def rtc_us(self):
+        return now_us() + self.rtc_offset
+
+    def sleep_micros(self, us):
+        deadline = time.monotonic() + us / 1000000
+        while time.monotonic() < deadline:
+            pass
+
+    def write_frame(self, frame_type, seq, a=0, b=0):
+        self.port.write(make_frame(frame_type, seq, a, b))
+
+    def run(self):
+        self.port.write(str.encode('\n{}\n\n'.format(STARTUP_STRING)))
+        while 1:
+            line = read_line(self.port.readline())
+            if line == 'sync':
+                self.sync()
+
+    def sync(self):
+        buffer = b''
+        deadline = time.monotonic() + 5
+        while time.monotonic() < deadline:
+            buffer += self.port.read(1)
+            if buffer and buffer[0] != SYNC_FRAME_START:
+                buffer = b''
+            if len(buffer) < SYNC_FRAME_SIZE:
+                continue
+            frame, buffer = buffer, b''
+            if frame[-1] != checksum(frame[:-1]):
+                continue
+            deadline = time.monotonic() + 5
+            frame_type, seq, a, b = parse_frame(frame)
+
+            # Emulate latency on the receive and transmit path
+            time.sleep(random.random() * self.max_latency)
+            rx_micros = self.micros()
+            if frame_type == 'P':
+                tx_micros = self.micros()
+                time.sleep(random.random() * self.max_latency)
+                self.write_frame('p', seq, rx_micros, tx_micros)
+            elif frame_type == 'S':
+                # setEpochAligned() at the next second boundary
+                elapsed = (self.micros() - b) & 0xFFFFFFFF
+                start = self.micros()
+                self.sleep_micros(1000000 - elapsed % 1000000 - ((self.micros() - start) & 0xFFFFFFFF))
+                self.rtc_offset = (a + elapsed // 1000000 + 1) * 1000000 - now_us()
+                self.write_frame('s', seq, 1, 250)
+            elif frame_type == 'C':
+                # micros() at the next seconds increment
+                rtc = self.rtc_us()
+                self.sleep_micros(1000000 - rtc % 1000000)
+                self.write_frame('c', seq, rtc // 1000000 + 1, self.micros())
+            elif frame_type == 'Q':
+                self.write_frame('q', seq)
+                return
+
+
+def open_serial(port, baudrate):
     ser = serial.Serial()
-    ser.baudrate = int(BAUDRATE)
+    ser.baudrate = int(baudrate)
     ser.bytesize = 8
     ser.stopbits = 1
     ser.parity = serial.PARITY_NONE
     ser.timeout = 0.01
-    ser.port = SERIAL_PORT
+    ser.port = port
     try:
         ser.open()
     except serial.SerialException:
-        print('Error: Cannot open serial port {}'.format(SERIAL_PORT))
+        print('Error: Cannot open serial port {}'.format(port))
         sys.exit(1)
+    return ser
+
+
+def self_test(exchanges, utc_offset):
+    # POSIX only
+    import tty
+
+    # Host and emulated device on both sides of a pseudo-terminal pair
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    DeviceEmulator(FdPort(master)).start()
+    ser = FdPort(slave)
+
+    while 1:
+        line = read_line(ser.readline())
+        if line.find(STARTUP_STRING) == 0:
+            break
+
+    errors = sync_binary(ser, exchanges, utc_offset=utc_offset)
+    if errors is None:
+        return 1
+
+    worst = max(abs(e) for e in errors)
+    print('Self test {}: worst error {:.3f}ms'.format(
+        'passed' if worst < 2000 else 'failed', worst / 1000))
+    return 0 if worst < 2000 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Erriez Arduino DS3231 RTC set date time via terminal example',
+        epilog='Binary time sync programs the RTC with UTC, which matches getEpoch(). Text mode '
+               'programs local time. Use --local to program local time with binary time sync.')
+    parser.add_argument('--port', default=SERIAL_PORT, help='serial port')
+    parser.add_argument('--baudrate', default=BAUDRATE, help='baudrate')
+    parser.add_argument('--text', action='store_true',
+                        help='set date/time with text commands instead of binary time sync')
+    parser.add_argument('--local', action='store_true',
+                        help='program local time instead of UTC with binary time sync')
+    parser.add_argument('--exchanges', type=int, default=SYNC_EXCHANGES,
+                        help='number of round trips for binary time sync')
+    parser.add_argument('--device', action='store_true',
+                        help='emulate the terminal sketch on --port, for example one side of a '
+                             '"socat pty,raw,echo=0 pty,raw,echo=0" pair')
+    parser.add_argument('--self-test', action='store_true',
+                        help='binary time sync with an emulated device on a pseudo-terminal pair')
+    args = parser.parse_args()
+    utc_offset = local_offset() if args.local else 0
+
+    if args.self_test:
+        sys.exit(self_test(args.exchanges, utc_offset))
+
+    if args.device:
+        emulator = DeviceEmulator(open_serial(args.port, args.baudrate))
+        emulator.run()
+        return
+
+    print('Erriez Arduino DS3213 RTC set date time via terminal example')
+
+    ser = open_serial(args.port, args.baudrate)
 
     while 1:
         # Read line from serial port
@@ -98,12 +413,16 @@ def main():
             print(line)
 
             # Wait for terminal startup string
-            if line.find('Erriez DS3231 RTC terminal example') == 0:
-                # Set date
-                set_date(ser)
+            if line.find(STARTUP_STRING) == 0:
+                if args.text:
+                    # Set date
+                    set_date(ser)
 
-                # Set time
-                set_time(ser)
+                    # Set time
+                    set_time(ser)
+                else:
+                    # Set date and time with latency compensation
+                    sync_binary(ser, args.exchanges, utc_offset=utc_offset)
 
                 # Enable continues prints
                 ser.write(str.encode('print\n'))
@@ -62,6 +62,7 @@ void setup()
 {
     struct tm dtw;
     struct tm dtr;
+    DS3231Snapshot snapshot;
     uint8_t hour;
     uint8_t min;
     uint8_t sec;
@@ -165,6 +166,14 @@ void setup()
     CHK(dtr.tm_year == (2019 - 1900)); // Year - 1900
     CHK(dtr.tm_wday == 2);    // 0=Sun, 1=Mon, 2=Tue
 
+    // Test readSnapshot()
+    CHK(rtc.readSnapshot(&snapshot) == Success);
+    CHK(ErriezDS3231::decodeTime(&snapshot, &dtr) == Success);
+    CHK(dtr.tm_min == 45);
+    CHK(dtr.tm_hour == 13);
+    CHK(dtr.tm_mday == 31);
+    CHK(ErriezDS3231::decodeRunning(&snapshot) == true);
+
     // Completed
     Serial.println(F("Test passed"));
 }
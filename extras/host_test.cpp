@@ -0,0 +1,689 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file host_test.cpp
+ * \brief DS3231 high precision RTC library for Arduino: host tests with the simulator
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Build and run on a Linux host, optionally with the ERRIEZ_DS3231_... feature defines:
+ *          g++ -std=c++11 -Wall -Isrc src/ErriezDS3231*.cpp extras/host_test.cpp -o host_test
+ *          ./host_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ErriezDS3231.h"
+#include "ErriezDS3231Batch.h"
+#include "ErriezDS3231Calibration.h"
+#include "ErriezDS3231Cron.h"
+#include "ErriezDS3231Drift.h"
+#include "ErriezDS3231Fleet.h"
+#include "ErriezDS3231Scheduler.h"
+#include "ErriezDS3231Simulator.h"
+#include "ErriezDS3231Sleep.h"
+
+//! Start epoch of the tests: Tuesday 14 November 2023 22:13:20 UTC
+#define TEST_EPOCH      1700000000UL
+
+//! Check condition, continue with the next check on failure
+#define CHECK(cond)     check((cond), #cond, __FILE__, __LINE__)
+
+static uint16_t checks;
+static uint16_t failures;
+
+static void check(bool ok, const char *cond, const char *file, int line)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("%s:%d: check failed: %s\n", file, line, cond);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Bus retry and fault paths
+// -------------------------------------------------------------------------------------------------
+static void testFaults()
+{
+    ErriezDS3231Simulator sim;
+    ErriezDS3231 rtc(&sim);
+    uint8_t ctrl;
+
+    printf("Bus faults...\n");
+
+    sim.setEpoch(TEST_EPOCH);
+    CHECK(rtc.begin());
+
+    // Default policy: single attempt
+    sim.injectFault(SimFaultNackAddress);
+    CHECK(rtc.getEpoch() == 0);
+    CHECK(rtc.getLastError() == ResultNackAddress);
+#ifdef ERRIEZ_DS3231_RETRY
+    CHECK(rtc.getBusRetries() == 0);
+#endif
+    CHECK(rtc.getEpoch() == (time_t)TEST_EPOCH);
+    CHECK(rtc.getLastError() == ResultOk);
+
+    // Unchecked register read returns 0 on failure
+    sim.injectFault(SimFaultNackAddress);
+    CHECK(rtc.readRegister(DS3231_REG_CONTROL) == 0);
+
+    // Checked register reads report the failure
+    sim.injectFault(SimFaultNackAddress);
+    CHECK(!rtc.begin());
+    sim.injectFault(SimFaultNackAddress);
+    CHECK(!rtc.isRunning());
+    sim.injectFault(SimFaultTimeout);
+    CHECK(!rtc.startTemperatureConversion());
+    CHECK(rtc.getLastError() == ResultTimeout);
+
+    // A failed read of a read-modify-write does not write the register
+    ctrl = sim.getRegister(DS3231_REG_CONTROL);
+    sim.resetCounters();
+    sim.injectFault(SimFaultNackAddress);
+    CHECK(!rtc.setSquareWave(SquareWave1024Hz));
+    CHECK(sim.getTransactions() == 1);
+    CHECK(sim.getRegister(DS3231_REG_CONTROL) == ctrl);
+
+#ifdef ERRIEZ_DS3231_RETRY
+    // Retries
+    rtc.setRetryPolicy(2);
+    sim.injectFault(SimFaultNackAddress, 2);
+    CHECK(rtc.getEpoch() == (time_t)TEST_EPOCH);
+    CHECK(rtc.getBusRetries() == 2);
+    sim.injectFault(SimFaultNackData, 3);
+    CHECK(rtc.getEpoch() == 0);
+    CHECK(rtc.getLastError() == ResultNackData);
+    sim.injectFault(SimFaultShortRead);
+    CHECK(rtc.getEpoch() == (time_t)TEST_EPOCH);
+
+    // Stuck bus is only released by a bus clear
+    rtc.setRetryPolicy(1);
+    sim.injectFault(SimFaultBusStuck);
+    CHECK(rtc.getEpoch() == 0);
+    CHECK(rtc.getLastError() == ResultTimeout);
+    CHECK(rtc.getBusClears() == 0);
+    rtc.setRetryPolicy(1, 0, true);
+    CHECK(rtc.getEpoch() == (time_t)TEST_EPOCH);
+    CHECK(rtc.getBusClears() == 1);
+    CHECK(rtc.getLastError() == ResultOk);
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------
+// Second alignment with a bounded duration
+// -------------------------------------------------------------------------------------------------
+static void testAlign()
+{
+    ErriezDS3231Simulator sim;
+    ErriezDS3231 rtc(&sim);
+    volatile uint16_t seconds = 0;
+    volatile uint16_t subTicks = 0;
+    uint16_t startSeconds;
+    uint32_t start;
+    time_t t;
+
+    printf("Second alignment...\n");
+
+    sim.setBusClock(100000);
+    sim.setEpoch(TEST_EPOCH);
+    CHECK(rtc.begin());
+    CHECK(rtc.clockEnable(true));
+
+    // Polls until the seconds register increments
+    start = sim.getMicros();
+    CHECK(rtc.alignSecond(&seconds, &subTicks, &startSeconds, &t));
+    CHECK((sim.getMicros() - start) < DS3231_ALIGN_TIMEOUT_US);
+    CHECK((t == (time_t)(TEST_EPOCH + 1)) || (t == (time_t)(TEST_EPOCH + 2)));
+    CHECK(sim.getSubsecondMicros() < 2000);
+
+    // 1Hz: the SQW falling edge must have been counted
+    CHECK(!rtc.alignSecond(&seconds, NULL, &startSeconds, &t));
+
+    // Stopped oscillator
+    sim.setOscillatorFault(true);
+    sim.resetCounters();
+    CHECK(!rtc.alignSecond(&seconds, &subTicks, &startSeconds, &t));
+    CHECK(sim.getTransactions() == 1);
+    sim.setOscillatorFault(false);
+    CHECK(rtc.clockEnable(true));
+
+    // Oscillator disabled with EOSC
+    CHECK(rtc.clockEnable(false));
+    CHECK(!rtc.alignSecond(&seconds, &subTicks, &startSeconds, &t));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Cron next fire time against a brute force search
+// -------------------------------------------------------------------------------------------------
+static void randomField(char *field, uint8_t min, uint8_t max)
+{
+    uint8_t a = min + rand() % (max - min + 1);
+    uint8_t b = a + rand() % (max - a + 1);
+
+    switch (rand() % 6) {
+        case 0: sprintf(field, "*"); break;
+        case 1: sprintf(field, "*/%d", 2 + rand() % 5); break;
+        case 2: sprintf(field, "%d", a); break;
+        case 3: sprintf(field, "%d-%d", a, b); break;
+        case 4: sprintf(field, "%d,%d", a, b); break;
+        default: sprintf(field, "%d-%d/%d", a, b, 1 + rand() % 3); break;
+    }
+}
+
+static void testCronNextFire()
+{
+    static const char *fixed[] = {
+        "* * * * *", "5 * * * *", "30 3 * * 1", "0 0 29 2 *", "0 12 31 * *", "0 9-17/2 1,15 * 0"
+    };
+    ErriezDS3231 rtc;
+    ErriezDS3231Cron cron(&rtc);
+    char fields[5][16];
+    char expr[96];
+    uint32_t after;
+    uint32_t next;
+    uint32_t t;
+    bool found;
+
+    printf("Cron next fire time...\n");
+
+    for (uint16_t i = 0; i < 300; i++) {
+        if (i < (sizeof(fixed) / sizeof(fixed[0]))) {
+            snprintf(expr, sizeof(expr), "%s", fixed[i]);
+        } else {
+            randomField(fields[0], 0, 59);
+            randomField(fields[1], 0, 23);
+            randomField(fields[2], 1, 31);
+            randomField(fields[3], 1, 12);
+            randomField(fields[4], 0, 6);
+            snprintf(expr, sizeof(expr), "%s %s %s %s %s",
+                     fields[0], fields[1], fields[2], fields[3], fields[4]);
+        }
+        CHECK(cron.parse(expr));
+
+        after = TEST_EPOCH + (uint32_t)rand() * 7919UL % (365UL * 86400UL);
+
+        // First matching minute after the start, within the search window
+        found = false;
+        for (t = after - (after % 60) + 60;
+             t < (after + DS3231_CRON_SEARCH_DAYS * 86400UL); t += 60) {
+            if (cron.matches(t)) {
+                found = true;
+                break;
+            }
+        }
+
+        if (cron.nextFire(after, &next) != found) {
+            printf("  %s after %lu: found %d\n", expr, (unsigned long)after, found);
+            CHECK(false);
+        } else if (found && (next != t)) {
+            printf("  %s after %lu: next %lu, expected %lu\n",
+                   expr, (unsigned long)after, (unsigned long)next, (unsigned long)t);
+            CHECK(false);
+        }
+    }
+
+    // Invalid expressions
+    CHECK(!cron.parse("60 * * * *"));
+    CHECK(!cron.parse("* * * *"));
+    CHECK(!cron.parse("*/0 * * * *"));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scheduler heap against expected dispatch counts
+// -------------------------------------------------------------------------------------------------
+#define SCHED_EVENTS        12
+#define SCHED_SECONDS       (2UL * 86400UL)
+
+static ErriezDS3231Simulator *schedSim;
+static uint32_t schedFired[SCHED_EVENTS];
+static uint16_t schedLate;
+
+static void schedCallback(uint8_t id, uint32_t epoch)
+{
+    time_t now;
+
+    schedSim->getEpoch(&now);
+    if ((uint32_t)now != epoch) {
+        schedLate++;
+    }
+    schedFired[id]++;
+}
+
+static void testScheduler()
+{
+    ErriezDS3231Simulator sim;
+    ErriezDS3231 rtc(&sim);
+    DS3231Event pool[SCHED_EVENTS];
+    ErriezDS3231Scheduler sched(&rtc, pool, SCHED_EVENTS);
+    uint32_t deadline[SCHED_EVENTS];
+    uint32_t period[SCHED_EVENTS];
+    bool cancelled[SCHED_EVENTS];
+    uint32_t end = TEST_EPOCH + SCHED_SECONDS;
+    uint32_t nearest = 0xFFFFFFFFUL;
+    uint32_t expected;
+    uint32_t next;
+
+    printf("Scheduler...\n");
+
+    schedSim = &sim;
+    sim.setEpoch(TEST_EPOCH);
+    CHECK(rtc.begin());
+    CHECK(sched.begin());
+
+    for (uint8_t id = 0; id < SCHED_EVENTS; id++) {
+        deadline[id] = TEST_EPOCH + 1 + rand() % (SCHED_SECONDS + 3600);
+        period[id] = (rand() % 2) ? (60 + rand() % 7200) : 0;
+        cancelled[id] = false;
+        schedFired[id] = 0;
+        CHECK(sched.schedule(id, deadline[id], period[id], schedCallback));
+    }
+    CHECK(sched.count() == SCHED_EVENTS);
+    CHECK(!sched.schedule(SCHED_EVENTS, end, 0, schedCallback));
+
+    // Cancel events and check the heap root
+    for (uint8_t id = 0; id < SCHED_EVENTS; id += 3) {
+        CHECK(sched.cancel(id));
+        cancelled[id] = true;
+    }
+    CHECK(!sched.cancel(0));
+    for (uint8_t id = 0; id < SCHED_EVENTS; id++) {
+        if (!cancelled[id] && (deadline[id] < nearest)) {
+            nearest = deadline[id];
+        }
+    }
+    CHECK(sched.nextDeadline(&next) && (next == nearest));
+
+    // Run, service after every alarm 1 interrupt
+    for (uint32_t t = TEST_EPOCH; t < end; t++) {
+        sim.advanceSeconds(1);
+        if (!sim.getIntSqwPin()) {
+            CHECK(sched.service());
+        }
+    }
+
+    CHECK(schedLate == 0);
+    for (uint8_t id = 0; id < SCHED_EVENTS; id++) {
+        expected = 0;
+        if (!cancelled[id] && (deadline[id] <= end)) {
+            expected = period[id] ? ((end - deadline[id]) / period[id] + 1) : 1;
+        }
+        if (schedFired[id] != expected) {
+            printf("  event %u: fired %lu, expected %lu\n",
+                   id, (unsigned long)schedFired[id], (unsigned long)expected);
+            CHECK(false);
+        }
+    }
+    CHECK(sched.getSpuriousWakeups() == 0);
+
+    // The alarm 1 interrupt is disabled without events
+    for (uint8_t id = 0; id < SCHED_EVENTS; id++) {
+        if (!cancelled[id] && period[id]) {
+            CHECK(sched.cancel(id));
+        }
+    }
+    CHECK(sched.count() == 0);
+    CHECK(!(sim.getRegister(DS3231_REG_CONTROL) & (1 << DS3231_CTRL_A1IE)));
+
+    // Enabled again by the next event, and disabled after its dispatch
+    expected = schedFired[0] + 1;
+    CHECK(sched.schedule(0, end + 10, 0, schedCallback));
+    CHECK(sim.getRegister(DS3231_REG_CONTROL) & (1 << DS3231_CTRL_A1IE));
+    sim.advanceSeconds(10);
+    CHECK(!sim.getIntSqwPin());
+    CHECK(sched.service());
+    CHECK(schedFired[0] == expected);
+    CHECK(!(sim.getRegister(DS3231_REG_CONTROL) & (1 << DS3231_CTRL_A1IE)));
+    CHECK(sim.getIntSqwPin());
+}
+
+// -------------------------------------------------------------------------------------------------
+// Batch against direct API register equivalence
+// -------------------------------------------------------------------------------------------------
+static void batchCompare(const char *name,
+                         void (*direct)(ErriezDS3231 *rtc),
+                         void (*batch)(ErriezDS3231Batch *batch))
+{
+    ErriezDS3231Simulator simDirect;
+    ErriezDS3231Simulator simBatch;
+    ErriezDS3231 rtcDirect(&simDirect);
+    ErriezDS3231 rtcBatch(&simBatch);
+    ErriezDS3231Batch b(&rtcBatch);
+    uint8_t value;
+
+    simDirect.setEpoch(TEST_EPOCH);
+    simBatch.setEpoch(TEST_EPOCH);
+
+    // Same alarm, control and status registers, including set alarm flags
+    for (uint8_t reg = DS3231_REG_ALARM1_SEC; reg <= DS3231_REG_AGING_OFFSET; reg++) {
+        value = (reg * 37) & 0x7F;
+        if (reg == DS3231_REG_STATUS) {
+            value = 0x8B;
+        } else if (reg == DS3231_REG_CONTROL) {
+            value = 0x1C;
+        }
+        simDirect.setRegister(reg, value);
+        simBatch.setRegister(reg, value);
+    }
+    simBatch.resetCounters();
+
+    direct(&rtcDirect);
+    batch(&b);
+    CHECK(b.commit());
+    CHECK(simBatch.getTransactions() == b.getTransactions());
+
+    for (uint8_t reg = 0; reg <= DS3231_REG_AGING_OFFSET; reg++) {
+        if (simDirect.getRegister(reg) != simBatch.getRegister(reg)) {
+            printf("  %s: register 0x%02x direct 0x%02x, batch 0x%02x\n", name, reg,
+                   simDirect.getRegister(reg), simBatch.getRegister(reg));
+            CHECK(false);
+        }
+    }
+}
+
+static void testBatch()
+{
+    printf("Batch...\n");
+
+    batchCompare("alarm 1",
+        [](ErriezDS3231 *rtc) {
+            rtc->setAlarm1(Alarm1MatchHours, 0, 12, 30, 15);
+            rtc->alarmInterruptEnable(Alarm1, true);
+            rtc->setSquareWave(SquareWaveDisable);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->setAlarm1(Alarm1MatchHours, 0, 12, 30, 15);
+            batch->alarmInterruptEnable(Alarm1, true);
+            batch->setSquareWave(SquareWaveDisable);
+        });
+    batchCompare("alarm 1 and 2",
+        [](ErriezDS3231 *rtc) {
+            rtc->setAlarm1(Alarm1EverySecond, 0, 0, 0, 0);
+            rtc->setAlarm2(Alarm2MatchMinutes, 0, 0, 5);
+            rtc->alarmInterruptEnable(Alarm2, true);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->setAlarm1(Alarm1EverySecond, 0, 0, 0, 0);
+            batch->setAlarm2(Alarm2MatchMinutes, 0, 0, 5);
+            batch->alarmInterruptEnable(Alarm2, true);
+        });
+    batchCompare("square wave",
+        [](ErriezDS3231 *rtc) {
+            rtc->setSquareWave(SquareWave1024Hz);
+            rtc->outputClockPinEnable(true);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->setSquareWave(SquareWave1024Hz);
+            batch->outputClockPinEnable(true);
+        });
+    batchCompare("epoch",
+        [](ErriezDS3231 *rtc) {
+            rtc->setEpoch(1800000000UL);
+            rtc->setAlarm1(Alarm1MatchSeconds, 0, 0, 0, 30);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->setEpoch(1800000000UL);
+            batch->setAlarm1(Alarm1MatchSeconds, 0, 0, 0, 30);
+        });
+    batchCompare("aging offset",
+        [](ErriezDS3231 *rtc) {
+            // The batch does not start a temperature conversion
+            rtc->writeRegister(DS3231_REG_AGING_OFFSET, (uint8_t)-5);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->setAgingOffset(-5);
+        });
+    batchCompare("alarm flags",
+        [](ErriezDS3231 *rtc) {
+            rtc->clearAlarmFlag(Alarm1);
+            rtc->clearAlarmFlag(Alarm2);
+        },
+        [](ErriezDS3231Batch *batch) {
+            batch->clearAlarmFlag(Alarm1);
+            batch->clearAlarmFlag(Alarm2);
+        });
+}
+
+// -------------------------------------------------------------------------------------------------
+// Aging offset calibration from SQW edges
+// -------------------------------------------------------------------------------------------------
+static void testCalibration()
+{
+    printf("Calibration...\n");
+
+    for (int8_t ppm = -12; ppm <= 12; ppm++) {
+        ErriezDS3231Simulator sim;
+        ErriezDS3231 rtc(&sim);
+        ErriezDS3231Calibration cal(&rtc);
+        bool pin = true;
+        bool written = true;
+        uint32_t seconds = 0;
+
+        sim.setEpoch(TEST_EPOCH);
+        sim.setFrequencyError((int32_t)ppm * 1000);
+        CHECK(rtc.begin());
+        CHECK(cal.begin());
+
+        while (((cal.getState() == CalMeasuring) || (cal.getState() == CalSettling)) &&
+               (seconds < 3600)) {
+            sim.advance(1000);
+
+            // Falling SQW edge: timestamp the start of the RTC second
+            if (pin && !sim.getIntSqwPin()) {
+                written &= cal.addEdge(sim.getMicros() - sim.getSubsecondMicros());
+                seconds++;
+            }
+            pin = sim.getIntSqwPin();
+        }
+
+        CHECK(written);
+        CHECK(cal.getState() == CalConverged);
+        CHECK(abs(cal.getErrorPpb()) < 50);
+        CHECK(abs(sim.getFrequencyError()) < 50);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Drift model fit
+// -------------------------------------------------------------------------------------------------
+static void testDrift()
+{
+    ErriezDS3231Simulator sim;
+    ErriezDS3231 rtc(&sim);
+    ErriezDS3231Drift single(&rtc);
+    ErriezDS3231Drift split(&rtc);
+
+    printf("Drift...\n");
+
+    // Single bin: 10000 s at 25 degree Celsius, 20000 us ahead is 2000 ppb
+    single.update(TEST_EPOCH, 2500);
+    single.sync(TEST_EPOCH, 0);
+    single.update(TEST_EPOCH + 5000, 2500);
+    single.sync(TEST_EPOCH + 10000, 20000);
+    CHECK(single.getPpb(2500) == 2000);
+    CHECK(single.getModel()->weight[(2500 - DS3231_DRIFT_BIN_MIN) / DS3231_DRIFT_BIN_WIDTH] == 1);
+    CHECK(single.getOffsetMicros(TEST_EPOCH + 10000) == 20000);
+    CHECK(single.getOffsetMicros(TEST_EPOCH + 20000) == 40000);
+
+    // Unfitted bins use the nearest fitted bin
+    CHECK(single.getPpb(-1000) == 2000);
+
+    // Two bins: 3000 s at 25 and 1000 s at 5 degree Celsius, 10000 us ahead. The error is
+    // distributed by the time spent in each bin: 3000 and 1000 ppb.
+    split.update(TEST_EPOCH, 2500);
+    split.sync(TEST_EPOCH, 0);
+    split.update(TEST_EPOCH + 3000, 500);
+    split.sync(TEST_EPOCH + 4000, 10000);
+    CHECK(split.getPpb(2500) == 3000);
+    CHECK(split.getPpb(500) == 1000);
+
+    // The same interval is predicted exactly and does not change the fit
+    split.update(TEST_EPOCH + 4000, 2500);
+    split.update(TEST_EPOCH + 7000, 500);
+    CHECK(split.getOffsetMicros(TEST_EPOCH + 8000) == 20000);
+    split.sync(TEST_EPOCH + 8000, 20000);
+    CHECK(split.getPpb(2500) == 3000);
+    CHECK(split.getPpb(500) == 1000);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Fleet of RTCs behind a mux: channel switches and skew
+// -------------------------------------------------------------------------------------------------
+#define FLEET_RTCS          4
+#define FLEET_POLL_US       1000
+
+static ErriezDS3231MuxSimulator *fleetBus;
+
+static unsigned long fleetMicros()
+{
+    return fleetBus->getMicros();
+}
+
+static void testFleet()
+{
+    static const uint8_t channels[FLEET_RTCS] = { 1, 3, 4, 6 };
+    // Phase offsets in us, multiples of the poll interval
+    static const int32_t offsets[FLEET_RTCS] = { 0, 250000, -120000, 3000 };
+    ErriezDS3231MuxSimulator bus;
+    ErriezDS3231Mux mux(&bus);
+    ErriezDS3231Fleet fleet(&mux, fleetMicros);
+    ErriezDS3231Simulator sims[FLEET_RTCS];
+    ErriezDS3231MuxTransport transports[FLEET_RTCS] = {
+        ErriezDS3231MuxTransport(&mux, channels[0]), ErriezDS3231MuxTransport(&mux, channels[1]),
+        ErriezDS3231MuxTransport(&mux, channels[2]), ErriezDS3231MuxTransport(&mux, channels[3])
+    };
+    ErriezDS3231 rtcs[FLEET_RTCS] = {
+        ErriezDS3231(&transports[0]), ErriezDS3231(&transports[1]),
+        ErriezDS3231(&transports[2]), ErriezDS3231(&transports[3])
+    };
+    uint32_t switches;
+    uint32_t sweeps;
+    bool polled = true;
+
+    printf("Fleet...\n");
+
+    fleetBus = &bus;
+    for (uint8_t i = 0; i < FLEET_RTCS; i++) {
+        CHECK(bus.attach(channels[i], &sims[i]));
+        sims[i].setEpoch(TEST_EPOCH);
+        sims[i].advance(500000 + offsets[i]);
+        CHECK(rtcs[i].begin());
+        CHECK(fleet.add(&rtcs[i], channels[i]));
+    }
+    CHECK(!fleet.add(&rtcs[0], channels[0]));
+
+    // The first sweep may start on another channel than the last begin()
+    CHECK(fleet.poll());
+    bus.advance(FLEET_POLL_US);
+
+    switches = mux.getSwitches();
+    sweeps = fleet.getSweeps();
+    for (uint16_t i = 0; i < 5000; i++) {
+        polled &= fleet.poll();
+        bus.advance(FLEET_POLL_US);
+    }
+    sweeps = fleet.getSweeps() - sweeps;
+    switches = mux.getSwitches() - switches;
+
+    // Sweeps alternate direction: N-1 channel switches per sweep
+    CHECK(polled);
+    CHECK(sweeps == 5000);
+    CHECK(switches == sweeps * (FLEET_RTCS - 1));
+    CHECK(fleet.getErrors() == 0);
+
+    for (uint8_t i = 0; i < FLEET_RTCS; i++) {
+        CHECK(fleet.isSkewValid(i));
+        CHECK(abs(fleet.getSkewMin(i) - offsets[i]) <= FLEET_POLL_US / 2);
+        CHECK(abs(fleet.getSkewMax(i) - offsets[i]) <= FLEET_POLL_US / 2);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Sleep cycle with two I2C transactions
+// -------------------------------------------------------------------------------------------------
+static void testSleep()
+{
+    ErriezDS3231Simulator sim;
+    ErriezDS3231 rtc(&sim);
+    ErriezDS3231Sleep sleep(&rtc);
+    time_t wake = TEST_EPOCH;
+    uint32_t us;
+
+    printf("Sleep...\n");
+
+    sim.setEpoch(TEST_EPOCH);
+    CHECK(rtc.begin());
+    CHECK(sleep.begin(true));
+
+    for (uint8_t cycle = 0; cycle < 50; cycle++) {
+        wake += 1 + rand() % 120;
+
+        sim.resetCounters();
+        CHECK(sleep.sleepUntil(wake));
+        CHECK(sim.getTransactions() == 1);
+
+        // Wake-up from battery power by the INT pin
+        sim.setBatteryPower(true);
+        for (us = 0; sim.getIntSqwPin() && (us < 200000000UL); us += 1000) {
+            sim.advance(1000);
+        }
+        sim.setBatteryPower(false);
+
+        CHECK(sleep.onWake());
+        CHECK(sim.getTransactions() == 2);
+        CHECK(sleep.getTransactions() == 2);
+        CHECK(sleep.isAlarmWake());
+        CHECK(sleep.getWakeEpoch() == wake);
+        CHECK(sim.getIntSqwPin());
+    }
+
+    // Early wake-up
+    CHECK(sleep.sleepUntil(wake + 100));
+    sim.advanceSeconds(2);
+    CHECK(sleep.onWake());
+    CHECK(!sleep.isAlarmWake());
+}
+
+int main()
+{
+    srand(1);
+
+    testFaults();
+    testAlign();
+    testCronNextFire();
+    testScheduler();
+    testBatch();
+    testCalibration();
+    testDrift();
+    testFleet();
+    testSleep();
+
+    printf("%u checks, %u failures\n", checks, failures);
+
+    return failures ? 1 : 0;
+}
@@ -30,6 +30,9 @@
  *      Documentation:  https://erriez.github.io/ErriezDS3231
  */
 
+#include <string.h>
+
+#ifdef ARDUINO
 #if (defined(__AVR__) || defined(ARDUINO_ARCH_SAM))
 #include <avr/pgmspace.h>
 #else
@@ -37,9 +40,127 @@
 #endif
 
 #include <Wire.h>
+#endif
+
+#if defined(__SSE2__) && !defined(ARDUINO)
+#include <emmintrin.h>
+#endif
 
 #include "ErriezDS3231.h"
 
+#ifdef ERRIEZ_DS3231_STATS
+/*!
+ * \brief Attribute I2C transactions to the outermost public API for the duration of a call
+ */
+class DS3231StatsScope
+{
+public:
+    /*!
+     * \brief Enter public API.
+     * \param rtc
+     *      RTC object.
+     * \param api
+     *      API group.
+     */
+    DS3231StatsScope(ErriezDS3231 *rtc, uint8_t api) : _rtc(rtc), _prev(rtc->_statsApi)
+    {
+        if (_prev == StatsApiOther) {
+            _rtc->_statsApi = api;
+        }
+    }
+
+    /*!
+     * \brief Leave public API.
+     */
+    ~DS3231StatsScope()
+    {
+        _rtc->_statsApi = _prev;
+    }
+
+private:
+    ErriezDS3231 *_rtc;     //!< RTC object
+    uint8_t _prev;          //!< API group of the caller
+};
+
+//! Count I2C transactions of the current function on an API group
+#define DS3231_STATS_API(api)   DS3231StatsScope statsScope(this, api)
+#else
+//! Instrumentation disabled: no code
+#define DS3231_STATS_API(api)
+#endif
+
+/*!
+ * \brief Constructor.
+ * \details
+ *      The RTC is accessed with the global Arduino Wire object. The software clock and shadow
+ *      register cache are disabled by default.
+ */
+ErriezDS3231::ErriezDS3231() :
+    _transport(NULL),
+    _setLatency(0), _lastError(ResultOk)
+{
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    _softEpoch = 0;
+    _softTicks = 0;
+    _softSubTicks = 0;
+    _softTickMs = 0;
+    _softTicksPerSecond = 1;
+    _softResyncTicks = 0;
+    _softValid = false;
+    _softResyncs = 0;
+    _softDriftEvents = 0;
+    _softDrift = 0;
+#endif
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    _shadowEnabled = false;
+    _shadowValid = 0;
+    _shadowSaved = 0;
+    memset(_shadow, 0, sizeof(_shadow));
+#endif
+
+#ifdef ERRIEZ_DS3231_RETRY
+    _retries = 0;
+    _busClearEnabled = false;
+    _retryDeadline = 0;
+    _sdaPin = 0xFF;
+    _sclPin = 0xFF;
+    _busFailures = 0;
+    _busRetries = 0;
+    _busClears = 0;
+#endif
+#if defined(ERRIEZ_DS3231_RETRY) || !defined(ARDUINO)
+    _busClock = 100000;
+#endif
+
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+    _timeCacheValid = false;
+    _timeCacheSynced = false;
+    _timeCacheSecondMs = 0;
+    _timeCacheReadMs = 0;
+    memset(_timeCache, 0, sizeof(_timeCache));
+#endif
+
+#ifdef ERRIEZ_DS3231_STATS
+    _statsClock = NULL;
+    resetStats();
+#endif
+}
+
+/*!
+ * \brief Constructor with bus transport.
+ * \details
+ *      Use this constructor for an RTC on another bus than the global Wire object, for example
+ *      ErriezDS3231WireTransport(Wire1), ErriezDS3231LinuxI2C or ErriezDS3231Loopback.
+ * \param transport
+ *      Bus transport.
+ */
+ErriezDS3231::ErriezDS3231(ErriezDS3231Transport *transport) :
+    ErriezDS3231()
+{
+    _transport = transport;
+}
+
 /*!
  * \brief Initialize and detect DS3231 RTC.
  * \details
@@ -51,8 +172,17 @@
  */
 bool ErriezDS3231::begin()
 {
+    DS3231_STATS_API(StatsApiBegin);
+
+    uint8_t status;
+
+    // Read status register
+    if (!readRegister(DS3231_REG_STATUS, &status)) {
+        return false;
+    }
+
     // Check zero bits in status register
-    if (readRegister(DS3231_REG_STATUS) & 0x70) {
+    if (status & 0x70) {
         return false;
     }
 
@@ -73,27 +203,16 @@ bool ErriezDS3231::begin()
  */
 bool ErriezDS3231::clockEnable(bool enable)
 {
-    uint8_t reg;
-
-    // Read status register
-    reg = readRegister(DS3231_REG_CONTROL);
+    DS3231_STATS_API(StatsApiOscillator);
 
     // Set or clear EOSC bit in control register
-    if (enable) {
-        reg &= ~(1 << DS3231_CTRL_EOSC);
-    } else {
-        reg |= (1 << DS3231_CTRL_EOSC);
-    }
-
-    // Write control register
-    if (!writeRegister(DS3231_REG_CONTROL, reg)) {
+    if (!updateRegister(DS3231_REG_CONTROL, (1 << DS3231_CTRL_EOSC),
+                        enable ? 0 : (1 << DS3231_CTRL_EOSC))) {
         return false;
     }
 
     // Clear OSF bit in status register
-    reg = readRegister(DS3231_REG_STATUS);
-    reg &= ~(1 << DS3231_STAT_OSF);
-    return writeRegister(DS3231_REG_STATUS, reg);
+    return updateRegister(DS3231_REG_STATUS, (1 << DS3231_STAT_OSF), 0);
 }
 
 /*!
@@ -105,12 +224,22 @@ bool ErriezDS3231::clockEnable(bool enable)
  *      RTC clock is running.
  * \retval false
  *      RTC oscillator was stopped: The date/time data is invalid. The application should
- *      synchronize and program a new date/time.
+ *      synchronize and program a new date/time. Also returned when the status register read
+ *      failed, see getLastError().
  */
 bool ErriezDS3231::isRunning()
 {
+    DS3231_STATS_API(StatsApiOscillator);
+
+    uint8_t status;
+
+    // Read status register
+    if (!readRegister(DS3231_REG_STATUS, &status)) {
+        return false;
+    }
+
     // Check OSF bit in status register
-    if (readRegister(DS3231_REG_STATUS) & (1 << DS3231_STAT_OSF)) {
+    if (status & (1 << DS3231_STAT_OSF)) {
         // RTC clock stopped
         return false;
     } else {
@@ -121,27 +250,38 @@ bool ErriezDS3231::isRunning()
 
 /*!
  * \brief Read Unix UTC epoch time_t
+ * \details
+ *      The date/time registers are converted directly to Unix epoch without libc mktime(), so the
+ *      result does not depend on the TZ setting.
  * \return
- *      Unix epoch time_t seconds since 1970.
+ *      Unix epoch time_t seconds since 1970, or 0 when the RTC read failed.
  */
 time_t ErriezDS3231::getEpoch()
 {
-    struct tm dt;
+    DS3231_STATS_API(StatsApiGetEpoch);
+
+    uint8_t buffer[7];
     time_t t;
 
-    // Read time structure
-    if (!read(&dt)) {
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // Return software clock without I2C transfer when enabled and synchronized
+    if (_softResyncTicks) {
+        if (softClockValid() || softClockSync()) {
+            return (time_t)softClockEpoch();
+        }
+    }
+#endif
+
+    // Read clock date and time registers
+    if (!readBuffer(0x00, buffer, sizeof(buffer))) {
         // RTC read failed
         return 0;
     }
 
-    // Convert date/time struct tm to time_t
-    t = mktime(&dt);
-
-    // An offset is needed for AVR target
-#ifdef ARDUINO_ARCH_AVR
-    t += UNIX_OFFSET;
-#endif
+    // Convert BCD registers directly to Unix epoch UTC
+    if (!decodeEpochRegisters(buffer, &t)) {
+        return 0;
+    }
 
     // Return Unix epoch UTC
     return t;
@@ -149,8 +289,11 @@ time_t ErriezDS3231::getEpoch()
 
 /*!
  * \brief Write Unix epoch UTC time to RTC
+ * \details
+ *      The epoch is converted directly to the date/time registers, including the day of the week.
+ *      This function does not use libc gmtime() and its shared static buffer and is reentrant.
  * \param t
- *      time_t time
+ *      time_t time in the range 2000..2099
  * \retval true
  *      Success.
  * \retval false
@@ -158,18 +301,103 @@ time_t ErriezDS3231::getEpoch()
  */
 bool ErriezDS3231::setEpoch(time_t t)
 {
-    struct tm *dt;
+    DS3231_STATS_API(StatsApiSetEpoch);
 
-    // Subtract UNIX offset for AVR targets
-#ifdef ARDUINO_ARCH_AVR
-    t -= UNIX_OFFSET;
-#endif
+    uint8_t buffer[7];
 
-    // Convert time_t to date/time struct tm
-    dt = gmtime(&t);
+    // Convert Unix epoch directly to BCD registers, including day of the week
+    if (!encodeEpochRegisters(t, buffer)) {
+        return false;
+    }
 
     // Write date/time to RTC
-    return write(dt);
+    return writeTimeRegisters(buffer);
+}
+
+/*!
+ * \brief Write Unix epoch UTC time to RTC at the start of a second.
+ * \details
+ *      Writing the seconds register restarts the RTC countdown chain. setEpoch() writes at an
+ *      arbitrary moment, which results in an error up to one second. This function enables the
+ *      oscillator and prepares the BCD registers first, then waits until the caller's clock
+ *      crosses the next second boundary and writes all date/time registers in one I2C transfer.
+ *
+ *      The countdown chain restarts at the acknowledge of the seconds register, about one third
+ *      into the transfer. The write is started earlier by one third of the write duration measured
+ *      at the previous call.
+ * \param t
+ *      Unix epoch UTC in the range 2000..2099 at the moment of the call.
+ * \param subsecondMicros
+ *      Microseconds elapsed since the start of second t at the moment of the call, 0..999999.
+ * \param clockMicros
+ *      Caller's microsecond clock, for example micros().
+ * \param writeLatencyMicros
+ *      Optional: Measured duration of the date/time register write in microseconds.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid argument or write failed.
+ */
+bool ErriezDS3231::setEpochAligned(time_t t, unsigned long subsecondMicros,
+                                   unsigned long (*clockMicros)(void),
+                                   unsigned long *writeLatencyMicros)
+{
+    DS3231_STATS_API(StatsApiSetEpoch);
+
+    uint8_t buffer[7];
+    unsigned long start;
+    unsigned long deadline;
+
+    // Reference point on the caller's clock
+    start = clockMicros();
+
+    if (subsecondMicros > 999999UL) {
+        return false;
+    }
+
+    // Write one third of the previous write duration before the second boundary
+    deadline = 1000000UL - subsecondMicros;
+    deadline = (deadline > (_setLatency / 3)) ? (deadline - (_setLatency / 3)) : 0;
+    t++;
+
+    // Enable oscillator before the deadline
+    if (!clockEnable(true)) {
+        return false;
+    }
+
+    // Use the next second boundary when preparation took too long
+    while ((unsigned long)(clockMicros() - start) >= deadline) {
+        deadline += 1000000UL;
+        t++;
+    }
+
+    // Prepare registers
+    if (!encodeEpochRegisters(t, buffer)) {
+        return false;
+    }
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // Software clock must be synchronized with the new date/time
+    _softValid = false;
+#endif
+
+    // Wait for the second boundary
+    while ((unsigned long)(clockMicros() - start) < deadline) {
+        ;
+    }
+
+    // Write all date/time registers in a single transfer
+    start = clockMicros();
+    if (!writeBuffer(0x00, buffer, sizeof(buffer))) {
+        return false;
+    }
+    _setLatency = clockMicros() - start;
+
+    if (writeLatencyMicros) {
+        *writeLatencyMicros = _setLatency;
+    }
+
+    return true;
 }
 
 /*!
@@ -186,6 +414,8 @@ bool ErriezDS3231::setEpoch(time_t t)
  */
 bool ErriezDS3231::read(struct tm *dt)
 {
+    DS3231_STATS_API(StatsApiRead);
+
     uint8_t buffer[7];
 
     // Read clock date and time registers
@@ -194,17 +424,205 @@ bool ErriezDS3231::read(struct tm *dt)
         return false;
     }
 
+    // Convert BCD buffer to struct tm
+    return decodeTimeRegisters(buffer, dt);
+}
+
+/*!
+ * \brief Read packed date and time from RTC.
+ * \details
+ *      Reads the date and time registers in one transfer and decodes them without a struct tm.
+ * \param dt
+ *      Packed date and time.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Read failed or invalid date or time in registers.
+ */
+bool ErriezDS3231::read(DS3231DateTime *dt)
+{
+    DS3231_STATS_API(StatsApiRead);
+
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+
+    // Read clock date and time registers
+    if (!readBuffer(0x00, buffer, sizeof(buffer))) {
+        memset(dt, 0, sizeof(DS3231DateTime));
+        return false;
+    }
+
+    // Convert BCD buffer to packed date and time
+    return decodeDateTime(buffer, dt);
+}
+
+/*!
+ * \brief Write packed date and time to RTC.
+ * \details
+ *      Writes all date and time registers at once, enables the oscillator and clears the
+ *      Oscillator Stop Flag (OSF).
+ * \param dt
+ *      Packed date and time.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Write failed.
+ */
+bool ErriezDS3231::write(const DS3231DateTime *dt)
+{
+    DS3231_STATS_API(StatsApiWrite);
+
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+
+    encodeDateTime(dt, buffer);
+
+    return writeTimeRegisters(buffer);
+}
+
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+/*!
+ * \brief Read date and time with a lazy register cache.
+ * \details
+ *      Uses the local millis() clock, see readCached(struct tm *, unsigned long). Without Arduino,
+ *      all date/time registers are read at each call.
+ * \param dt
+ *      Date and time struct tm.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Read failed or invalid date or time in registers.
+ */
+bool ErriezDS3231::readCached(struct tm *dt)
+{
+#ifdef ARDUINO
+    return readCached(dt, millis());
+#else
+    timeCacheInvalidate();
+    return readCached(dt, 0);
+#endif
+}
+
+/*!
+ * \brief Read date and time with a lazy register cache.
+ * \details
+ *      Intended for frequent polling. Within one second after the start of the cached second, the
+ *      cache is returned without I2C transfer. Otherwise only the seconds register is read. The
+ *      read is widened to the seconds, minutes and hours registers of getTime() after a minute
+ *      rollover, and to all date/time registers after an hour rollover. The start of the cached
+ *      second is the last poll before the seconds register changed, so a faster poll rate gives
+ *      longer cache hits.
+ *
+ *      Writes to the date/time registers via this object invalidate the cache. Call
+ *      timeCacheInvalidate() when the time is changed by another I2C master.
+ * \param dt
+ *      Date and time struct tm.
+ * \param nowMillis
+ *      Local clock in ms, for example millis().
+ * \retval true
+ *      Success
+ * \retval false
+ *      Read failed or invalid date or time in registers.
+ */
+bool ErriezDS3231::readCached(struct tm *dt, unsigned long nowMillis)
+{
+    DS3231_STATS_API(StatsApiRead);
+
+    unsigned long elapsed = nowMillis - _timeCacheReadMs;
+    uint8_t buffer[3];
+    uint8_t len = 7;
+
+    // Minutes may have changed without seconds rollover after a long interval
+    if (_timeCacheValid && (elapsed < 59000UL)) {
+        // No bus access within the cached second
+        if (_timeCacheSynced && ((unsigned long)(nowMillis - _timeCacheSecondMs) <
+                                 DS3231_TIME_CACHE_MS)) {
+            return decodeTimeRegisters(_timeCache, dt);
+        }
+
+        // Read seconds register only
+        if (!readBuffer(DS3231_REG_SECONDS, &buffer[0], 1)) {
+            memset(dt, 0, sizeof(struct tm));
+            return false;
+        }
+
+        if (buffer[0] == _timeCache[0]) {
+            // Same second: the next second starts after now
+            _timeCacheSynced = false;
+            _timeCacheReadMs = nowMillis;
+            return decodeTimeRegisters(_timeCache, dt);
+        } else if (buffer[0] > _timeCache[0]) {
+            // Seconds incremented without rollover
+            _timeCache[0] = buffer[0];
+            len = 0;
+        } else {
+            // Seconds rollover: read seconds, minutes and hours
+            if (!readBuffer(DS3231_REG_SECONDS, buffer, sizeof(buffer))) {
+                memset(dt, 0, sizeof(struct tm));
+                return false;
+            }
+            if (buffer[2] >= _timeCache[2]) {
+                // No hours rollover
+                memcpy(_timeCache, buffer, sizeof(buffer));
+                len = 0;
+            }
+        }
+
+        // The new second started after the previous poll
+        _timeCacheSynced = (elapsed < DS3231_TIME_CACHE_MS);
+        _timeCacheSecondMs = _timeCacheReadMs;
+    }
+
+    if (len) {
+        // Hours rollover or empty cache: read all date/time registers
+        if (!readBuffer(DS3231_REG_SECONDS, _timeCache, sizeof(_timeCache))) {
+            _timeCacheValid = false;
+            memset(dt, 0, sizeof(struct tm));
+            return false;
+        }
+        _timeCacheValid = true;
+    }
+
+    _timeCacheReadMs = nowMillis;
+
+    return decodeTimeRegisters(_timeCache, dt);
+}
+
+/*!
+ * \brief Invalidate the time cache of readCached().
+ */
+void ErriezDS3231::timeCacheInvalidate()
+{
+    _timeCacheValid = false;
+    _timeCacheSynced = false;
+}
+#endif
+
+/*!
+ * \brief Convert date and time registers to struct tm.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06.
+ * \param dt
+ *      Date and time struct tm.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Invalid date or time in registers.
+ */
+bool ErriezDS3231::decodeTimeRegisters(const uint8_t *buffer, struct tm *dt)
+{
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+
     // Clear dt
     memset(dt, 0, sizeof(struct tm));
 
     // Convert BCD buffer to Decimal
-    dt->tm_sec = bcdToDec(buffer[0] & 0x7F);
-    dt->tm_min = bcdToDec(buffer[1] & 0x7F);
-    dt->tm_hour = bcdToDec(buffer[2] & 0x3F);
-    dt->tm_wday = bcdToDec(buffer[3] & 0x07);
-    dt->tm_mday = bcdToDec(buffer[4] & 0x3F);
-    dt->tm_mon = bcdToDec(buffer[5] & 0x1F);
-    dt->tm_year = bcdToDec(buffer[6]) + 100; // 2000-1900
+    decodeTimeImage(buffer, fields);
+    dt->tm_sec = fields[DS3231_REG_SECONDS];
+    dt->tm_min = fields[DS3231_REG_MINUTES];
+    dt->tm_hour = fields[DS3231_REG_HOURS];
+    dt->tm_wday = fields[DS3231_REG_DAY_WEEK];
+    dt->tm_mday = fields[DS3231_REG_DAY_MONTH];
+    dt->tm_mon = fields[DS3231_REG_MONTH];
+    dt->tm_year = fields[DS3231_REG_YEAR] + 100; // 2000-1900
 
     // Month: 0..11
     if (dt->tm_mon) {
@@ -242,24 +660,48 @@ bool ErriezDS3231::read(struct tm *dt)
  */
 bool ErriezDS3231::write(const struct tm *dt)
 {
-    uint8_t buffer[7];
+    DS3231_STATS_API(StatsApiWrite);
+
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+    uint8_t buffer[DS3231_TIME_IMAGE_SIZE];
+
+    // Encode date time from decimal to BCD
+    fields[DS3231_REG_SECONDS] = (uint8_t)dt->tm_sec;
+    fields[DS3231_REG_MINUTES] = (uint8_t)dt->tm_min;
+    fields[DS3231_REG_HOURS] = (uint8_t)dt->tm_hour;
+    fields[DS3231_REG_DAY_WEEK] = (uint8_t)(dt->tm_wday + 1);
+    fields[DS3231_REG_DAY_MONTH] = (uint8_t)dt->tm_mday;
+    fields[DS3231_REG_MONTH] = (uint8_t)(dt->tm_mon + 1);
+    fields[DS3231_REG_YEAR] = (uint8_t)(dt->tm_year % 100);
+    encodeTimeImage(fields, buffer);
 
+    // Write BCD encoded buffer to RTC registers
+    return writeTimeRegisters(buffer);
+}
+
+/*!
+ * \brief Enable oscillator and write date and time registers.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Write failed.
+ */
+bool ErriezDS3231::writeTimeRegisters(uint8_t *buffer)
+{
     // Enable oscillator
     if (!clockEnable(true)) {
         return false;
     }
 
-    // Encode date time from decimal to BCD
-    buffer[0] = decToBcd(dt->tm_sec) & 0x7F;
-    buffer[1] = decToBcd(dt->tm_min) & 0x7F;
-    buffer[2] = decToBcd(dt->tm_hour) & 0x3F;
-    buffer[3] = decToBcd(dt->tm_wday + 1) & 0x07;
-    buffer[4] = decToBcd(dt->tm_mday) & 0x3F;
-    buffer[5] = decToBcd(dt->tm_mon + 1) & 0x1F;
-    buffer[6] = decToBcd(dt->tm_year % 100);
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // Software clock must be synchronized with the new date/time
+    _softValid = false;
+#endif
 
     // Write BCD encoded buffer to RTC registers
-    return writeBuffer(0x00, buffer, sizeof(buffer));
+    return writeBuffer(0x00, buffer, 7);
 }
 
 /*!
@@ -279,6 +721,8 @@ bool ErriezDS3231::write(const struct tm *dt)
  */
 bool ErriezDS3231::setTime(uint8_t hour, uint8_t min, uint8_t sec)
 {
+    DS3231_STATS_API(StatsApiSetTime);
+
     struct tm dt;
 
     read(&dt);
@@ -305,6 +749,8 @@ bool ErriezDS3231::setTime(uint8_t hour, uint8_t min, uint8_t sec)
  */
 bool ErriezDS3231::getTime(uint8_t *hour, uint8_t *min, uint8_t *sec)
 {
+    DS3231_STATS_API(StatsApiGetTime);
+
     uint8_t buffer[3];
 
     // Read RTC time registers
@@ -355,16 +801,18 @@ bool ErriezDS3231::setDateTime(uint8_t hour, uint8_t min, uint8_t sec,
                                uint8_t mday, uint8_t mon, uint16_t year,
                                uint8_t wday)
 {
-    struct tm dt;
+    DS3231_STATS_API(StatsApiSetTime);
 
-    // Prepare struct tm
-    dt.tm_hour = hour;
-    dt.tm_min = min;
-    dt.tm_sec = sec;
-    dt.tm_mday = mday;
-    dt.tm_mon = mon - 1;
-    dt.tm_year = year - 1900;
-    dt.tm_wday = wday;
+    DS3231DateTime dt;
+
+    // Prepare packed date and time
+    dt.hour = hour;
+    dt.min = min;
+    dt.sec = sec;
+    dt.mday = mday;
+    dt.mon = mon;
+    dt.year = year % 100;
+    dt.wday = wday;
 
     // Write date/time to RTC
     return write(&dt);
@@ -395,7 +843,9 @@ bool ErriezDS3231::getDateTime(uint8_t *hour, uint8_t *min, uint8_t *sec,
                                uint8_t *mday, uint8_t *mon, uint16_t *year,
                                uint8_t *wday)
 {
-    struct tm dt;
+    DS3231_STATS_API(StatsApiGetTime);
+
+    DS3231DateTime dt;
 
     // Read date/time from RTC
     if (!read(&dt)) {
@@ -403,13 +853,13 @@ bool ErriezDS3231::getDateTime(uint8_t *hour, uint8_t *min, uint8_t *sec,
     }
 
     // Set return values
-    *hour = dt.tm_hour;
-    *min = dt.tm_min;
-    *sec = dt.tm_sec;
-    *mday = dt.tm_mday;
-    *mon = dt.tm_mon + 1;
-    *year = dt.tm_year + 1900;
-    *wday = dt.tm_wday;
+    *hour = dt.hour;
+    *min = dt.min;
+    *sec = dt.sec;
+    *mday = dt.mday;
+    *mon = dt.mon;
+    *year = 2000 + dt.year;
+    *wday = dt.wday;
 
     return true;
 }
@@ -444,23 +894,15 @@ bool ErriezDS3231::getDateTime(uint8_t *hour, uint8_t *min, uint8_t *sec,
 bool ErriezDS3231::setAlarm1(Alarm1Type alarmType,
                              uint8_t dayDate, uint8_t hours, uint8_t minutes, uint8_t seconds)
 {
+    DS3231_STATS_API(StatsApiAlarm);
+
     uint8_t buffer[4];
 
     // Store alarm 1 registers in buffer
-    buffer[0] = decToBcd(seconds);
-    buffer[1] = decToBcd(minutes);
-    buffer[2] = decToBcd(hours);
-    buffer[3] = decToBcd(dayDate);
-
-    // Set alarm 1 bits
-    if (alarmType & 0x01) { buffer[0] |= (1 << DS3231_A1M1); }
-    if (alarmType & 0x02) { buffer[1] |= (1 << DS3231_A1M2); }
-    if (alarmType & 0x04) { buffer[2] |= (1 << DS3231_A1M3); }
-    if (alarmType & 0x08) { buffer[3] |= (1 << DS3231_A1M4); }
-    if (alarmType & 0x10) { buffer[3] |= (1 << DS3231_DYDT); }
+    encodeAlarm1Registers(alarmType, dayDate, hours, minutes, seconds, buffer);
 
     // Write alarm 1 registers
-    if (!writeBuffer(DS3231_REG_ALARM1_SEC, buffer, sizeof(buffer))) {
+    if (!writeCached(DS3231_REG_ALARM1_SEC, buffer, sizeof(buffer))) {
         return false;
     }
 
@@ -494,21 +936,15 @@ bool ErriezDS3231::setAlarm1(Alarm1Type alarmType,
  */
 bool ErriezDS3231::setAlarm2(Alarm2Type alarmType, uint8_t dayDate, uint8_t hours, uint8_t minutes)
 {
+    DS3231_STATS_API(StatsApiAlarm);
+
     uint8_t buffer[3];
 
     // Store alarm 2 registers in buffer
-    buffer[0] = decToBcd(minutes);
-    buffer[1] = decToBcd(hours);
-    buffer[2] = decToBcd(dayDate);
-
-    // Set alarm 2 bits
-    if (alarmType & 0x02) { buffer[0] |= (1 << DS3231_A1M2); }
-    if (alarmType & 0x04) { buffer[1] |= (1 << DS3231_A1M3); }
-    if (alarmType & 0x08) { buffer[2] |= (1 << DS3231_A1M4); }
-    if (alarmType & 0x10) { buffer[2] |= (1 << DS3231_DYDT); }
+    encodeAlarm2Registers(alarmType, dayDate, hours, minutes, buffer);
 
     // Write alarm 2 registers
-    if (!writeBuffer(DS3231_REG_ALARM2_MIN, buffer, sizeof(buffer))) {
+    if (!writeCached(DS3231_REG_ALARM2_MIN, buffer, sizeof(buffer))) {
         return false;
     }
 
@@ -533,26 +969,19 @@ bool ErriezDS3231::setAlarm2(Alarm2Type alarmType, uint8_t dayDate, uint8_t hour
  */
 bool ErriezDS3231::alarmInterruptEnable(AlarmId alarmId, bool enable)
 {
-    uint8_t controlReg;
+    DS3231_STATS_API(StatsApiAlarm);
+
+    uint8_t mask;
 
     // Clear alarm flag
     clearAlarmFlag(alarmId);
 
-    // Read control register
-    controlReg = readRegister(DS3231_REG_CONTROL);
-
-    // Disable square wave out and enable INT
-    controlReg |= (1 << DS3231_CTRL_INTCN);
-
-    // Set or clear alarm interrupt enable bit
-    if (enable) {
-        controlReg |= (1 << (alarmId - 1));
-    } else {
-        controlReg &= ~(1 << (alarmId - 1));
-    }
+    // Disable square wave out and enable INT, set or clear alarm interrupt enable bit
+    mask = (1 << DS3231_CTRL_INTCN) | (1 << (alarmId - 1));
 
     // Write control register
-    return writeRegister(DS3231_REG_CONTROL, controlReg);
+    return updateRegister(DS3231_REG_CONTROL, mask,
+                          enable ? mask : (1 << DS3231_CTRL_INTCN));
 }
 
 /*!
@@ -568,12 +997,21 @@ bool ErriezDS3231::alarmInterruptEnable(AlarmId alarmId, bool enable)
  * \retval true
  *      Alarm interrupt flag set.
  * \retval false
- *      Alarm interrupt flag cleared.
+ *      Alarm interrupt flag cleared, or status register read failed, see getLastError().
  */
 bool ErriezDS3231::getAlarmFlag(AlarmId alarmId)
 {
+    DS3231_STATS_API(StatsApiAlarmFlag);
+
+    uint8_t status;
+
+    // Read status register
+    if (!readRegister(DS3231_REG_STATUS, &status)) {
+        return false;
+    }
+
     // Mask alarm flags
-    if (readRegister(DS3231_REG_STATUS) & (1 << (alarmId - 1))) {
+    if (status & (1 << (alarmId - 1))) {
         return true;
     } else {
         return false;
@@ -595,16 +1033,70 @@ bool ErriezDS3231::getAlarmFlag(AlarmId alarmId)
  */
 bool ErriezDS3231::clearAlarmFlag(AlarmId alarmId)
 {
-    uint8_t statusReg;
+    DS3231_STATS_API(StatsApiAlarmFlag);
 
-    // Read status register
-    statusReg = readRegister(DS3231_REG_STATUS);
+    // Clear alarm interrupt flag in status register
+    return updateRegister(DS3231_REG_STATUS, (1 << (alarmId - 1)), 0);
+}
+
+/*!
+ * \brief Convert alarm 1 to registers 0x07..0x0A.
+ * \param alarmType
+ *      Alarm 1 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month. This depends on alarmType.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ * \param seconds
+ *      Alarm match seconds.
+ * \param buffer
+ *      4 alarm 1 registers.
+ */
+void ErriezDS3231::encodeAlarm1Registers(Alarm1Type alarmType, uint8_t dayDate, uint8_t hours,
+                                         uint8_t minutes, uint8_t seconds, uint8_t *buffer)
+{
+    // Store alarm 1 registers in buffer
+    buffer[0] = decToBcd(seconds);
+    buffer[1] = decToBcd(minutes);
+    buffer[2] = decToBcd(hours);
+    buffer[3] = decToBcd(dayDate);
+
+    // Set alarm 1 bits
+    if (alarmType & 0x01) { buffer[0] |= (1 << DS3231_A1M1); }
+    if (alarmType & 0x02) { buffer[1] |= (1 << DS3231_A1M2); }
+    if (alarmType & 0x04) { buffer[2] |= (1 << DS3231_A1M3); }
+    if (alarmType & 0x08) { buffer[3] |= (1 << DS3231_A1M4); }
+    if (alarmType & 0x10) { buffer[3] |= (1 << DS3231_DYDT); }
+}
 
-    // Clear alarm interrupt flag
-    statusReg &= ~(1 << (alarmId - 1));
+/*!
+ * \brief Convert alarm 2 to registers 0x0B..0x0D.
+ * \param alarmType
+ *      Alarm 2 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month. This depends on alarmType.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ * \param buffer
+ *      3 alarm 2 registers.
+ */
+void ErriezDS3231::encodeAlarm2Registers(Alarm2Type alarmType, uint8_t dayDate, uint8_t hours,
+                                         uint8_t minutes, uint8_t *buffer)
+{
+    // Store alarm 2 registers in buffer
+    buffer[0] = decToBcd(minutes);
+    buffer[1] = decToBcd(hours);
+    buffer[2] = decToBcd(dayDate);
 
-    // Write status register
-    return writeRegister(DS3231_REG_STATUS, statusReg);
+    // Set alarm 2 bits
+    if (alarmType & 0x02) { buffer[0] |= (1 << DS3231_A1M2); }
+    if (alarmType & 0x04) { buffer[1] |= (1 << DS3231_A1M3); }
+    if (alarmType & 0x08) { buffer[2] |= (1 << DS3231_A1M4); }
+    if (alarmType & 0x10) { buffer[2] |= (1 << DS3231_DYDT); }
 }
 
 /*!
@@ -626,18 +1118,15 @@ bool ErriezDS3231::clearAlarmFlag(AlarmId alarmId)
  */
 bool ErriezDS3231::setSquareWave(SquareWave squareWave)
 {
-    uint8_t controlReg;
-
-    // Read control register
-    controlReg = readRegister(DS3231_REG_CONTROL);
-    controlReg &= ~((1 << DS3231_CTRL_BBSQW) |
-                    (1 << DS3231_CTRL_INTCN) |
-                    (1 << DS3231_CTRL_RS2) |
-                    (1 << DS3231_CTRL_RS1));
-    controlReg |= squareWave;
+    DS3231_STATS_API(StatsApiOutput);
 
     // Write control register
-    return writeRegister(DS3231_REG_CONTROL, controlReg);
+    return updateRegister(DS3231_REG_CONTROL,
+                          (1 << DS3231_CTRL_BBSQW) |
+                          (1 << DS3231_CTRL_INTCN) |
+                          (1 << DS3231_CTRL_RS2) |
+                          (1 << DS3231_CTRL_RS1),
+                          squareWave);
 }
 
 /*!
@@ -652,20 +1141,11 @@ bool ErriezDS3231::setSquareWave(SquareWave squareWave)
  */
 bool ErriezDS3231::outputClockPinEnable(bool enable)
 {
-    uint8_t statusReg;
-
-    // Read status register
-    statusReg = readRegister(DS3231_REG_STATUS);
+    DS3231_STATS_API(StatsApiOutput);
 
     // Set or clear EN32kHz flag in status register
-    if (enable) {
-        statusReg |= (1 << DS3231_STAT_EN32KHZ);
-    } else {
-        statusReg &= ~(1 << DS3231_STAT_EN32KHZ);
-    }
-
-    // Write status register
-    return writeRegister(DS3231_REG_STATUS, statusReg);
+    return updateRegister(DS3231_REG_STATUS, (1 << DS3231_STAT_EN32KHZ),
+                          enable ? (1 << DS3231_STAT_EN32KHZ) : 0);
 }
 
 /*!
@@ -683,6 +1163,8 @@ bool ErriezDS3231::outputClockPinEnable(bool enable)
  */
 bool ErriezDS3231::setAgingOffset(int8_t val)
 {
+    DS3231_STATS_API(StatsApiAgingOffset);
+
     uint8_t regVal;
 
     // Convert 8-bit signed value to register value
@@ -695,7 +1177,7 @@ bool ErriezDS3231::setAgingOffset(int8_t val)
     }
 
     // Write aging offset register
-    if (!writeRegister(DS3231_REG_AGING_OFFSET, regVal)) {
+    if (!writeCached(DS3231_REG_AGING_OFFSET, &regVal, 1)) {
         return false;
     }
 
@@ -709,15 +1191,41 @@ bool ErriezDS3231::setAgingOffset(int8_t val)
  *      The aging offset register capacitance value is added or subtracted from the capacitance
  *      value that the device calculates for each temperature compensation.
  * \return val
- *      Aging offset value.
+ *      Aging offset value, or 0 when the read failed, see getLastError().
  */
 int8_t ErriezDS3231::getAgingOffset()
 {
+    DS3231_STATS_API(StatsApiAgingOffset);
+
     uint8_t regVal;
 
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    // Read aging register from shadow cache or RTC
+    if (_shadowValid & (1 << (DS3231_REG_AGING_OFFSET - DS3231_SHADOW_FIRST))) {
+        regVal = _shadow[DS3231_REG_AGING_OFFSET - DS3231_SHADOW_FIRST];
+        _shadowSaved++;
+    } else if (!readRegister(DS3231_REG_AGING_OFFSET, &regVal)) {
+        return 0;
+    }
+#else
     // Read aging register
-    regVal = readRegister(DS3231_REG_AGING_OFFSET);
+    if (!readRegister(DS3231_REG_AGING_OFFSET, &regVal)) {
+        return 0;
+    }
+#endif
 
+    return decodeAgingRegister(regVal);
+}
+
+/*!
+ * \brief Convert aging offset register to signed value.
+ * \param regVal
+ *      Aging offset register value.
+ * \return
+ *      Aging offset value -128..127.
+ */
+int8_t ErriezDS3231::decodeAgingRegister(uint8_t regVal)
+{
     // Convert to 8-bit signed value
     if (regVal & 0x80) {
         // Calculate two's complement for negative aging register value
@@ -740,18 +1248,22 @@ int8_t ErriezDS3231::getAgingOffset()
  */
 bool ErriezDS3231::startTemperatureConversion()
 {
-    uint8_t controlReg;
+    DS3231_STATS_API(StatsApiTemperature);
+
+    uint8_t status;
+
+    // Read status register
+    if (!readRegister(DS3231_REG_STATUS, &status)) {
+        return false;
+    }
 
     // Check if temperature busy flag is set
-    if (readRegister(DS3231_REG_STATUS) & (1 << DS3231_STAT_BSY)) {
+    if (status & (1 << DS3231_STAT_BSY)) {
         return false;
     }
 
     // Start temperature conversion
-    controlReg = readRegister(DS3231_REG_CONTROL) | (1 << DS3231_CTRL_CONV);
-
-    // Write control register
-    return writeRegister(DS3231_REG_CONTROL, controlReg);
+    return updateRegister(DS3231_REG_CONTROL, (1 << DS3231_CTRL_CONV), (1 << DS3231_CTRL_CONV));
 }
 
 /*!
@@ -768,6 +1280,8 @@ bool ErriezDS3231::startTemperatureConversion()
  */
 bool ErriezDS3231::getTemperature(int8_t *temperature, uint8_t *fraction)
 {
+    DS3231_STATS_API(StatsApiTemperature);
+
     uint8_t temp[2];
 
     // Read temperature MSB and LSB registers
@@ -775,8 +1289,26 @@ bool ErriezDS3231::getTemperature(int8_t *temperature, uint8_t *fraction)
         return false;
     }
 
+    // Convert temperature registers
+    decodeTemperatureRegisters(temp, temperature, fraction);
+
+    return true;
+}
+
+/*!
+ * \brief Convert temperature registers.
+ * \param buffer
+ *      Temperature MSB and LSB registers.
+ * \param temperature
+ *      8-bit signed temperature in degree Celsius.
+ * \param fraction
+ *      Temperature fraction 0, 25, 50 or 75 (0.01 degree Celsius).
+ */
+void ErriezDS3231::decodeTemperatureRegisters(const uint8_t *buffer,
+                                              int8_t *temperature, uint8_t *fraction)
+{
     // Set temperature argument
-    *temperature = temp[0];
+    *temperature = buffer[0];
 
     // Calculate two's complement when negative
     if (*temperature & 0x80) {
@@ -784,129 +1316,2029 @@ bool ErriezDS3231::getTemperature(int8_t *temperature, uint8_t *fraction)
     }
 
     // Shift fraction bits 6 and 7 with 0.25 degree Celsius resolution
-    *fraction = (temp[1] >> 6) * 25;
-
-    return true;
+    *fraction = (buffer[1] >> 6) * 25;
 }
 
 /*!
- * \brief BCD to decimal conversion.
- * \param bcd
- *      BCD encoded value.
- * \return
- *      Decimal value.
+ * \brief Read all RTC registers in a single I2C transaction.
+ * \details
+ *      Use the static decode functions to retrieve date/time, alarm, status, aging offset and
+ *      temperature from the snapshot. This replaces a series of separate register reads, such as
+ *      read(), getAlarmFlag(), isRunning() and getTemperature(), by one I2C transfer.
+ * \param snapshot
+ *      Snapshot of registers 0x00..0x12.
+ * \retval true
+ *      Success
+ * \retval false
+ *      I2C read failed.
  */
-uint8_t ErriezDS3231::bcdToDec(uint8_t bcd)
+bool ErriezDS3231::readSnapshot(DS3231Snapshot *snapshot)
 {
-    return (uint8_t)(10 * ((bcd & 0xF0) >> 4) + (bcd & 0x0F));
+    DS3231_STATS_API(StatsApiSnapshot);
+
+    // Read all registers at once
+    return readBuffer(DS3231_REG_SECONDS, snapshot->regs, DS3231_NUM_REGS);
 }
 
 /*!
- * \brief Decimal to BCD conversion.
- * \param dec
- *      Decimal value.
- * \return
- *      BCD encoded value.
+ * \brief Decode date and time from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param dt
+ *      Date and time struct tm.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Invalid date or time in snapshot.
  */
-uint8_t ErriezDS3231::decToBcd(uint8_t dec)
+bool ErriezDS3231::decodeTime(const DS3231Snapshot *snapshot, struct tm *dt)
 {
-    return (uint8_t)(((dec / 10) << 4) | (dec % 10));
+    return decodeTimeRegisters(&snapshot->regs[DS3231_REG_SECONDS], dt);
 }
 
 /*!
- * \brief Read register.
- * \details
- *      Please refer to the RTC datasheet.
- * \param reg
- *      RTC register number 0x00..0x12.
- * \returns value
- *      8-bit unsigned register value.
+ * \brief Decode Unix epoch UTC from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param t
+ *      Unix epoch seconds since 1970.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Invalid date or time in snapshot.
  */
-uint8_t ErriezDS3231::readRegister(uint8_t reg)
+bool ErriezDS3231::decodeEpoch(const DS3231Snapshot *snapshot, time_t *t)
 {
-    uint8_t value = 0;
-
-    // Read buffer with one 8-bit unsigned value
-    readBuffer(reg, &value, 1);
-
-    return value;
+    return decodeEpochRegisters(&snapshot->regs[DS3231_REG_SECONDS], t);
 }
 
 /*!
- * \brief Write register.
+ * \brief Convert number of days since 1 January 1970 to date.
  * \details
- *      Please refer to the RTC datasheet.
- * \param reg
- *      RTC register number 0x00..0x12.
- * \param value
- *      8-bit unsigned register value.
- * \retval true
- *      Success
- * \retval false
- *      Write register failed
+ *      Inverse of daysFromCivil(). No libc functions or static buffers are used, so this function
+ *      is reentrant.
+ * \param days
+ *      Days since 1970 in the range 2000..2099.
+ * \param year
+ *      Year 2000..2099.
+ * \param mon
+ *      Month 1..12 (1=January).
+ * \param mday
+ *      Day of the month 1..31.
  */
-bool ErriezDS3231::writeRegister(uint8_t reg, uint8_t value)
+void ErriezDS3231::civilFromDays(uint16_t days, uint16_t *year, uint8_t *mon, uint8_t *mday)
 {
-    // Write buffer with one 8-bit unsigned value
-    return writeBuffer(reg, &value, 1);
+    uint16_t yearDay;
+    uint8_t yy;
+    uint8_t leap;
+
+    // Days since 2000: every 4-year cycle starts with a leap year (2000 is a leap year)
+    days -= DAYS_FROM_1970_TO_2000;
+    yy = (uint8_t)((4UL * days) / 1461);
+    yearDay = days - (365U * yy + (yy + 3U) / 4);
+    leap = (yy & 3) ? 0 : 1;
+
+    *year = 2000 + yy;
+
+    if (yearDay < 31) {
+        // January
+        *mon = 1;
+        *mday = yearDay + 1;
+    } else if (yearDay < (59U + leap)) {
+        // February
+        *mon = 2;
+        *mday = yearDay - 30;
+    } else {
+        // March..December: months with alternating 31 and 30 days in 153-day groups
+        yearDay -= 59 + leap;
+        *mon = (uint8_t)((5U * yearDay + 2) / 153);
+        *mday = (uint8_t)(yearDay - (153U * *mon + 2) / 5 + 1);
+        *mon += 3;
+    }
 }
 
 /*!
- * \brief Write buffer to RTC.
- * \details
- *      Please refer to the RTC datasheet.
- * \param reg
- *      RTC register number 0x00..0x12.
+ * \brief Convert date and time registers to Unix epoch.
  * \param buffer
- *      Buffer.
- * \param writeLen
- *      Buffer length. Writing is only allowed within valid RTC registers.
+ *      BCD encoded registers 0x00..0x06.
+ * \param t
+ *      Unix epoch seconds since 1970.
  * \retval true
  *      Success
  * \retval false
- *      I2C write failed.
+ *      Invalid date or time in registers.
  */
-bool ErriezDS3231::writeBuffer(uint8_t reg, void *buffer, uint8_t writeLen)
+bool ErriezDS3231::decodeEpochRegisters(const uint8_t *buffer, time_t *t)
 {
-    // Start I2C transfer by writing the I2C address, register number and optional buffer
-    Wire.beginTransmission(DS3231_ADDR);
-    Wire.write(reg);
-    for (uint8_t i = 0; i < writeLen; i++) {
-        Wire.write(((uint8_t *)buffer)[i]);
-    }
-    if (Wire.endTransmission(true) != 0) {
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+
+    decodeTimeImage(buffer, fields);
+
+    uint8_t sec = fields[DS3231_REG_SECONDS];
+    uint8_t min = fields[DS3231_REG_MINUTES];
+    uint8_t hour = fields[DS3231_REG_HOURS];
+    uint8_t mday = fields[DS3231_REG_DAY_MONTH];
+    uint8_t mon = fields[DS3231_REG_MONTH];
+    uint8_t year = fields[DS3231_REG_YEAR];
+
+    // Check buffer for valid data
+    if ((sec > 59) || (min > 59) || (hour > 23) || (mday < 1) || (mday > 31) ||
+        (mon < 1) || (mon > 12) || (year > 99)) {
+        *t = 0;
         return false;
     }
 
+    *t = (time_t)epochFromCivil(2000 + year, mon, mday, hour, min, sec);
+
     return true;
 }
 
 /*!
- * \brief Read buffer from RTC.
- * \param reg
- *      RTC register number 0x00..0x12.
+ * \brief Convert Unix epoch to date and time registers.
+ * \param t
+ *      Unix epoch seconds since 1970 in the range 2000..2099.
  * \param buffer
- *      Buffer.
- * \param readLen
- *      Buffer length. Reading is only allowed within valid RTC registers.
+ *      BCD encoded registers 0x00..0x06, including day of the week.
  * \retval true
  *      Success
  * \retval false
- *      I2C read failed.
+ *      Epoch out of range.
  */
-bool ErriezDS3231::readBuffer(uint8_t reg, void *buffer, uint8_t readLen)
+bool ErriezDS3231::encodeEpochRegisters(time_t t, uint8_t *buffer)
 {
-    // Start I2C transfer by writing the I2C address and register number
-    Wire.beginTransmission(DS3231_ADDR);
-    Wire.write(reg);
-    // Generate a repeated start, followed by a read buffer
-    if (Wire.endTransmission(false) != 0) {
+    uint32_t secs = (uint32_t)t;
+    uint16_t days;
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+
+    // The RTC supports years 2000..2099
+    if ((t < (time_t)SECONDS_FROM_1970_TO_2000) || (secs >= SECONDS_FROM_1970_TO_2100)) {
         return false;
     }
-    Wire.requestFrom((uint8_t)DS3231_ADDR, readLen);
-    for (uint8_t i = 0; i < readLen; i++) {
-        ((uint8_t *)buffer)[i] = (uint8_t)Wire.read();
-    }
+
+    days = (uint16_t)(secs / 86400UL);
+    secs -= days * 86400UL;
+    civilFromDays(days, &year, &mon, &mday);
+
+    fields[DS3231_REG_SECONDS] = (uint8_t)(secs % 60);
+    fields[DS3231_REG_MINUTES] = (uint8_t)((secs / 60) % 60);
+    fields[DS3231_REG_HOURS] = (uint8_t)(secs / 3600);
+    fields[DS3231_REG_DAY_WEEK] = (uint8_t)(weekdayFromDays(days) + 1);
+    fields[DS3231_REG_DAY_MONTH] = mday;
+    fields[DS3231_REG_MONTH] = mon;
+    fields[DS3231_REG_YEAR] = (uint8_t)(year - 2000);
+    encodeTimeImage(fields, buffer);
 
     return true;
 }
+
+/*!
+ * \brief Decode Alarm 1 from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param alarmType
+ *      Alarm 1 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ * \param seconds
+ *      Alarm match seconds.
+ */
+void ErriezDS3231::decodeAlarm1(const DS3231Snapshot *snapshot, Alarm1Type *alarmType,
+                                uint8_t *dayDate, uint8_t *hours, uint8_t *minutes,
+                                uint8_t *seconds)
+{
+    const uint8_t *buffer = &snapshot->regs[DS3231_REG_ALARM1_SEC];
+    uint8_t type = 0;
+
+    // Collect alarm 1 bits
+    if (buffer[0] & (1 << DS3231_A1M1)) { type |= 0x01; }
+    if (buffer[1] & (1 << DS3231_A1M2)) { type |= 0x02; }
+    if (buffer[2] & (1 << DS3231_A1M3)) { type |= 0x04; }
+    if (buffer[3] & (1 << DS3231_A1M4)) { type |= 0x08; }
+    if (buffer[3] & (1 << DS3231_DYDT)) { type |= 0x10; }
+    *alarmType = (Alarm1Type)type;
+
+    // Convert BCD registers to Decimal
+    *seconds = bcdToDec(buffer[0] & 0x7F);
+    *minutes = bcdToDec(buffer[1] & 0x7F);
+    *hours = bcdToDec(buffer[2] & 0x3F);
+    *dayDate = bcdToDec(buffer[3] & 0x3F);
+}
+
+/*!
+ * \brief Decode Alarm 2 from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param alarmType
+ *      Alarm 2 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ */
+void ErriezDS3231::decodeAlarm2(const DS3231Snapshot *snapshot, Alarm2Type *alarmType,
+                                uint8_t *dayDate, uint8_t *hours, uint8_t *minutes)
+{
+    const uint8_t *buffer = &snapshot->regs[DS3231_REG_ALARM2_MIN];
+    uint8_t type = 0;
+
+    // Collect alarm 2 bits
+    if (buffer[0] & (1 << DS3231_A2M2)) { type |= 0x02; }
+    if (buffer[1] & (1 << DS3231_A2M3)) { type |= 0x04; }
+    if (buffer[2] & (1 << DS3231_A2M4)) { type |= 0x08; }
+    if (buffer[2] & (1 << DS3231_DYDT)) { type |= 0x10; }
+    *alarmType = (Alarm2Type)type;
+
+    // Convert BCD registers to Decimal
+    *minutes = bcdToDec(buffer[0] & 0x7F);
+    *hours = bcdToDec(buffer[1] & 0x3F);
+    *dayDate = bcdToDec(buffer[2] & 0x3F);
+}
+
+/*!
+ * \brief Decode Alarm 1 or 2 flag from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param alarmId
+ *      Alarm1 or Alarm2 enum.
+ * \retval true
+ *      Alarm interrupt flag set.
+ * \retval false
+ *      Alarm interrupt flag cleared.
+ */
+bool ErriezDS3231::decodeAlarmFlag(const DS3231Snapshot *snapshot, AlarmId alarmId)
+{
+    return (snapshot->regs[DS3231_REG_STATUS] & (1 << (alarmId - 1))) ? true : false;
+}
+
+/*!
+ * \brief Decode Alarm 1 or 2 interrupt enable from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param alarmId
+ *      Alarm1 or Alarm2 enum.
+ * \retval true
+ *      Alarm interrupt enabled.
+ * \retval false
+ *      Alarm interrupt disabled.
+ */
+bool ErriezDS3231::decodeAlarmInterruptEnable(const DS3231Snapshot *snapshot, AlarmId alarmId)
+{
+    return (snapshot->regs[DS3231_REG_CONTROL] & (1 << (alarmId - 1))) ? true : false;
+}
+
+/*!
+ * \brief Decode OSF (Oscillator Stop Flag) from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \retval true
+ *      RTC clock is running.
+ * \retval false
+ *      RTC oscillator was stopped: The date/time data is invalid.
+ */
+bool ErriezDS3231::decodeRunning(const DS3231Snapshot *snapshot)
+{
+    return (snapshot->regs[DS3231_REG_STATUS] & (1 << DS3231_STAT_OSF)) ? false : true;
+}
+
+/*!
+ * \brief Decode SQW (Square Wave) configuration from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \return
+ *      SquareWaveDisable when INTCN is set, otherwise the square wave frequency.
+ */
+SquareWave ErriezDS3231::decodeSquareWave(const DS3231Snapshot *snapshot)
+{
+    uint8_t controlReg = snapshot->regs[DS3231_REG_CONTROL];
+
+    if (controlReg & (1 << DS3231_CTRL_INTCN)) {
+        return SquareWaveDisable;
+    }
+
+    return (SquareWave)(controlReg & ((1 << DS3231_CTRL_RS2) | (1 << DS3231_CTRL_RS1)));
+}
+
+/*!
+ * \brief Decode 32kHz output clock pin enable from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \retval true
+ *      32kHz output clock pin enabled.
+ * \retval false
+ *      32kHz output clock pin disabled.
+ */
+bool ErriezDS3231::decodeOutputClockPin(const DS3231Snapshot *snapshot)
+{
+    return (snapshot->regs[DS3231_REG_STATUS] & (1 << DS3231_STAT_EN32KHZ)) ? true : false;
+}
+
+/*!
+ * \brief Decode temperature conversion busy flag from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \retval true
+ *      Temperature conversion in progress.
+ * \retval false
+ *      No temperature conversion in progress.
+ */
+bool ErriezDS3231::decodeTemperatureBusy(const DS3231Snapshot *snapshot)
+{
+    return (snapshot->regs[DS3231_REG_STATUS] & (1 << DS3231_STAT_BSY)) ? true : false;
+}
+
+/*!
+ * \brief Decode aging offset from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \return
+ *      Aging offset value.
+ */
+int8_t ErriezDS3231::decodeAgingOffset(const DS3231Snapshot *snapshot)
+{
+    return decodeAgingRegister(snapshot->regs[DS3231_REG_AGING_OFFSET]);
+}
+
+/*!
+ * \brief Decode temperature from register snapshot.
+ * \param snapshot
+ *      Register snapshot.
+ * \param temperature
+ *      8-bit signed temperature in degree Celsius.
+ * \param fraction
+ *      Temperature fraction in steps of 0.25 degree Celsius, see getTemperature().
+ */
+void ErriezDS3231::decodeTemperature(const DS3231Snapshot *snapshot,
+                                     int8_t *temperature, uint8_t *fraction)
+{
+    decodeTemperatureRegisters(&snapshot->regs[DS3231_REG_TEMP_MSB], temperature, fraction);
+}
+
+/*!
+ * \brief Register masks of the date and time image, removing the 12/24 hour and century bits.
+ */
+static const uint8_t timeImageMask[DS3231_TIME_IMAGE_SIZE] = {
+    0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x1F, 0xFF
+};
+
+#if DS3231_BCD_SWAR_BITS
+#if (DS3231_BCD_SWAR_BITS == 64)
+typedef uint64_t BcdWord;   //!< Packed BCD word
+#else
+typedef uint32_t BcdWord;   //!< Packed BCD word
+#endif
+
+//! Packed word with value 1 in every byte
+#define BCD_BYTES   ((BcdWord)~(BcdWord)0 / 0xFF)
+//! Packed word with value 1 in every 16-bit lane
+#define BCD_LANES   ((BcdWord)~(BcdWord)0 / 0xFFFF)
+
+/*!
+ * \brief Load 4 bytes in a 32-bit word.
+ * \param src
+ *      Source bytes, any alignment.
+ * \return
+ *      Bytes in native byte order.
+ */
+static inline uint32_t loadBcdWord(const uint8_t *src)
+{
+    uint32_t word;
+
+    memcpy(&word, src, sizeof(word));
+
+    return word;
+}
+
+/*!
+ * \brief Store a 32-bit word as 4 bytes.
+ * \param dst
+ *      Destination bytes, any alignment.
+ * \param word
+ *      Bytes in native byte order.
+ */
+static inline void storeBcdWord(uint8_t *dst, uint32_t word)
+{
+    memcpy(dst, &word, sizeof(word));
+}
+
+/*!
+ * \brief Decode packed BCD bytes to decimal.
+ * \details
+ *      The tens nibble of every byte is multiplied by 10 at once. No byte exceeds 165, so no
+ *      carry crosses a byte boundary.
+ * \param word
+ *      Packed BCD bytes.
+ * \return
+ *      Packed decimal bytes.
+ */
+static inline BcdWord bcdWordToDec(BcdWord word)
+{
+    return (word & (BCD_BYTES * 0x0F)) + ((word >> 4) & (BCD_BYTES * 0x0F)) * 10;
+}
+
+/*!
+ * \brief Encode packed decimal bytes to BCD.
+ * \details
+ *      BCD = dec + 6 * (dec / 10). The division by 10 is calculated as (dec * 205) >> 11 in
+ *      16-bit lanes, separately for the even and odd bytes.
+ * \param word
+ *      Packed decimal bytes.
+ * \return
+ *      Packed BCD bytes.
+ */
+static inline BcdWord decWordToBcd(BcdWord word)
+{
+    BcdWord even = word & (BCD_LANES * 0xFF);
+    BcdWord odd = (word >> 8) & (BCD_LANES * 0xFF);
+    BcdWord tens;
+
+    tens = (((even * 205) >> 11) & (BCD_LANES * 0x0F)) |
+           ((((odd * 205) >> 11) & (BCD_LANES * 0x0F)) << 8);
+
+    return word + tens * 6;
+}
+#endif
+
+#if defined(__SSE2__) && !defined(ARDUINO)
+/*!
+ * \brief Decode 16 date and time images with SSE2.
+ * \details
+ *      16 records of 7 bytes are exactly 7 vectors, so the register masks repeat every 7 vectors.
+ * \param records
+ *      112 BCD encoded bytes.
+ * \param fields
+ *      112 decoded bytes.
+ * \param masks
+ *      Register masks repeated over 16 records.
+ */
+static void decodeTimeImagesSse2(const uint8_t *records, uint8_t *fields, const __m128i *masks)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i ten = _mm_set1_epi16(10);
+    __m128i v;
+
+    for (uint8_t i = 0; i < DS3231_TIME_IMAGE_SIZE; i++) {
+        v = _mm_and_si128(_mm_loadu_si128((const __m128i *)&records[i * 16]), masks[i]);
+        // Tens nibbles are at most 15, so 10 * tens does not carry into the high byte of a lane
+        v = _mm_add_epi8(_mm_and_si128(v, nibble),
+                         _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(v, 4), nibble), ten));
+        _mm_storeu_si128((__m128i *)&fields[i * 16], v);
+    }
+}
+#endif
+
+/*!
+ * \brief Decode date and time registers to decimal fields.
+ * \details
+ *      Converts the complete register image at once: one packed word on 64-bit targets, two on
+ *      32-bit targets and one register at a time on AVR. The fields are not validated.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06.
+ * \param fields
+ *      Decimal fields in register order, may be equal to buffer: seconds, minutes, hours
+ *      (24-hour), day of the week 1..7, day of the month, month 1..12 and year 0..99.
+ */
+void ErriezDS3231::decodeTimeImage(const uint8_t *buffer, uint8_t *fields)
+{
+    // Registers 0x00..0x03 and 0x03..0x06 overlap, which avoids loads and stores of 7 bytes.
+    // Byte order is irrelevant, because the registers and masks are loaded the same way.
+#if (DS3231_BCD_SWAR_BITS == 64)
+    BcdWord word = loadBcdWord(buffer) | ((BcdWord)loadBcdWord(&buffer[3]) << 32);
+    BcdWord mask = loadBcdWord(timeImageMask) | ((BcdWord)loadBcdWord(&timeImageMask[3]) << 32);
+
+    word = bcdWordToDec(word & mask);
+    storeBcdWord(fields, (uint32_t)word);
+    storeBcdWord(&fields[3], (uint32_t)(word >> 32));
+#elif DS3231_BCD_SWAR_BITS
+    BcdWord low = bcdWordToDec(loadBcdWord(buffer) & loadBcdWord(timeImageMask));
+    BcdWord high = bcdWordToDec(loadBcdWord(&buffer[3]) & loadBcdWord(&timeImageMask[3]));
+
+    storeBcdWord(fields, low);
+    storeBcdWord(&fields[3], high);
+#else
+    fields[0] = bcdToDec(buffer[0] & 0x7F);
+    fields[1] = bcdToDec(buffer[1] & 0x7F);
+    fields[2] = bcdToDec(buffer[2] & 0x3F);
+    fields[3] = bcdToDec(buffer[3] & 0x07);
+    fields[4] = bcdToDec(buffer[4] & 0x3F);
+    fields[5] = bcdToDec(buffer[5] & 0x1F);
+    fields[6] = bcdToDec(buffer[6]);
+#endif
+}
+
+/*!
+ * \brief Encode decimal fields to date and time registers.
+ * \param fields
+ *      Decimal fields in register order, see decodeTimeImage(). Fields larger than 99 result in
+ *      unpredictable register values.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06, 24-hour mode.
+ */
+void ErriezDS3231::encodeTimeImage(const uint8_t *fields, uint8_t *buffer)
+{
+#if (DS3231_BCD_SWAR_BITS == 64)
+    BcdWord word = loadBcdWord(fields) | ((BcdWord)loadBcdWord(&fields[3]) << 32);
+    BcdWord mask = loadBcdWord(timeImageMask) | ((BcdWord)loadBcdWord(&timeImageMask[3]) << 32);
+
+    word = decWordToBcd(word) & mask;
+    storeBcdWord(buffer, (uint32_t)word);
+    storeBcdWord(&buffer[3], (uint32_t)(word >> 32));
+#elif DS3231_BCD_SWAR_BITS
+    BcdWord low = decWordToBcd(loadBcdWord(fields)) & loadBcdWord(timeImageMask);
+    BcdWord high = decWordToBcd(loadBcdWord(&fields[3])) & loadBcdWord(&timeImageMask[3]);
+
+    storeBcdWord(buffer, low);
+    storeBcdWord(&buffer[3], high);
+#else
+    buffer[0] = decToBcd(fields[0]) & 0x7F;
+    buffer[1] = decToBcd(fields[1]) & 0x7F;
+    buffer[2] = decToBcd(fields[2]) & 0x3F;
+    buffer[3] = decToBcd(fields[3]) & 0x07;
+    buffer[4] = decToBcd(fields[4]) & 0x3F;
+    buffer[5] = decToBcd(fields[5]) & 0x1F;
+    buffer[6] = decToBcd(fields[6]);
+#endif
+}
+
+/*!
+ * \brief Decode an array of logged date and time register images.
+ * \details
+ *      Bulk variant of decodeTimeImage() for raw 7-byte register records. On x86 with SSE2, 16
+ *      records are decoded per iteration.
+ * \param records
+ *      Array of count BCD encoded register images of 7 bytes, without padding.
+ * \param fields
+ *      Array of count decoded images of 7 bytes. May be equal to records.
+ * \param count
+ *      Number of records.
+ */
+void ErriezDS3231::decodeTimeImages(const uint8_t *records, uint8_t *fields, size_t count)
+{
+#if defined(__SSE2__) && !defined(ARDUINO)
+    __m128i masks[DS3231_TIME_IMAGE_SIZE];
+    uint8_t pattern[16 * DS3231_TIME_IMAGE_SIZE];
+
+    // Repeat the register masks over 16 records
+    for (uint8_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = timeImageMask[i % DS3231_TIME_IMAGE_SIZE];
+    }
+    for (uint8_t i = 0; i < DS3231_TIME_IMAGE_SIZE; i++) {
+        masks[i] = _mm_loadu_si128((const __m128i *)&pattern[i * 16]);
+    }
+
+    // Decode blocks of 16 records
+    while (count >= 16) {
+        decodeTimeImagesSse2(records, fields, masks);
+        records += sizeof(pattern);
+        fields += sizeof(pattern);
+        count -= 16;
+    }
+#endif
+
+    // Decode remaining records
+    while (count--) {
+        decodeTimeImage(records, fields);
+        records += DS3231_TIME_IMAGE_SIZE;
+        fields += DS3231_TIME_IMAGE_SIZE;
+    }
+}
+
+/*!
+ * \brief Decode date and time registers to packed date and time.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06.
+ * \param dt
+ *      Packed date and time.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Invalid date or time in registers, dt is cleared.
+ */
+bool ErriezDS3231::decodeDateTime(const uint8_t *buffer, DS3231DateTime *dt)
+{
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+
+    decodeTimeImage(buffer, fields);
+
+    // Check buffer for valid data
+    if ((fields[DS3231_REG_SECONDS] > 59) || (fields[DS3231_REG_MINUTES] > 59) ||
+        (fields[DS3231_REG_HOURS] > 23) ||
+        (fields[DS3231_REG_DAY_WEEK] < 1) || (fields[DS3231_REG_DAY_WEEK] > 7) ||
+        (fields[DS3231_REG_DAY_MONTH] < 1) || (fields[DS3231_REG_DAY_MONTH] > 31) ||
+        (fields[DS3231_REG_MONTH] < 1) || (fields[DS3231_REG_MONTH] > 12) ||
+        (fields[DS3231_REG_YEAR] > 99)) {
+        memset(dt, 0, sizeof(DS3231DateTime));
+        return false;
+    }
+
+    dt->sec = fields[DS3231_REG_SECONDS];
+    dt->min = fields[DS3231_REG_MINUTES];
+    dt->hour = fields[DS3231_REG_HOURS];
+    dt->wday = fields[DS3231_REG_DAY_WEEK] - 1;
+    dt->mday = fields[DS3231_REG_DAY_MONTH];
+    dt->mon = fields[DS3231_REG_MONTH];
+    dt->year = fields[DS3231_REG_YEAR];
+
+    return true;
+}
+
+/*!
+ * \brief Encode packed date and time to date and time registers.
+ * \param dt
+ *      Packed date and time.
+ * \param buffer
+ *      BCD encoded registers 0x00..0x06, 24-hour mode.
+ */
+void ErriezDS3231::encodeDateTime(const DS3231DateTime *dt, uint8_t *buffer)
+{
+    uint8_t fields[DS3231_TIME_IMAGE_SIZE];
+
+    fields[DS3231_REG_SECONDS] = dt->sec;
+    fields[DS3231_REG_MINUTES] = dt->min;
+    fields[DS3231_REG_HOURS] = dt->hour;
+    fields[DS3231_REG_DAY_WEEK] = dt->wday + 1;
+    fields[DS3231_REG_DAY_MONTH] = dt->mday;
+    fields[DS3231_REG_MONTH] = dt->mon;
+    fields[DS3231_REG_YEAR] = dt->year;
+
+    encodeTimeImage(fields, buffer);
+}
+
+/*!
+ * \brief Convert packed date and time to Unix epoch.
+ * \param dt
+ *      Packed date and time.
+ * \return
+ *      Seconds since 1970 UTC.
+ */
+uint32_t ErriezDS3231::dateTimeToEpoch(const DS3231DateTime *dt)
+{
+    return epochFromCivil(2000 + dt->year, dt->mon, dt->mday, dt->hour, dt->min, dt->sec);
+}
+
+/*!
+ * \brief Compare packed dates and times.
+ * \details
+ *      The day of the week is ignored.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \retval -1
+ *      a is before b.
+ * \retval 0
+ *      a is equal to b.
+ * \retval 1
+ *      a is after b.
+ */
+int8_t ErriezDS3231::compareDateTime(const DS3231DateTime *a, const DS3231DateTime *b)
+{
+    uint16_t dateA = ((uint16_t)a->year << 9) | ((uint16_t)a->mon << 5) | a->mday;
+    uint16_t dateB = ((uint16_t)b->year << 9) | ((uint16_t)b->mon << 5) | b->mday;
+    uint32_t timeA;
+    uint32_t timeB;
+
+    if (dateA != dateB) {
+        return (dateA < dateB) ? -1 : 1;
+    }
+
+    timeA = ((uint32_t)a->hour << 12) | ((uint16_t)a->min << 6) | a->sec;
+    timeB = ((uint32_t)b->hour << 12) | ((uint16_t)b->min << 6) | b->sec;
+    if (timeA != timeB) {
+        return (timeA < timeB) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*!
+ * \brief Read register.
+ * \details
+ *      Please refer to the RTC datasheet. Returns 0 when the read failed, see getLastError().
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \returns value
+ *      8-bit unsigned register value.
+ */
+uint8_t ErriezDS3231::readRegister(uint8_t reg)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    uint8_t value = 0;
+
+    // Read buffer with one 8-bit unsigned value
+    readBuffer(reg, &value, 1);
+
+    return value;
+}
+
+/*!
+ * \brief Read register with error detection.
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \param value
+ *      8-bit unsigned register value.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Read register failed, see getLastError().
+ */
+bool ErriezDS3231::readRegister(uint8_t reg, uint8_t *value)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    return readBuffer(reg, value, 1);
+}
+
+/*!
+ * \brief Write register.
+ * \details
+ *      Please refer to the RTC datasheet.
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \param value
+ *      8-bit unsigned register value.
+ * \retval true
+ *      Success
+ * \retval false
+ *      Write register failed
+ */
+bool ErriezDS3231::writeRegister(uint8_t reg, uint8_t value)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    // Write buffer with one 8-bit unsigned value
+    return writeBuffer(reg, &value, 1);
+}
+
+/*!
+ * \brief Write buffer to RTC.
+ * \details
+ *      Please refer to the RTC datasheet. A failed write is retried according to
+ *      setRetryPolicy().
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \param buffer
+ *      Buffer.
+ * \param writeLen
+ *      Buffer length. Writing is only allowed within valid RTC registers.
+ * \retval true
+ *      Success
+ * \retval false
+ *      I2C write failed, see getLastError().
+ */
+bool ErriezDS3231::writeBuffer(uint8_t reg, const void *buffer, uint8_t writeLen)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    DS3231Result result;
+    uint8_t attempt = 0;
+    unsigned long start = 0;
+
+#ifdef ARDUINO
+    start = micros();
+#endif
+
+    do {
+        // Write the I2C address, register number and optional buffer
+        result = busResult(busWrite(reg, (const uint8_t *)buffer, writeLen, true));
+    } while (busRetry(result, &attempt, start));
+
+    if (result != ResultOk) {
+        return false;
+    }
+
+    // Date/time registers changed
+    if (writeLen && (reg <= DS3231_REG_YEAR)) {
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+        _softValid = false;
+#endif
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+        timeCacheInvalidate();
+#endif
+    }
+
+    // Keep shadow registers in sync with the RTC
+    shadowUpdate(reg, (const uint8_t *)buffer, writeLen);
+
+    return true;
+}
+
+/*!
+ * \brief Read buffer from RTC.
+ * \details
+ *      A failed or short read is retried according to setRetryPolicy().
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \param buffer
+ *      Buffer.
+ * \param readLen
+ *      Buffer length. Reading is only allowed within valid RTC registers.
+ * \retval true
+ *      Success
+ * \retval false
+ *      I2C read failed, see getLastError().
+ */
+bool ErriezDS3231::readBuffer(uint8_t reg, void *buffer, uint8_t readLen)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    DS3231Result result;
+    uint8_t attempt = 0;
+    unsigned long start = 0;
+
+#ifdef ARDUINO
+    start = micros();
+#endif
+
+    do {
+        // Write the I2C address and register number, followed by a repeated start
+        result = busResult(busWrite(reg, NULL, 0, false));
+        if (result == ResultOk) {
+            result = busRead((uint8_t *)buffer, readLen);
+        }
+    } while (busRetry(result, &attempt, start));
+
+    if (result != ResultOk) {
+        return false;
+    }
+
+    // Keep shadow registers in sync with the RTC
+    shadowUpdate(reg, (const uint8_t *)buffer, readLen);
+
+    return true;
+}
+
+/*!
+ * \brief Read buffer from RTC without setting the register pointer.
+ * \details
+ *      Reads from the current RTC register pointer, which must be set before with
+ *      writeBuffer(reg, NULL, 0). This splits a register read in two shorter I2C transfers which
+ *      can be executed at different moments, see ErriezDS3231Async. The read is not retried,
+ *      because the register pointer is unknown after a failure.
+ * \param reg
+ *      RTC register number 0x00..0x12 at the register pointer.
+ * \param buffer
+ *      Buffer.
+ * \param readLen
+ *      Buffer length. Reading is only allowed within valid RTC registers.
+ * \retval true
+ *      Success
+ * \retval false
+ *      I2C read failed, see getLastError().
+ */
+bool ErriezDS3231::readBufferFromPointer(uint8_t reg, void *buffer, uint8_t readLen)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    // Read buffer
+    _lastError = busRead((uint8_t *)buffer, readLen);
+    if (_lastError != ResultOk) {
+#ifdef ERRIEZ_DS3231_RETRY
+        _busFailures++;
+#endif
+        return false;
+    }
+
+    // Keep shadow registers in sync with the RTC
+    shadowUpdate(reg, (const uint8_t *)buffer, readLen);
+
+    return true;
+}
+
+/*!
+ * \brief Write buffer and read the next registers in one I2C transaction.
+ * \details
+ *      Writes the buffer, followed by a repeated start and a read from the auto-incremented
+ *      register pointer reg + writeLen. The register pointer wraps from 0x12 to 0x00. A failed
+ *      transfer, including the write, is retried according to setRetryPolicy(), so the written
+ *      registers must not change the RTC state when written twice.
+ * \param reg
+ *      RTC register number 0x00..0x12.
+ * \param writeBuf
+ *      Write buffer.
+ * \param writeLen
+ *      Write buffer length 1..DS3231_NUM_REGS.
+ * \param readBuf
+ *      Read buffer.
+ * \param readLen
+ *      Read buffer length 1..DS3231_NUM_REGS.
+ * \retval true
+ *      Success
+ * \retval false
+ *      I2C transfer failed, see getLastError().
+ */
+bool ErriezDS3231::writeReadBuffer(uint8_t reg, const void *writeBuf, uint8_t writeLen,
+                                   void *readBuf, uint8_t readLen)
+{
+    DS3231_STATS_API(StatsApiRegister);
+
+    DS3231Result result;
+    uint8_t attempt = 0;
+    uint8_t readReg;
+    uint8_t len;
+    unsigned long start = 0;
+
+#ifdef ARDUINO
+    start = micros();
+#endif
+
+    do {
+        // Write the I2C address, register number and buffer, followed by a repeated start
+        result = busResult(busWrite(reg, (const uint8_t *)writeBuf, writeLen, false));
+        if (result == ResultOk) {
+            result = busRead((uint8_t *)readBuf, readLen);
+        }
+    } while (busRetry(result, &attempt, start));
+
+    if (result != ResultOk) {
+        return false;
+    }
+
+    // Date/time registers changed
+    if (reg <= DS3231_REG_YEAR) {
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+        _softValid = false;
+#endif
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+        timeCacheInvalidate();
+#endif
+    }
+
+    // Keep shadow registers in sync with the RTC
+    shadowUpdate(reg, (const uint8_t *)writeBuf, writeLen);
+
+    // Read started at the auto-incremented register pointer
+    readReg = (reg + writeLen) % DS3231_NUM_REGS;
+    len = DS3231_NUM_REGS - readReg;
+    if (len > readLen) {
+        len = readLen;
+    }
+    shadowUpdate(readReg, (const uint8_t *)readBuf, len);
+    shadowUpdate(0x00, (const uint8_t *)readBuf + len, readLen - len);
+
+    return true;
+}
+
+/*!
+ * \brief Write to the bus transport.
+ * \details
+ *      Without transport, the global Wire object is called directly without indirection.
+ * \param reg
+ *      RTC register number.
+ * \param buffer
+ *      Buffer, may be NULL when len is 0.
+ * \param len
+ *      Buffer length.
+ * \param stop
+ *      true: Generate stop, false: Keep bus for a repeated start.
+ * \return
+ *      0: Success, otherwise Wire endTransmission() error code.
+ */
+uint8_t ErriezDS3231::busWrite(uint8_t reg, const uint8_t *buffer, uint8_t len, bool stop)
+{
+    uint8_t result;
+#ifdef ERRIEZ_DS3231_STATS
+    unsigned long start = statsMicros();
+#endif
+
+    if (_transport) {
+        result = _transport->writeBurst(DS3231_ADDR, reg, buffer, len, stop);
+    } else {
+#ifdef ARDUINO
+        Wire.beginTransmission(DS3231_ADDR);
+        Wire.write(reg);
+        for (uint8_t i = 0; i < len; i++) {
+            Wire.write(buffer[i]);
+        }
+        result = Wire.endTransmission(stop);
+#else
+        result = DS3231_BUS_ERR_OTHER;
+#endif
+    }
+
+#ifdef ERRIEZ_DS3231_STATS
+    statsWrite(start, len, stop, result);
+#endif
+
+    return result;
+}
+
+/*!
+ * \brief Read from the bus transport at the current register pointer.
+ * \param buffer
+ *      Buffer.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      ResultOk when all bytes are received, otherwise the read error of the bus transport or
+ *      ResultShortRead.
+ */
+DS3231Result ErriezDS3231::busRead(uint8_t *buffer, uint8_t len)
+{
+    uint8_t received;
+#ifdef ERRIEZ_DS3231_STATS
+    unsigned long start = statsMicros();
+#endif
+
+    if (_transport) {
+        received = _transport->readBurst(DS3231_ADDR, buffer, len);
+    } else {
+#ifdef ARDUINO
+        received = Wire.requestFrom((uint8_t)DS3231_ADDR, len);
+        if (received > len) {
+            received = len;
+        }
+        for (uint8_t i = 0; i < received; i++) {
+            buffer[i] = (uint8_t)Wire.read();
+        }
+#else
+        received = 0;
+#endif
+    }
+
+#ifdef ERRIEZ_DS3231_STATS
+    statsRead(start, len, received);
+#endif
+
+    if (received == len) {
+        return ResultOk;
+    }
+
+    // A transport which executes a deferred register write with the read reports its error
+    if (_transport && (_transport->getReadError() != DS3231_BUS_OK)) {
+        return busResult(_transport->getReadError());
+    }
+
+    return ResultShortRead;
+}
+
+/*!
+ * \brief Convert bus transport result code.
+ * \param code
+ *      DS3231_BUS_... code, compatible with Wire endTransmission().
+ * \return
+ *      Transfer result.
+ */
+DS3231Result ErriezDS3231::busResult(uint8_t code)
+{
+    switch (code) {
+        case DS3231_BUS_OK:
+            return ResultOk;
+        case DS3231_BUS_ERR_NACK_ADDR:
+            return ResultNackAddress;
+        case DS3231_BUS_ERR_NACK_DATA:
+            return ResultNackData;
+        case DS3231_BUS_ERR_TIMEOUT:
+            return ResultTimeout;
+        default:
+            return ResultBusError;
+    }
+}
+
+/*!
+ * \brief Handle transfer result and decide to retry.
+ * \details
+ *      Stores the last result, counts failures and clears the bus after a timeout or bus error
+ *      when enabled. A retry is allowed until the number of retries or the deadline is reached.
+ *      Without ERRIEZ_DS3231_RETRY, only the last result is stored.
+ * \param result
+ *      Result of the last attempt.
+ * \param attempt
+ *      Number of retries executed, incremented on retry.
+ * \param start
+ *      Start of the first attempt in us.
+ * \retval true
+ *      Retry transfer.
+ * \retval false
+ *      Transfer succeeded or failed permanently.
+ */
+bool ErriezDS3231::busRetry(DS3231Result result, uint8_t *attempt, unsigned long start)
+{
+    _lastError = result;
+
+    if (result == ResultOk) {
+        return false;
+    }
+
+#ifdef ERRIEZ_DS3231_RETRY
+    _busFailures++;
+
+    // A slave holding SDA low is released by clocking out the remaining bits
+    if (_busClearEnabled && ((result == ResultTimeout) || (result == ResultBusError))) {
+        busClear();
+    }
+
+    if (*attempt >= _retries) {
+        return false;
+    }
+
+#ifdef ARDUINO
+    if (_retryDeadline && ((unsigned long)(micros() - start) >= _retryDeadline)) {
+        return false;
+    }
+#else
+    (void)start;
+#endif
+
+    (*attempt)++;
+    _busRetries++;
+
+    return true;
+#else
+    // Single attempt
+    (void)attempt;
+    (void)start;
+
+    return false;
+#endif
+}
+
+#ifdef ERRIEZ_DS3231_RETRY
+/*!
+ * \brief Clear a stuck bus.
+ * \retval true
+ *      Bus released.
+ * \retval false
+ *      Bus clear not supported, not configured or failed.
+ */
+bool ErriezDS3231::busClear()
+{
+    _busClears++;
+
+    if (_transport) {
+        return _transport->busClear();
+    }
+
+#ifdef ARDUINO
+    if (_sclPin != 0xFF) {
+        return ErriezDS3231WireTransport::busClearWire(Wire, _sdaPin, _sclPin, _busClock);
+    }
+#endif
+
+    return false;
+}
+
+/*!
+ * \brief Configure bus error recovery.
+ * \details
+ *      Failed writes, failed reads and short reads from readBuffer() and writeBuffer() are
+ *      retried immediately. The worst-case duration of a call is bounded by the number of retries
+ *      and the deadline, plus the duration of one transfer including the Wire timeout of the
+ *      platform. The default policy is a single attempt without bus clear.
+ * \param retries
+ *      Maximum number of retries per transfer, 0: No retries.
+ * \param deadlineMicros
+ *      No retry is started after this duration since the first attempt. 0: No deadline.
+ *      Only supported on Arduino with micros().
+ * \param busClear
+ *      Clear the bus after a timeout or bus error by clocking out SCL, see setBusClearPins() or
+ *      ErriezDS3231Transport::busClear().
+ */
+void ErriezDS3231::setRetryPolicy(uint8_t retries, unsigned long deadlineMicros, bool busClear)
+{
+    _retries = retries;
+    _retryDeadline = deadlineMicros;
+    _busClearEnabled = busClear;
+}
+
+#ifdef ARDUINO
+/*!
+ * \brief Configure bus clear of the global Wire object.
+ * \details
+ *      After the bus clear, Wire is initialized again on the same pins with the given clock.
+ * \param sdaPin
+ *      SDA pin.
+ * \param sclPin
+ *      SCL pin.
+ * \param clock
+ *      I2C clock in Hz, restored with Wire.setClock().
+ */
+void ErriezDS3231::setBusClearPins(uint8_t sdaPin, uint8_t sclPin, uint32_t clock)
+{
+    _sdaPin = sdaPin;
+    _sclPin = sclPin;
+    _busClock = clock;
+}
+#endif
+#endif
+
+/*!
+ * \brief Get result of the last bus transfer.
+ * \return
+ *      ResultOk or error.
+ */
+DS3231Result ErriezDS3231::getLastError()
+{
+    return _lastError;
+}
+
+#ifdef ERRIEZ_DS3231_RETRY
+/*!
+ * \brief Get number of failed transfer attempts, including retried attempts.
+ * \return
+ *      Number of failures.
+ */
+uint32_t ErriezDS3231::getBusFailures()
+{
+    return _busFailures;
+}
+
+/*!
+ * \brief Get number of retried transfers.
+ * \return
+ *      Number of retries.
+ */
+uint32_t ErriezDS3231::getBusRetries()
+{
+    return _busRetries;
+}
+
+/*!
+ * \brief Get number of bus clear attempts.
+ * \return
+ *      Number of bus clears.
+ */
+uint32_t ErriezDS3231::getBusClears()
+{
+    return _busClears;
+}
+#endif
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+/*!
+ * \brief Enable SQW disciplined software clock.
+ * \details
+ *      Configures the square wave on the INT/SQW pin. The application must call
+ *      softClockTick() from the SQW falling edge interrupt handler. getEpoch() and getTimestamp()
+ *      then return the time from RAM without I2C transfer. The software clock is synchronized
+ *      with the RTC registers every resyncMinutes, when an SQW edge has been missed, or after
+ *      writing the date/time.
+ *
+ *      With 1Hz, the seconds register increments at the falling edge. With 1024, 4096 or 8192Hz,
+ *      getTimestamp() provides sub-second resolution down to 122us. The phase of the second is
+ *      found by polling the seconds register, which blocks up to 1.1 seconds during
+ *      synchronization. The phase accuracy is the duration of a single register read.
+ *
+ *      The alarm interrupts cannot be used, because the INT/SQW pin generates the square wave.
+ * \param resyncMinutes
+ *      Resync interval in minutes 1..1092.
+ * \param squareWave
+ *      SquareWave1Hz, SquareWave1024Hz, SquareWave4096Hz or SquareWave8192Hz.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid argument, set square wave or synchronization failed.
+ */
+bool ErriezDS3231::softClockEnable(uint16_t resyncMinutes, SquareWave squareWave)
+{
+    DS3231_STATS_API(StatsApiSoftClock);
+
+    if ((resyncMinutes == 0) || (resyncMinutes > 1092)) {
+        return false;
+    }
+
+    switch (squareWave) {
+        case SquareWave1Hz:     _softTicksPerSecond = 1;    break;
+        case SquareWave1024Hz:  _softTicksPerSecond = 1024; break;
+        case SquareWave4096Hz:  _softTicksPerSecond = 4096; break;
+        case SquareWave8192Hz:  _softTicksPerSecond = 8192; break;
+        default:
+            return false;
+    }
+
+    // Stop software clock during reconfiguration
+    _softResyncTicks = 0;
+    _softValid = false;
+    _softSubTicks = 0;
+
+    if (!setSquareWave(squareWave)) {
+        return false;
+    }
+
+    _softResyncTicks = resyncMinutes * 60;
+
+    return softClockSync();
+}
+
+/*!
+ * \brief Disable software clock.
+ * \details
+ *      getEpoch() reads the RTC registers again. The square wave output is not changed.
+ */
+void ErriezDS3231::softClockDisable()
+{
+    _softResyncTicks = 0;
+    _softValid = false;
+}
+
+/*!
+ * \brief Software clock tick.
+ * \details
+ *      Call this function from the interrupt handler of the SQW falling edge.
+ */
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void ErriezDS3231::softClockTick()
+{
+    if (++_softSubTicks >= _softTicksPerSecond) {
+        _softSubTicks = 0;
+        _softEpoch++;
+        _softTicks++;
+#ifdef ARDUINO
+        _softTickMs = millis();
+#endif
+    }
+}
+
+/*!
+ * \brief Synchronize software clock with RTC registers.
+ * \details
+ *      This function is called automatically by getEpoch(). A difference between the software clock
+ *      and the RTC is counted as drift.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Software clock disabled or RTC read failed.
+ */
+bool ErriezDS3231::softClockSync()
+{
+    DS3231_STATS_API(StatsApiSoftClock);
+
+    uint8_t buffer[7];
+    uint16_t ticks;
+    bool synced;
+    time_t t;
+
+    if (!_softResyncTicks) {
+        return false;
+    }
+
+    // Find phase of the second for square wave frequencies above 1Hz
+    if ((_softTicksPerSecond > 1) && !_softValid) {
+        return softClockAlign();
+    }
+
+    for (uint8_t retry = 0; retry < 3; retry++) {
+        // Read tick counter before reading the date/time registers
+        do {
+            ticks = _softTicks;
+        } while (ticks != _softTicks);
+
+        // Read date/time registers
+        if (!readBuffer(0x00, buffer, sizeof(buffer)) || !decodeEpochRegisters(buffer, &t)) {
+            return false;
+        }
+
+        synced = false;
+#ifdef ARDUINO
+        noInterrupts();
+#endif
+        // Retry when an SQW edge occurred during the register read
+        if (ticks == _softTicks) {
+            // Count corrections of a synchronized software clock as drift
+            if (_softValid && (_softEpoch != (uint32_t)t)) {
+                _softDrift += (int32_t)((uint32_t)t - _softEpoch);
+                _softDriftEvents++;
+
+                // Missed edges above 1Hz invalidate the phase of the second
+                if (_softTicksPerSecond > 1) {
+                    _softValid = false;
+                }
+            }
+
+            _softEpoch = (uint32_t)t;
+            _softTicks = 0;
+#ifdef ARDUINO
+            _softTickMs = millis();
+#endif
+            _softValid = true;
+            _softResyncs++;
+            synced = true;
+        }
+#ifdef ARDUINO
+        interrupts();
+#endif
+        if (synced) {
+            return _softValid ? true : softClockAlign();
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Align sub-second ticks with the seconds register.
+ * \details
+ *      Restarts the sub-second tick counter at the start of the second. Blocks up to 1.1
+ *      seconds.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read failed or no seconds increment detected.
+ */
+bool ErriezDS3231::softClockAlign()
+{
+    uint16_t startTicks;
+    time_t t;
+
+    if (!alignSecond(&_softTicks, &_softSubTicks, &startTicks, &t)) {
+        return false;
+    }
+
+#ifdef ARDUINO
+    noInterrupts();
+#endif
+    // Count seconds from the start of the aligned second
+    _softTicks = (uint16_t)(_softTicks - startTicks);
+    _softEpoch = (uint32_t)t + _softTicks;
+#ifdef ARDUINO
+    _softTickMs = millis();
+#endif
+    _softValid = true;
+    _softResyncs++;
+#ifdef ARDUINO
+    interrupts();
+#endif
+
+    return true;
+}
+
+#endif
+
+/*!
+ * \brief Align SQW counters with the start of the second.
+ * \details
+ *      Polls the seconds register until it increments, which blocks up to 1.1 seconds
+ *      (DS3231_ALIGN_TIMEOUT_US). Without Arduino micros(), the timeout is the number of
+ *      register reads which fit in this duration at the bus clock. Then restarts the sub-second
+ *      ticks and reads the date/time registers directly after the seconds increment. Used by the
+ *      software clock and ErriezDS3231Capture.
+ *
+ *      Fails immediately when the oscillator is stopped (OSF) or disabled with
+ *      clockEnable(false) (EOSC). Call clockEnable(true) to clear OSF after power-up.
+ *
+ *      Without sub-second ticks (1Hz square wave), the seconds counter must have counted the SQW
+ *      falling edge at which the seconds register incremented.
+ * \param seconds
+ *      SQW seconds counter, incremented by the SQW interrupt handler.
+ * \param subTicks
+ *      SQW ticks since the start of the second, cleared at the start of the second. NULL for a
+ *      1Hz square wave.
+ * \param startSeconds
+ *      SQW seconds counter at the start of the second.
+ * \param t
+ *      RTC epoch at the start of the second.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read failed, oscillator stopped, timeout or no SQW ticks detected.
+ */
+bool ErriezDS3231::alignSecond(const volatile uint16_t *seconds, volatile uint16_t *subTicks,
+                               uint16_t *startSeconds, time_t *t)
+{
+    uint8_t buffer[7];
+    uint8_t secStart;
+    uint16_t start;
+    uint16_t counter;
+#ifdef ARDUINO
+    unsigned long startMicros;
+#else
+    uint32_t polls = 0;
+    uint32_t maxPolls = (uint32_t)(((uint64_t)_busClock * (DS3231_ALIGN_TIMEOUT_US / 1000UL)) /
+                                   (1000UL * DS3231_ALIGN_POLL_CLOCKS));
+#endif
+
+    // The seconds register does not increment with a stopped oscillator
+    if (!readBuffer(DS3231_REG_CONTROL, buffer, 2) ||
+        (buffer[0] & (1 << DS3231_CTRL_EOSC)) || (buffer[1] & (1 << DS3231_STAT_OSF))) {
+        return false;
+    }
+
+    // Read SQW seconds counter before the seconds register
+    do {
+        start = *seconds;
+    } while (start != *seconds);
+
+    if (!readBuffer(DS3231_REG_SECONDS, &secStart, 1)) {
+        return false;
+    }
+
+#ifdef ARDUINO
+    startMicros = micros();
+#endif
+
+    // Wait for the seconds register to increment
+    do {
+        if (!readBuffer(DS3231_REG_SECONDS, &buffer[0], 1)) {
+            return false;
+        }
+        do {
+            counter = *seconds;
+        } while (counter != *seconds);
+
+        // Timeout after two seconds of SQW ticks
+        if ((uint16_t)(counter - start) > 2) {
+            return false;
+        }
+
+        // Timeout when the seconds register or the SQW ticks do not change
+#ifdef ARDUINO
+        if ((unsigned long)(micros() - startMicros) > DS3231_ALIGN_TIMEOUT_US) {
+            return false;
+        }
+#else
+        if (++polls > maxPolls) {
+            return false;
+        }
+#endif
+    } while (buffer[0] == secStart);
+
+    // Start of the second
+    if (subTicks) {
+#ifdef ARDUINO
+        noInterrupts();
+#endif
+        *subTicks = 0;
+        *startSeconds = *seconds;
+#ifdef ARDUINO
+        interrupts();
+#endif
+    } else {
+        do {
+            *startSeconds = *seconds;
+        } while (*startSeconds != *seconds);
+
+        // With 1Hz, the SQW falling edge must have been counted
+        if (*startSeconds == start) {
+            return false;
+        }
+    }
+
+    // Read date/time registers directly after the seconds increment
+    return readBuffer(0x00, buffer, sizeof(buffer)) && decodeEpochRegisters(buffer, t);
+}
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+/*!
+ * \brief Get high resolution timestamp from the software clock.
+ * \details
+ *      The timestamp contains the epoch and the number of SQW ticks since the start of the second.
+ *      No I2C transfer is needed when the software clock is synchronized.
+ * \param timestamp
+ *      High resolution timestamp.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Software clock disabled or synchronization failed.
+ */
+bool ErriezDS3231::getTimestamp(DS3231Timestamp *timestamp)
+{
+    DS3231_STATS_API(StatsApiSoftClock);
+
+    uint32_t epoch;
+    uint16_t ticks;
+
+    if (!_softResyncTicks || (!softClockValid() && !softClockSync())) {
+        return false;
+    }
+
+    // Read epoch and ticks again when changed by the interrupt handler
+    do {
+        epoch = _softEpoch;
+        ticks = _softSubTicks;
+    } while ((epoch != _softEpoch) || (ticks != _softSubTicks));
+
+    timestamp->epoch = epoch;
+    timestamp->ticks = ticks;
+    timestamp->ticksPerSecond = _softTicksPerSecond;
+
+    return true;
+}
+#endif
+
+/*!
+ * \brief Convert timestamp ticks to microseconds.
+ * \param timestamp
+ *      High resolution timestamp.
+ * \return
+ *      Microseconds since the start of the second 0..999999.
+ */
+uint32_t ErriezDS3231::timestampMicros(const DS3231Timestamp *timestamp)
+{
+    // 1000000 / 64 = 15625 keeps the multiplication within 32 bits for 8192Hz
+    if (timestamp->ticksPerSecond < 64) {
+        return timestamp->ticks * (1000000UL / timestamp->ticksPerSecond);
+    }
+
+    return (timestamp->ticks * 15625UL) / (timestamp->ticksPerSecond >> 6);
+}
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+/*!
+ * \brief Get number of software clock synchronizations.
+ * \return
+ *      Number of resyncs with the RTC registers.
+ */
+uint32_t ErriezDS3231::getSoftClockResyncs()
+{
+    return _softResyncs;
+}
+
+/*!
+ * \brief Get number of detected software clock drift events.
+ * \return
+ *      Number of resyncs which corrected the software clock.
+ */
+uint16_t ErriezDS3231::getSoftClockDriftEvents()
+{
+    return _softDriftEvents;
+}
+
+/*!
+ * \brief Get accumulated software clock drift.
+ * \return
+ *      Sum of all corrections in seconds. A positive value means that SQW edges have been missed.
+ */
+int32_t ErriezDS3231::getSoftClockDrift()
+{
+    return _softDrift;
+}
+
+/*!
+ * \brief Check if software clock can be used without resync.
+ * \retval true
+ *      Software clock is synchronized.
+ * \retval false
+ *      Resync required: interval elapsed or missing SQW edge.
+ */
+bool ErriezDS3231::softClockValid()
+{
+    uint16_t ticks;
+
+    if (!_softValid) {
+        return false;
+    }
+
+    do {
+        ticks = _softTicks;
+    } while (ticks != _softTicks);
+
+    if (ticks >= _softResyncTicks) {
+        return false;
+    }
+
+#ifdef ARDUINO
+    // Missing SQW edge
+    unsigned long tickMs;
+    do {
+        tickMs = _softTickMs;
+    } while (tickMs != _softTickMs);
+
+    if ((millis() - tickMs) > 1500) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+/*!
+ * \brief Read software clock epoch without disabling interrupts.
+ * \return
+ *      Software clock epoch.
+ */
+uint32_t ErriezDS3231::softClockEpoch()
+{
+    uint32_t epoch;
+
+    // Read again when the multi-byte value was changed by the interrupt handler
+    do {
+        epoch = _softEpoch;
+    } while (epoch != _softEpoch);
+
+    return epoch;
+}
+#endif
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+/*!
+ * \brief Enable or disable the shadow register cache.
+ * \details
+ *      The shadow cache keeps a copy of the alarm, control, status and aging offset registers
+ *      (0x07..0x10). Configuration functions use the copy instead of reading the register before
+ *      writing it, and writes which do not change the register are dropped. Bits which are
+ *      changed by the RTC itself (CONV, OSF, BSY, A1F and A2F) are never cached.
+ *
+ *      Enabling the cache reads all cached registers in a single I2C transaction. The cache is
+ *      disabled by default and should only be enabled when no other I2C master changes the RTC
+ *      configuration.
+ * \param enable
+ *      true: Enable shadow register cache.\n
+ *      false: Disable and invalidate shadow register cache.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Reading the registers failed, the cache will be filled at the next register access.
+ */
+bool ErriezDS3231::shadowCacheEnable(bool enable)
+{
+    uint8_t buffer[DS3231_SHADOW_NUM];
+
+    _shadowValid = 0;
+    _shadowEnabled = enable;
+
+    if (!enable) {
+        return true;
+    }
+
+    // Fill shadow registers with one burst read
+    return readBuffer(DS3231_SHADOW_FIRST, buffer, sizeof(buffer));
+}
+
+/*!
+ * \brief Invalidate shadow register cache.
+ * \details
+ *      Call this function when the RTC registers may have been changed outside this library, for
+ *      example by another I2C master or after an RTC power cycle.
+ */
+void ErriezDS3231::shadowCacheInvalidate()
+{
+    _shadowValid = 0;
+}
+
+/*!
+ * \brief Get number of I2C transactions avoided by the shadow register cache.
+ * \return
+ *      Number of skipped register reads and dropped register writes.
+ */
+uint32_t ErriezDS3231::getShadowSavedTransactions()
+{
+    return _shadowSaved;
+}
+#endif
+
+/*!
+ * \brief Read-modify-write a control or status register.
+ * \details
+ *      The register read is skipped when the register is available in the shadow cache. The write
+ *      is dropped when no bit changes. Status flags which are not modified are written with a
+ *      logic 1 which leaves these flags unchanged.
+ * \param reg
+ *      RTC register DS3231_REG_CONTROL or DS3231_REG_STATUS.
+ * \param mask
+ *      Bits to modify.
+ * \param value
+ *      New value of the bits in mask.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Register read or write failed, see getLastError().
+ */
+bool ErriezDS3231::updateRegister(uint8_t reg, uint8_t mask, uint8_t value)
+{
+    uint8_t regVal;
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    uint8_t volatileBits = (reg == DS3231_REG_STATUS) ? DS3231_STAT_VOLATILE : DS3231_CTRL_VOLATILE;
+    uint8_t keepBits = (reg == DS3231_REG_STATUS) ? DS3231_STAT_KEEP : 0;
+
+    if (_shadowValid & (1 << (reg - DS3231_SHADOW_FIRST))) {
+        // Use shadow register instead of reading the register
+        regVal = _shadow[reg - DS3231_SHADOW_FIRST];
+        _shadowSaved++;
+
+        // Drop the write when no bit changes
+        if (!(mask & volatileBits) && (((regVal & ~mask) | (value & mask)) == regVal)) {
+            _shadowSaved++;
+            return true;
+        }
+
+        // Do not clear flags which are not modified
+        regVal |= (keepBits & ~mask);
+    } else if (!readRegister(reg, &regVal)) {
+        return false;
+    }
+#else
+    if (!readRegister(reg, &regVal)) {
+        return false;
+    }
+#endif
+
+    // Modify register
+    regVal = (regVal & ~mask) | (value & mask);
+
+    // Write register
+    return writeRegister(reg, regVal);
+}
+
+/*!
+ * \brief Write alarm or aging offset registers.
+ * \details
+ *      The write is dropped when all registers are cached with the same value.
+ * \param reg
+ *      First RTC register within the shadow register range.
+ * \param buffer
+ *      Buffer.
+ * \param len
+ *      Buffer length.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C write failed.
+ */
+bool ErriezDS3231::writeCached(uint8_t reg, const uint8_t *buffer, uint8_t len)
+{
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t idx = reg + i - DS3231_SHADOW_FIRST;
+
+        if (!(_shadowValid & (1 << idx)) || (_shadow[idx] != buffer[i])) {
+            // Register changed
+            return writeBuffer(reg, buffer, len);
+        }
+    }
+
+    // All registers unchanged
+    _shadowSaved++;
+
+    return true;
+#else
+    return writeBuffer(reg, buffer, len);
+#endif
+}
+
+/*!
+ * \brief Update shadow registers after a register read or write.
+ * \param reg
+ *      First RTC register.
+ * \param buffer
+ *      Register values.
+ * \param len
+ *      Number of registers.
+ */
+void ErriezDS3231::shadowUpdate(uint8_t reg, const uint8_t *buffer, uint8_t len)
+{
+#ifndef ERRIEZ_DS3231_SHADOW_CACHE
+    (void)reg;
+    (void)buffer;
+    (void)len;
+#else
+    if (!_shadowEnabled) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < len; i++, reg++) {
+        if ((reg < DS3231_SHADOW_FIRST) || (reg > DS3231_SHADOW_LAST)) {
+            continue;
+        }
+
+        // Volatile bits are never cached
+        if (reg == DS3231_REG_CONTROL) {
+            _shadow[reg - DS3231_SHADOW_FIRST] = buffer[i] & ~DS3231_CTRL_VOLATILE;
+        } else if (reg == DS3231_REG_STATUS) {
+            _shadow[reg - DS3231_SHADOW_FIRST] = buffer[i] & ~DS3231_STAT_VOLATILE;
+        } else {
+            _shadow[reg - DS3231_SHADOW_FIRST] = buffer[i];
+        }
+        _shadowValid |= (1 << (reg - DS3231_SHADOW_FIRST));
+    }
+#endif
+}
+
+#ifdef ERRIEZ_DS3231_STATS
+/*!
+ * \brief Get I2C instrumentation counters.
+ * \details
+ *      Only available when ERRIEZ_DS3231_STATS is defined.
+ * \param stats
+ *      Copy of the counters.
+ */
+void ErriezDS3231::getStats(DS3231Stats *stats)
+{
+    memcpy(stats, &_stats, sizeof(DS3231Stats));
+}
+
+/*!
+ * \brief Reset I2C instrumentation counters.
+ */
+void ErriezDS3231::resetStats()
+{
+    memset(&_stats, 0, sizeof(_stats));
+    _statsApi = StatsApiOther;
+    _statsPending = false;
+    _statsStart = 0;
+}
+
+/*!
+ * \brief Set clock for the latency histogram.
+ * \param clockMicros
+ *      Microsecond clock, for example a simulator clock on a host. NULL: Arduino micros().
+ */
+void ErriezDS3231::setStatsClock(unsigned long (*clockMicros)(void))
+{
+    _statsClock = clockMicros;
+}
+
+/*!
+ * \brief Get time for the latency histogram.
+ * \return
+ *      Microseconds, or 0 without clock.
+ */
+unsigned long ErriezDS3231::statsMicros()
+{
+    if (_statsClock) {
+        return _statsClock();
+    }
+#ifdef ARDUINO
+    return micros();
+#else
+    return 0;
+#endif
+}
+
+/*!
+ * \brief Count transaction on the current API and add its duration to the histogram.
+ * \param start
+ *      Start of the transaction in us.
+ */
+void ErriezDS3231::statsLatency(unsigned long start)
+{
+    unsigned long duration = statsMicros() - start;
+    unsigned long limit = DS3231_STATS_BUCKET_US;
+    uint8_t bucket = 0;
+
+    while ((bucket < (DS3231_STATS_BUCKETS - 1)) && (duration >= limit)) {
+        limit <<= 1;
+        bucket++;
+    }
+
+    _stats.transactions[_statsApi]++;
+    _stats.latency[bucket]++;
+}
+
+/*!
+ * \brief Update counters after a bus write.
+ * \param start
+ *      Start of the write in us.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      Write ended with a stop.
+ * \param result
+ *      Bus write result.
+ */
+void ErriezDS3231::statsWrite(unsigned long start, uint8_t len, bool stop, uint8_t result)
+{
+    _statsPending = false;
+
+    if (result != DS3231_BUS_OK) {
+        _stats.nackErrors++;
+        statsLatency(start);
+        return;
+    }
+
+    _stats.bytesWritten += 1 + len;
+
+    if (stop) {
+        statsLatency(start);
+    } else {
+        // Transaction ends after the repeated start read
+        _statsPending = true;
+        _statsStart = start;
+    }
+}
+
+/*!
+ * \brief Update counters after a bus read.
+ * \param start
+ *      Start of the read in us.
+ * \param len
+ *      Number of requested bytes.
+ * \param received
+ *      Number of received bytes.
+ */
+void ErriezDS3231::statsRead(unsigned long start, uint8_t len, uint8_t received)
+{
+    if (_statsPending) {
+        start = _statsStart;
+        _statsPending = false;
+    }
+
+    _stats.bytesRead += received;
+    if (received < len) {
+        _stats.shortReads++;
+    }
+
+    statsLatency(start);
+}
+#endif
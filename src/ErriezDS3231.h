@@ -33,9 +33,22 @@
 #ifndef ERRIEZ_DS3231_H_
 #define ERRIEZ_DS3231_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
 
+#include "ErriezDS3231Transport.h"
+
+// Uncomment or define in the build flags to enable I2C transaction instrumentation
+// #define ERRIEZ_DS3231_STATS
+
+// Uncomment or define in the build flags to enable optional features. Each feature adds RAM to
+// every ErriezDS3231 object, in bytes on AVR:
+// #define ERRIEZ_DS3231_SOFT_CLOCK     // SQW disciplined software clock: 27
+// #define ERRIEZ_DS3231_TIME_CACHE     // Lazy time cache of readCached(): 17
+// #define ERRIEZ_DS3231_SHADOW_CACHE   // Shadow register cache: 17
+// #define ERRIEZ_DS3231_RETRY          // Bus retry, bus clear and failure counters: 24
+
 //! DS3231 registers
 #define DS3231_REG_SECONDS      0x00    //!< Seconds register
 #define DS3231_REG_MINUTES      0x01    //!< Minutes register
@@ -92,11 +105,57 @@
 #define DS3231_A2M4             7       //!< Alarm 2 bit 7 day/date register
 #define DS3231_DYDT             6       //!< Alarm 2 bit 6
 
+//! Control register bits which are changed by the RTC
+#define DS3231_CTRL_VOLATILE    (1 << DS3231_CTRL_CONV)
+//! Status register bits which are changed by the RTC
+#define DS3231_STAT_VOLATILE    ((1 << DS3231_STAT_OSF) | (1 << DS3231_STAT_BSY) | \
+                                 (1 << DS3231_STAT_A2F) | (1 << DS3231_STAT_A1F))
+//! Status flags which are left unchanged when written with a logic 1
+#define DS3231_STAT_KEEP        ((1 << DS3231_STAT_OSF) | (1 << DS3231_STAT_A2F) | \
+                                 (1 << DS3231_STAT_A1F))
+
+//! Number of date and time registers 0x00..0x06
+#define DS3231_TIME_IMAGE_SIZE  7
+
+/*!
+ * \brief Word size in bits of the packed BCD time image codec
+ * \details
+ *      0 converts one register at a time, which is the fastest on 8-bit AVR targets.
+ */
+#ifndef DS3231_BCD_SWAR_BITS
+#if defined(__AVR__)
+#define DS3231_BCD_SWAR_BITS    0
+#elif (UINTPTR_MAX > 0xFFFFFFFFUL)
+#define DS3231_BCD_SWAR_BITS    64
+#else
+#define DS3231_BCD_SWAR_BITS    32
+#endif
+#endif
+
+//! Shadow register cache range: alarm, control, status and aging offset registers
+#define DS3231_SHADOW_FIRST     DS3231_REG_ALARM1_SEC   //!< First cached register
+#define DS3231_SHADOW_LAST      DS3231_REG_AGING_OFFSET //!< Last cached register
+#define DS3231_SHADOW_NUM       (DS3231_SHADOW_LAST - DS3231_SHADOW_FIRST + 1) //!< 10 registers
+
 //! DS3231 I2C 7-bit address
 #define DS3231_ADDR             (0xD0 >> 1)
 
+//! Default TCA9548A I2C mux 7-bit address, A0..A2 low
+#define DS3231_MUX_ADDR         0x70
+//! Number of TCA9548A I2C mux channels
+#define DS3231_MUX_CHANNELS     8
+
+//! Maximum duration of the seconds register polling by alignSecond() in us
+#define DS3231_ALIGN_TIMEOUT_US 1100000UL
+//! I2C clocks of a single register read: two addresses, register number and data
+#define DS3231_ALIGN_POLL_CLOCKS 36
+
 //! Number of seconds between year 1970 and 2000
 #define SECONDS_FROM_1970_TO_2000 946684800
+//! Number of days between year 1970 and 2000
+#define DAYS_FROM_1970_TO_2000  10957
+//! Number of seconds between year 1970 and 2100
+#define SECONDS_FROM_1970_TO_2100 4102444800UL
 
 /*!
  * \brief Alarm ID
@@ -142,6 +201,109 @@ typedef enum {
     SquareWave8192Hz = ((1 << DS3231_CTRL_RS2) | (1 << DS3231_CTRL_RS1)),   //!< SQW 8192Hz
 } SquareWave;
 
+/*!
+ * \brief Bus transfer result
+ */
+typedef enum {
+    ResultOk = 0,               //!< Success
+    ResultNackAddress = 1,      //!< RTC address not acknowledged
+    ResultNackData = 2,         //!< Register or data not acknowledged
+    ResultShortRead = 3,        //!< Less bytes received than requested
+    ResultTimeout = 4,          //!< Bus timeout, for example SDA held low
+    ResultBusError = 5,         //!< Other bus error
+} DS3231Result;
+
+/*!
+ * \brief Snapshot of all RTC registers 0x00..0x12
+ * \details
+ *      Read with ErriezDS3231::readSnapshot() in a single I2C transaction and decode with the
+ *      static ErriezDS3231::decode...() functions without further bus access.
+ */
+typedef struct {
+    uint8_t regs[DS3231_NUM_REGS];  //!< Register values, index is the register number
+} DS3231Snapshot;
+
+/*!
+ * \brief High resolution timestamp from the SQW disciplined software clock
+ */
+typedef struct {
+    uint32_t epoch;             //!< Unix epoch seconds since 1970
+    uint16_t ticks;             //!< SQW ticks since the start of the second
+    uint16_t ticksPerSecond;    //!< SQW frequency: 1, 1024, 4096 or 8192
+} DS3231Timestamp;
+
+/*!
+ * \brief Packed date and time, 6 bytes
+ * \details
+ *      The fields are stored in register order 0x00..0x06, with the hours and day of the week in
+ *      one byte, so it is decoded directly from the register image. The byte-sized bit-fields
+ *      result in the same size and 1-byte alignment on all targets. Supports comparison and
+ *      subtraction (seconds).
+ */
+typedef struct {
+    uint8_t sec : 6;    //!< Seconds 0..59
+    uint8_t : 2;
+    uint8_t min : 6;    //!< Minutes 0..59
+    uint8_t : 2;
+    uint8_t hour : 5;   //!< Hours 0..23
+    uint8_t wday : 3;   //!< Day of the week 0..6 (0=Sunday)
+    uint8_t mday : 5;   //!< Day of the month 1..31
+    uint8_t : 3;
+    uint8_t mon : 4;    //!< Month 1..12 (1=January)
+    uint8_t : 4;
+    uint8_t year : 7;   //!< Year 0..99 (2000..2099)
+    uint8_t : 1;
+} DS3231DateTime;
+
+//! Lifetime of the cached second in ms, with margin for the local clock tolerance
+#define DS3231_TIME_CACHE_MS    990
+
+//! Number of I2C latency histogram buckets
+#define DS3231_STATS_BUCKETS    8
+
+//! Upper limit of the first latency histogram bucket in us, doubles for each next bucket
+#define DS3231_STATS_BUCKET_US  64
+
+/*!
+ * \brief Public API groups for I2C instrumentation
+ */
+typedef enum {
+    StatsApiOther = 0,          //!< Not called from a public API, such as shadowCacheEnable()
+    StatsApiBegin,              //!< begin()
+    StatsApiOscillator,         //!< isRunning(), clockEnable()
+    StatsApiGetEpoch,           //!< getEpoch()
+    StatsApiSetEpoch,           //!< setEpoch(), setEpochAligned()
+    StatsApiRead,               //!< read()
+    StatsApiWrite,              //!< write()
+    StatsApiGetTime,            //!< getTime(), getDateTime()
+    StatsApiSetTime,            //!< setTime(), setDateTime()
+    StatsApiAlarm,              //!< setAlarm1(), setAlarm2(), alarmInterruptEnable()
+    StatsApiAlarmFlag,          //!< getAlarmFlag(), clearAlarmFlag()
+    StatsApiOutput,             //!< setSquareWave(), outputClockPinEnable()
+    StatsApiAgingOffset,        //!< setAgingOffset(), getAgingOffset()
+    StatsApiTemperature,        //!< startTemperatureConversion(), getTemperature()
+    StatsApiSnapshot,           //!< readSnapshot()
+    StatsApiSoftClock,          //!< softClockEnable(), softClockSync(), getTimestamp()
+    StatsApiRegister,           //!< readRegister(), writeRegister(), read/write buffer functions
+    StatsApiNum                 //!< Number of API groups
+} DS3231StatsApi;
+
+/*!
+ * \brief I2C instrumentation counters
+ * \details
+ *      Only available when ERRIEZ_DS3231_STATS is defined. A register pointer write followed by a
+ *      repeated start read counts as one transaction. Nested API calls are counted on the
+ *      outermost API.
+ */
+typedef struct {
+    uint32_t transactions[StatsApiNum];         //!< Transactions per API group
+    uint32_t bytesWritten;                      //!< Bytes written, including register pointer
+    uint32_t bytesRead;                         //!< Bytes read
+    uint16_t nackErrors;                        //!< Failed writes (NACK, timeout)
+    uint16_t shortReads;                        //!< Reads with less bytes than requested
+    uint32_t latency[DS3231_STATS_BUCKETS];     //!< Transaction duration histogram
+} DS3231Stats;
+
 
 /*!
  * \brief DS3231 RTC class
@@ -149,6 +311,10 @@ typedef enum {
 class ErriezDS3231
 {
 public:
+    // Constructor
+    ErriezDS3231();
+    explicit ErriezDS3231(ErriezDS3231Transport *transport);
+
     // Initialize
     bool begin();
 
@@ -159,8 +325,18 @@ public:
     // Set/get date/time
     time_t getEpoch();
     bool setEpoch(time_t t);
+    bool setEpochAligned(time_t t, unsigned long subsecondMicros,
+                         unsigned long (*clockMicros)(void),
+                         unsigned long *writeLatencyMicros=NULL);
     bool read(struct tm *dt);
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+    bool readCached(struct tm *dt);
+    bool readCached(struct tm *dt, unsigned long nowMillis);
+    void timeCacheInvalidate();
+#endif
     bool write(const struct tm *dt);
+    bool read(DS3231DateTime *dt);
+    bool write(const DS3231DateTime *dt);
     bool setTime(uint8_t hour, uint8_t min, uint8_t sec);
     bool getTime(uint8_t *hour, uint8_t *min, uint8_t *sec);
     bool setDateTime(uint8_t hour, uint8_t min, uint8_t sec,
@@ -177,6 +353,10 @@ public:
     bool alarmInterruptEnable(AlarmId alarmId, bool enable);
     bool getAlarmFlag(AlarmId alarmId);
     bool clearAlarmFlag(AlarmId alarmId);
+    static void encodeAlarm1Registers(Alarm1Type alarmType, uint8_t dayDate, uint8_t hours,
+                                      uint8_t minutes, uint8_t seconds, uint8_t *buffer);
+    static void encodeAlarm2Registers(Alarm2Type alarmType, uint8_t dayDate, uint8_t hours,
+                                      uint8_t minutes, uint8_t *buffer);
 
     // Output signal control
     bool setSquareWave(SquareWave squareWave);
@@ -190,17 +370,368 @@ public:
     bool startTemperatureConversion();
     bool getTemperature(int8_t *temperature, uint8_t *fraction);
 
+    // Register snapshot
+    bool readSnapshot(DS3231Snapshot *snapshot);
+    static bool decodeTime(const DS3231Snapshot *snapshot, struct tm *dt);
+    static void decodeAlarm1(const DS3231Snapshot *snapshot, Alarm1Type *alarmType,
+                             uint8_t *dayDate, uint8_t *hours, uint8_t *minutes, uint8_t *seconds);
+    static void decodeAlarm2(const DS3231Snapshot *snapshot, Alarm2Type *alarmType,
+                             uint8_t *dayDate, uint8_t *hours, uint8_t *minutes);
+    static bool decodeAlarmFlag(const DS3231Snapshot *snapshot, AlarmId alarmId);
+    static bool decodeAlarmInterruptEnable(const DS3231Snapshot *snapshot, AlarmId alarmId);
+    static bool decodeRunning(const DS3231Snapshot *snapshot);
+    static SquareWave decodeSquareWave(const DS3231Snapshot *snapshot);
+    static bool decodeOutputClockPin(const DS3231Snapshot *snapshot);
+    static bool decodeTemperatureBusy(const DS3231Snapshot *snapshot);
+    static int8_t decodeAgingOffset(const DS3231Snapshot *snapshot);
+    static void decodeTemperature(const DS3231Snapshot *snapshot,
+                                  int8_t *temperature, uint8_t *fraction);
+    static bool decodeEpoch(const DS3231Snapshot *snapshot, time_t *t);
+
+    // Calendar conversions for years 2000..2099
+    /*!
+     * \brief Number of days in the year before the first day of the month.
+     * \param mon
+     *      Month 1..12 (1=January).
+     * \return
+     *      Days 0..334, not including a leap day.
+     */
+    static constexpr uint16_t daysBeforeMonth(uint8_t mon)
+    {
+        return (mon > 2) ? (uint16_t)((153U * (mon - 3) + 2) / 5 + 59) :
+                           (uint16_t)((mon - 1) * 31U);
+    }
+
+    /*!
+     * \brief Convert date to number of days since 1 January 1970.
+     * \param year
+     *      Year 2000..2099.
+     * \param mon
+     *      Month 1..12 (1=January).
+     * \param mday
+     *      Day of the month 1..31.
+     * \return
+     *      Days since 1970, fits in 16 bits for years up to 2099.
+     */
+    static constexpr uint16_t daysFromCivil(uint16_t year, uint8_t mon, uint8_t mday)
+    {
+        return (uint16_t)(DAYS_FROM_1970_TO_2000 + 365U * (year - 2000U) + (year - 2000U + 3) / 4 +
+                          daysBeforeMonth(mon) + (((mon > 2) && !(year & 3)) ? 1 : 0) + mday - 1);
+    }
+
+    /*!
+     * \brief Day of the week from number of days since 1 January 1970.
+     * \param days
+     *      Days since 1970.
+     * \return
+     *      Day of the week 0..6 (0=Sunday).
+     */
+    static constexpr uint8_t weekdayFromDays(uint16_t days)
+    {
+        return (uint8_t)((days + 4U) % 7U); // 1 January 1970 was a Thursday
+    }
+
+    /*!
+     * \brief Convert date and time to Unix epoch.
+     * \param year
+     *      Year 2000..2099.
+     * \param mon
+     *      Month 1..12 (1=January).
+     * \param mday
+     *      Day of the month 1..31.
+     * \param hour
+     *      Hours 0..23.
+     * \param min
+     *      Minutes 0..59.
+     * \param sec
+     *      Seconds 0..59.
+     * \return
+     *      Seconds since 1970 UTC.
+     */
+    static constexpr uint32_t epochFromCivil(uint16_t year, uint8_t mon, uint8_t mday,
+                                             uint8_t hour, uint8_t min, uint8_t sec)
+    {
+        return daysFromCivil(year, mon, mday) * 86400UL + hour * 3600UL + min * 60U + sec;
+    }
+
+    static void civilFromDays(uint16_t days, uint16_t *year, uint8_t *mon, uint8_t *mday);
+    static bool decodeEpochRegisters(const uint8_t *buffer, time_t *t);
+    static bool encodeEpochRegisters(time_t t, uint8_t *buffer);
+
     // BCD conversions
-    uint8_t bcdToDec(uint8_t bcd);
-    uint8_t decToBcd(uint8_t dec);
+    /*!
+     * \brief BCD to decimal conversion.
+     * \param bcd
+     *      BCD encoded value.
+     * \return
+     *      Decimal value.
+     */
+    static constexpr uint8_t bcdToDec(uint8_t bcd)
+    {
+        return (uint8_t)(10 * ((bcd & 0xF0) >> 4) + (bcd & 0x0F));
+    }
+
+    /*!
+     * \brief Decimal to BCD conversion.
+     * \param dec
+     *      Decimal value.
+     * \return
+     *      BCD encoded value.
+     */
+    static constexpr uint8_t decToBcd(uint8_t dec)
+    {
+        return (uint8_t)(((dec / 10) << 4) | (dec % 10));
+    }
+
+    static void decodeTimeImage(const uint8_t *buffer, uint8_t *fields);
+    static void encodeTimeImage(const uint8_t *fields, uint8_t *buffer);
+    static void decodeTimeImages(const uint8_t *records, uint8_t *fields, size_t count);
+
+    // Packed date and time
+    static bool decodeDateTime(const uint8_t *buffer, DS3231DateTime *dt);
+    static void encodeDateTime(const DS3231DateTime *dt, uint8_t *buffer);
+    static uint32_t dateTimeToEpoch(const DS3231DateTime *dt);
+    static int8_t compareDateTime(const DS3231DateTime *a, const DS3231DateTime *b);
 
     // Read/write register
     uint8_t readRegister(uint8_t reg);
+    bool readRegister(uint8_t reg, uint8_t *value);
     bool writeRegister(uint8_t reg, uint8_t value);
 
     // Read/write buffer
     bool readBuffer(uint8_t reg, void *buffer, uint8_t len);
-    bool writeBuffer(uint8_t reg, void *buffer, uint8_t len);
+    bool writeBuffer(uint8_t reg, const void *buffer, uint8_t len);
+    bool readBufferFromPointer(uint8_t reg, void *buffer, uint8_t len);
+    bool writeReadBuffer(uint8_t reg, const void *writeBuf, uint8_t writeLen,
+                         void *readBuf, uint8_t readLen);
+
+    // SQW second alignment
+    bool alignSecond(const volatile uint16_t *seconds, volatile uint16_t *subTicks,
+                     uint16_t *startSeconds, time_t *t);
+    static uint32_t timestampMicros(const DS3231Timestamp *timestamp);
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    // SQW disciplined software clock
+    bool softClockEnable(uint16_t resyncMinutes=60, SquareWave squareWave=SquareWave1Hz);
+    void softClockDisable();
+    void softClockTick();
+    bool softClockSync();
+    bool getTimestamp(DS3231Timestamp *timestamp);
+    uint32_t getSoftClockResyncs();
+    uint16_t getSoftClockDriftEvents();
+    int32_t getSoftClockDrift();
+#endif
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    // Shadow register cache
+    bool shadowCacheEnable(bool enable=true);
+    void shadowCacheInvalidate();
+    uint32_t getShadowSavedTransactions();
+#endif
+
+    // Bus errors
+    DS3231Result getLastError();
+#ifdef ERRIEZ_DS3231_RETRY
+    void setRetryPolicy(uint8_t retries, unsigned long deadlineMicros=0, bool busClear=false);
+#ifdef ARDUINO
+    void setBusClearPins(uint8_t sdaPin, uint8_t sclPin, uint32_t clock=100000);
+#endif
+    uint32_t getBusFailures();
+    uint32_t getBusRetries();
+    uint32_t getBusClears();
+#endif
+
+#ifdef ERRIEZ_DS3231_STATS
+    // I2C instrumentation
+    void getStats(DS3231Stats *stats);
+    void resetStats();
+    void setStatsClock(unsigned long (*clockMicros)(void));
+#endif
+
+private:
+    ErriezDS3231Transport *_transport;  //!< Bus transport, NULL: Arduino Wire
+
+    unsigned long _setLatency;          //!< Last measured date/time write duration in us
+    DS3231Result _lastError;            //!< Result of the last transfer
+
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    volatile uint32_t _softEpoch;       //!< Software clock epoch, incremented by softClockTick()
+    volatile uint16_t _softTicks;       //!< Software clock seconds since last resync
+    volatile uint16_t _softSubTicks;    //!< SQW edges since the start of the second
+    volatile unsigned long _softTickMs; //!< millis() at last second increment
+    uint16_t _softTicksPerSecond;       //!< SQW frequency
+    uint16_t _softResyncTicks;          //!< Resync interval in seconds, 0: software clock off
+    bool _softValid;                    //!< Software clock synchronized with RTC
+    uint32_t _softResyncs;              //!< Number of software clock resyncs
+    uint16_t _softDriftEvents;          //!< Number of resyncs which corrected the software clock
+    int32_t _softDrift;                 //!< Accumulated software clock correction in seconds
+#endif
+
+#ifdef ERRIEZ_DS3231_SHADOW_CACHE
+    bool _shadowEnabled;                //!< Shadow register cache enabled
+    uint16_t _shadowValid;              //!< Bit n set: shadow register n contains a valid value
+    uint8_t _shadow[DS3231_SHADOW_NUM]; //!< Non-volatile bits of registers 0x07..0x10
+    uint32_t _shadowSaved;              //!< Number of I2C transactions avoided by the cache
+#endif
+
+#ifdef ERRIEZ_DS3231_RETRY
+    uint8_t _retries;                   //!< Maximum number of retries per transfer
+    bool _busClearEnabled;              //!< Clear bus after timeout or bus error
+    unsigned long _retryDeadline;       //!< Maximum duration of a transfer with retries in us
+    uint8_t _sdaPin;                    //!< Bus clear SDA pin
+    uint8_t _sclPin;                    //!< Bus clear SCL pin, 0xFF: Not configured
+    uint32_t _busFailures;              //!< Number of failed transfer attempts
+    uint32_t _busRetries;               //!< Number of retries
+    uint32_t _busClears;                //!< Number of bus clear attempts
+#endif
+#if defined(ERRIEZ_DS3231_RETRY) || !defined(ARDUINO)
+    uint32_t _busClock;                 //!< Bus clock of bus clear and alignSecond()
+#endif
+
+#ifdef ERRIEZ_DS3231_TIME_CACHE
+    uint8_t _timeCache[7];              //!< Cached date/time registers 0x00..0x06
+    bool _timeCacheValid;               //!< Time cache contains valid registers
+    bool _timeCacheSynced;              //!< Start of the cached second is known
+    unsigned long _timeCacheSecondMs;   //!< Local time before the start of the cached second
+    unsigned long _timeCacheReadMs;     //!< Local time of the last register read
+#endif
+
+#ifdef ERRIEZ_DS3231_STATS
+    DS3231Stats _stats;                 //!< I2C instrumentation counters
+    uint8_t _statsApi;                  //!< Current API group
+    bool _statsPending;                 //!< Register pointer written, repeated start read follows
+    unsigned long _statsStart;          //!< Start of pending transaction in us
+    unsigned long (*_statsClock)(void); //!< Microsecond clock, NULL: micros()
+#endif
+
+    static bool decodeTimeRegisters(const uint8_t *buffer, struct tm *dt);
+    static int8_t decodeAgingRegister(uint8_t regVal);
+    static void decodeTemperatureRegisters(const uint8_t *buffer,
+                                           int8_t *temperature, uint8_t *fraction);
+
+    uint8_t busWrite(uint8_t reg, const uint8_t *buffer, uint8_t len, bool stop);
+    DS3231Result busRead(uint8_t *buffer, uint8_t len);
+    static DS3231Result busResult(uint8_t code);
+    bool busRetry(DS3231Result result, uint8_t *attempt, unsigned long start);
+#ifdef ERRIEZ_DS3231_RETRY
+    bool busClear();
+#endif
+
+    bool writeTimeRegisters(uint8_t *buffer);
+#ifdef ERRIEZ_DS3231_SOFT_CLOCK
+    bool softClockValid();
+    bool softClockAlign();
+    uint32_t softClockEpoch();
+#endif
+    bool updateRegister(uint8_t reg, uint8_t mask, uint8_t value);
+    bool writeCached(uint8_t reg, const uint8_t *buffer, uint8_t len);
+    void shadowUpdate(uint8_t reg, const uint8_t *buffer, uint8_t len);
+
+#ifdef ERRIEZ_DS3231_STATS
+    friend class DS3231StatsScope;
+    unsigned long statsMicros();
+    void statsLatency(unsigned long start);
+    void statsWrite(unsigned long start, uint8_t len, bool stop, uint8_t result);
+    void statsRead(unsigned long start, uint8_t len, uint8_t received);
+#endif
 };
 
+/*!
+ * \brief Packed date and time equal.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a == b.
+ */
+inline bool operator==(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) == 0;
+}
+
+/*!
+ * \brief Packed date and time not equal.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a != b.
+ */
+inline bool operator!=(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) != 0;
+}
+
+/*!
+ * \brief Packed date and time before.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a is before b.
+ */
+inline bool operator<(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) < 0;
+}
+
+/*!
+ * \brief Packed date and time after.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a is after b.
+ */
+inline bool operator>(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) > 0;
+}
+
+/*!
+ * \brief Packed date and time before or equal.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a is before or equal to b.
+ */
+inline bool operator<=(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) <= 0;
+}
+
+/*!
+ * \brief Packed date and time after or equal.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      True when a is after or equal to b.
+ */
+inline bool operator>=(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return ErriezDS3231::compareDateTime(&a, &b) >= 0;
+}
+
+/*!
+ * \brief Seconds between two packed dates and times.
+ * \param a
+ *      Date and time.
+ * \param b
+ *      Date and time.
+ * \return
+ *      Seconds a - b, valid for differences up to 68 years.
+ */
+inline int32_t operator-(const DS3231DateTime &a, const DS3231DateTime &b)
+{
+    return (int32_t)(ErriezDS3231::dateTimeToEpoch(&a) - ErriezDS3231::dateTimeToEpoch(&b));
+}
+
 #endif // ERRIEZ_DS3231_H_
@@ -0,0 +1,361 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Async.cpp
+ * \brief DS3231 high precision RTC library for Arduino: cooperative asynchronous register reads
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Async.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Async::ErriezDS3231Async(ErriezDS3231 *rtc) :
+    _rtc(rtc), _regValid(0), _queueHead(0), _queueCount(0), _pointerSet(false), _offset(0),
+    _checkSeconds(false), _restarts(0), _errors(0)
+{
+    memset(&_regs, 0, sizeof(_regs));
+}
+
+/*!
+ * \brief Queue register read.
+ * \details
+ *      The result of a previous read of the same registers is invalidated. A read which is
+ *      already queued is not queued again.
+ * \param reg
+ *      First RTC register 0x00..0x12.
+ * \param len
+ *      Number of registers.
+ * \retval true
+ *      Read queued.
+ * \retval false
+ *      Invalid register range or queue full.
+ */
+bool ErriezDS3231Async::beginRead(uint8_t reg, uint8_t len)
+{
+    uint8_t idx;
+
+    if ((len == 0) || ((reg + len) > DS3231_NUM_REGS)) {
+        return false;
+    }
+
+    // Skip reads which are queued, but not started
+    for (uint8_t i = 0; i < _queueCount; i++) {
+        idx = (_queueHead + i) % DS3231_ASYNC_QUEUE_SIZE;
+        if ((_queueReg[idx] == reg) && (_queueLen[idx] == len) && ((i > 0) || !_pointerSet)) {
+            return true;
+        }
+    }
+
+    if (_queueCount >= DS3231_ASYNC_QUEUE_SIZE) {
+        return false;
+    }
+
+    // Invalidate previous result
+    _regValid &= ~regMask(reg, len);
+
+    // Append read to queue
+    idx = (_queueHead + _queueCount) % DS3231_ASYNC_QUEUE_SIZE;
+    _queueReg[idx] = reg;
+    _queueLen[idx] = len;
+    _queueCount++;
+
+    return true;
+}
+
+/*!
+ * \brief Queue date/time registers read.
+ * \retval true
+ *      Read queued.
+ * \retval false
+ *      Queue full.
+ */
+bool ErriezDS3231Async::beginReadTime()
+{
+    return beginRead(DS3231_REG_SECONDS, 7);
+}
+
+/*!
+ * \brief Queue control and status registers read.
+ * \retval true
+ *      Read queued.
+ * \retval false
+ *      Queue full.
+ */
+bool ErriezDS3231Async::beginReadStatus()
+{
+    return beginRead(DS3231_REG_CONTROL, 2);
+}
+
+/*!
+ * \brief Queue temperature registers read.
+ * \retval true
+ *      Read queued.
+ * \retval false
+ *      Queue full.
+ */
+bool ErriezDS3231Async::beginReadTemperature()
+{
+    return beginRead(DS3231_REG_TEMP_MSB, 2);
+}
+
+/*!
+ * \brief Execute the next I2C transfer.
+ * \details
+ *      Call this function from loop(). Each call executes at most one I2C transfer of at most
+ *      DS3231_ASYNC_CHUNK_SIZE data bytes.
+ * \retval true
+ *      Reads pending.
+ * \retval false
+ *      Idle.
+ */
+bool ErriezDS3231Async::poll()
+{
+    uint8_t reg;
+    uint8_t len;
+    uint8_t chunk;
+    uint8_t seconds;
+
+    if (_queueCount == 0) {
+        return false;
+    }
+
+    reg = _queueReg[_queueHead];
+    len = _queueLen[_queueHead];
+
+    if (!_pointerSet) {
+        // Set register pointer
+        if (!_rtc->writeBuffer(_checkSeconds ? DS3231_REG_SECONDS : reg, NULL, 0)) {
+            complete(false);
+        } else {
+            _pointerSet = true;
+        }
+    } else if (_checkSeconds) {
+        // Read seconds register again after the date/time registers
+        if (!_rtc->readBufferFromPointer(DS3231_REG_SECONDS, &seconds, 1)) {
+            complete(false);
+        } else if (seconds < _regs.regs[DS3231_REG_SECONDS]) {
+            // Seconds rolled over between the chunks: restart, the last time in one chunk
+            _restarts++;
+            _pointerSet = false;
+            _offset = 0;
+            _checkSeconds = false;
+        } else {
+            complete(true);
+        }
+    } else {
+        // Read next chunk from the auto-incremented register pointer
+        chunk = len - _offset;
+        if ((chunk > DS3231_ASYNC_CHUNK_SIZE) && (_restarts < 2)) {
+            chunk = DS3231_ASYNC_CHUNK_SIZE;
+        }
+        if (!_rtc->readBufferFromPointer(reg + _offset, &_regs.regs[reg + _offset], chunk)) {
+            complete(false);
+        } else if ((_offset += chunk) == len) {
+            if ((reg == DS3231_REG_SECONDS) && (len > 1) && (chunk < len)) {
+                // Date/time registers read in more than one chunk
+                _checkSeconds = true;
+                _pointerSet = false;
+            } else {
+                complete(true);
+            }
+        }
+    }
+
+    return (_queueCount > 0);
+}
+
+/*!
+ * \brief Remove the read in progress from the queue.
+ * \param success
+ *      true: Registers read, false: Transfer failed, the read is dropped.
+ */
+void ErriezDS3231Async::complete(bool success)
+{
+    if (success) {
+        _regValid |= regMask(_queueReg[_queueHead], _queueLen[_queueHead]);
+    } else {
+        _errors++;
+    }
+
+    _pointerSet = false;
+    _offset = 0;
+    _checkSeconds = false;
+    _restarts = 0;
+    _queueHead = (_queueHead + 1) % DS3231_ASYNC_QUEUE_SIZE;
+    _queueCount--;
+}
+
+/*!
+ * \brief Check if register reads are pending.
+ * \retval true
+ *      Reads pending.
+ * \retval false
+ *      Idle.
+ */
+bool ErriezDS3231Async::isBusy()
+{
+    return (_queueCount > 0);
+}
+
+/*!
+ * \brief Get number of failed I2C transfers.
+ * \return
+ *      Number of errors.
+ */
+uint16_t ErriezDS3231Async::getErrors()
+{
+    return _errors;
+}
+
+/*!
+ * \brief Check if registers have been read.
+ * \param reg
+ *      First RTC register 0x00..0x12.
+ * \param len
+ *      Number of registers.
+ * \retval true
+ *      All registers read since the last begin...() call of these registers.
+ * \retval false
+ *      Result not available.
+ */
+bool ErriezDS3231Async::isReady(uint8_t reg, uint8_t len)
+{
+    uint32_t mask = regMask(reg, len);
+
+    return ((_regValid & mask) == mask);
+}
+
+/*!
+ * \brief Get date/time result of beginReadTime().
+ * \param dt
+ *      Date and time struct tm.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Result not available or invalid date/time.
+ */
+bool ErriezDS3231Async::resultTime(struct tm *dt)
+{
+    if (!isReady(DS3231_REG_SECONDS, 7)) {
+        return false;
+    }
+
+    return ErriezDS3231::decodeTime(&_regs, dt);
+}
+
+/*!
+ * \brief Get Unix epoch result of beginReadTime().
+ * \param t
+ *      Unix epoch seconds since 1970.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Result not available or invalid date/time.
+ */
+bool ErriezDS3231Async::resultEpoch(time_t *t)
+{
+    if (!isReady(DS3231_REG_SECONDS, 7)) {
+        return false;
+    }
+
+    return ErriezDS3231::decodeEpoch(&_regs, t);
+}
+
+/*!
+ * \brief Get status register result of beginReadStatus().
+ * \details
+ *      Use the DS3231_STAT_... bits, or decode the control and status registers with
+ *      getRegisters() and the ErriezDS3231::decode...() functions.
+ * \param status
+ *      Status register value.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Result not available.
+ */
+bool ErriezDS3231Async::resultStatus(uint8_t *status)
+{
+    if (!isReady(DS3231_REG_CONTROL, 2)) {
+        return false;
+    }
+
+    *status = _regs.regs[DS3231_REG_STATUS];
+
+    return true;
+}
+
+/*!
+ * \brief Get temperature result of beginReadTemperature().
+ * \param temperature
+ *      8-bit signed temperature in degree Celsius.
+ * \param fraction
+ *      Temperature fraction in steps of 0.25 degree Celsius, see ErriezDS3231::getTemperature().
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Result not available.
+ */
+bool ErriezDS3231Async::resultTemperature(int8_t *temperature, uint8_t *fraction)
+{
+    if (!isReady(DS3231_REG_TEMP_MSB, 2)) {
+        return false;
+    }
+
+    ErriezDS3231::decodeTemperature(&_regs, temperature, fraction);
+
+    return true;
+}
+
+/*!
+ * \brief Get register image with all read results.
+ * \return
+ *      Register image, only registers which are ready contain valid data.
+ */
+const DS3231Snapshot *ErriezDS3231Async::getRegisters()
+{
+    return &_regs;
+}
+
+/*!
+ * \brief Convert register range to bit mask.
+ * \param reg
+ *      First RTC register.
+ * \param len
+ *      Number of registers.
+ * \return
+ *      Bit n set for every register n in range.
+ */
+uint32_t ErriezDS3231Async::regMask(uint8_t reg, uint8_t len)
+{
+    return ((1UL << len) - 1) << reg;
+}
@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Async.h
+ * \brief DS3231 high precision RTC library for Arduino: cooperative asynchronous register reads
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_ASYNC_H_
+#define ERRIEZ_DS3231_ASYNC_H_
+
+#include "ErriezDS3231.h"
+
+//! Maximum number of pending register reads
+#define DS3231_ASYNC_QUEUE_SIZE     4
+
+#ifndef DS3231_ASYNC_CHUNK_SIZE
+//! Maximum number of registers read per poll() call
+#define DS3231_ASYNC_CHUNK_SIZE     4
+#endif
+
+/*!
+ * \brief DS3231 cooperative asynchronous register read engine
+ * \details
+ *      Register reads are queued with the begin...() functions and executed by poll() from
+ *      loop(). Each register read is split in short I2C transfers: setting the register pointer,
+ *      followed by reads of at most DS3231_ASYNC_CHUNK_SIZE registers from the auto-incremented
+ *      register pointer. Every poll() call executes one of these transfers, so application work
+ *      can be done in between. No RTOS is required.
+ *
+ *      The RTC only latches the date/time registers for a single transfer. When the date/time
+ *      registers are read in more than one chunk, the seconds register is read again afterwards
+ *      and the read is restarted when the seconds rolled over in between. This costs two extra
+ *      transfers and requires the chunks of one read to complete within a minute.
+ *
+ *      Results are stored in a register image and decoded with the result...() functions.
+ *      Do not call ErriezDS3231 register functions while a read is pending, because this moves
+ *      the RTC register pointer.
+ */
+class ErriezDS3231Async
+{
+public:
+    explicit ErriezDS3231Async(ErriezDS3231 *rtc);
+
+    // Queue register reads
+    bool beginRead(uint8_t reg, uint8_t len);
+    bool beginReadTime();
+    bool beginReadStatus();
+    bool beginReadTemperature();
+
+    // Execute next I2C transfer
+    bool poll();
+    bool isBusy();
+    uint16_t getErrors();
+
+    // Results
+    bool isReady(uint8_t reg, uint8_t len);
+    bool resultTime(struct tm *dt);
+    bool resultEpoch(time_t *t);
+    bool resultStatus(uint8_t *status);
+    bool resultTemperature(int8_t *temperature, uint8_t *fraction);
+    const DS3231Snapshot *getRegisters();
+
+private:
+    ErriezDS3231 *_rtc;                 //!< RTC object
+    DS3231Snapshot _regs;               //!< Register image with read results
+    uint32_t _regValid;                 //!< Bit n set: register n read completed
+    uint8_t _queueReg[DS3231_ASYNC_QUEUE_SIZE]; //!< Queued first register
+    uint8_t _queueLen[DS3231_ASYNC_QUEUE_SIZE]; //!< Queued number of registers
+    uint8_t _queueHead;                 //!< Index of the read in progress
+    uint8_t _queueCount;                //!< Number of queued reads
+    bool _pointerSet;                   //!< Register pointer of the read in progress is set
+    uint8_t _offset;                    //!< Number of registers of the read in progress done
+    bool _checkSeconds;                 //!< Read seconds register again after the read
+    uint8_t _restarts;                  //!< Restarts of the read in progress
+    uint16_t _errors;                   //!< Number of failed I2C transfers
+
+    void complete(bool success);
+    static uint32_t regMask(uint8_t reg, uint8_t len);
+};
+
+#endif // ERRIEZ_DS3231_ASYNC_H_
@@ -0,0 +1,436 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Batch.cpp
+ * \brief DS3231 high precision RTC library for Arduino: batched register writes
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Batch.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Batch::ErriezDS3231Batch(ErriezDS3231 *rtc) :
+    _rtc(rtc), _transactions(0), _saved(0)
+{
+    clear();
+}
+
+/*!
+ * \brief Record register write.
+ * \param reg
+ *      RTC register number 0x00..0x10.
+ * \param value
+ *      8-bit unsigned register value.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Read-only register.
+ */
+bool ErriezDS3231Batch::setRegister(uint8_t reg, uint8_t value)
+{
+    if (reg > DS3231_REG_AGING_OFFSET) {
+        return false;
+    }
+
+    _regs[reg] = value;
+    _mask[reg] = 0xFF;
+    _unbatched++;
+
+    return true;
+}
+
+/*!
+ * \brief Record register bits write.
+ * \details
+ *      The register is read during commit() when not all writable bits are edited.
+ * \param reg
+ *      RTC register number 0x00..0x10.
+ * \param mask
+ *      Bits to modify.
+ * \param value
+ *      New value of the bits in mask.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Read-only register.
+ */
+bool ErriezDS3231Batch::updateRegister(uint8_t reg, uint8_t mask, uint8_t value)
+{
+    if (reg > DS3231_REG_AGING_OFFSET) {
+        return false;
+    }
+
+    _regs[reg] = (_regs[reg] & ~mask) | (value & mask);
+    _mask[reg] |= mask;
+
+    // Read-modify-write
+    _unbatched += 2;
+
+    return true;
+}
+
+/*!
+ * \brief Record date and time write and enable the oscillator, see ErriezDS3231::setEpoch().
+ * \param t
+ *      time_t time in the range 2000..2099.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Time out of range.
+ */
+bool ErriezDS3231Batch::setEpoch(time_t t)
+{
+    if (!ErriezDS3231::encodeEpochRegisters(t, &_regs[DS3231_REG_SECONDS])) {
+        return false;
+    }
+
+    memset(&_mask[DS3231_REG_SECONDS], 0xFF, 7);
+    _unbatched++;
+
+    // Enable oscillator and clear oscillator stop flag, like ErriezDS3231::setEpoch()
+    updateRegister(DS3231_REG_CONTROL, (1 << DS3231_CTRL_EOSC), 0);
+
+    return updateRegister(DS3231_REG_STATUS, (1 << DS3231_STAT_OSF), 0);
+}
+
+/*!
+ * \brief Record alarm 1 and clear alarm 1 flag, see ErriezDS3231::setAlarm1().
+ * \param alarmType
+ *      Alarm 1 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month. This depends on alarmType.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ * \param seconds
+ *      Alarm match seconds.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::setAlarm1(Alarm1Type alarmType,
+                                  uint8_t dayDate, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+    ErriezDS3231::encodeAlarm1Registers(alarmType, dayDate, hours, minutes, seconds,
+                                        &_regs[DS3231_REG_ALARM1_SEC]);
+    memset(&_mask[DS3231_REG_ALARM1_SEC], 0xFF, 4);
+    _unbatched++;
+
+    return clearAlarmFlag(Alarm1);
+}
+
+/*!
+ * \brief Record alarm 2 and clear alarm 2 flag, see ErriezDS3231::setAlarm2().
+ * \param alarmType
+ *      Alarm 2 type.
+ * \param dayDate
+ *      Alarm match day of the week or day of the month. This depends on alarmType.
+ * \param hours
+ *      Alarm match hours.
+ * \param minutes
+ *      Alarm match minutes.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::setAlarm2(Alarm2Type alarmType, uint8_t dayDate, uint8_t hours,
+                                  uint8_t minutes)
+{
+    ErriezDS3231::encodeAlarm2Registers(alarmType, dayDate, hours, minutes,
+                                        &_regs[DS3231_REG_ALARM2_MIN]);
+    memset(&_mask[DS3231_REG_ALARM2_MIN], 0xFF, 3);
+    _unbatched++;
+
+    return clearAlarmFlag(Alarm2);
+}
+
+/*!
+ * \brief Record alarm interrupt enable, see ErriezDS3231::alarmInterruptEnable().
+ * \param alarmId
+ *      Alarm1 or Alarm2 enum.
+ * \param enable
+ *      true: Enable alarm interrupt.\n
+ *      false: Disable alarm interrupt.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::alarmInterruptEnable(AlarmId alarmId, bool enable)
+{
+    uint8_t mask = (1 << DS3231_CTRL_INTCN) | (1 << (alarmId - 1));
+
+    clearAlarmFlag(alarmId);
+
+    return updateRegister(DS3231_REG_CONTROL, mask, enable ? mask : (1 << DS3231_CTRL_INTCN));
+}
+
+/*!
+ * \brief Record alarm flag clear.
+ * \param alarmId
+ *      Alarm1 or Alarm2 enum.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::clearAlarmFlag(AlarmId alarmId)
+{
+    return updateRegister(DS3231_REG_STATUS, (1 << (alarmId - 1)), 0);
+}
+
+/*!
+ * \brief Record SQW (Square Wave) output pin configuration, see ErriezDS3231::setSquareWave().
+ * \param squareWave
+ *      SquareWave configuration.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::setSquareWave(SquareWave squareWave)
+{
+    return updateRegister(DS3231_REG_CONTROL,
+                          (1 << DS3231_CTRL_BBSQW) |
+                          (1 << DS3231_CTRL_INTCN) |
+                          (1 << DS3231_CTRL_RS2) |
+                          (1 << DS3231_CTRL_RS1),
+                          squareWave);
+}
+
+/*!
+ * \brief Record 32kHz output clock pin enable.
+ * \param enable
+ *      true: Enable 32kHz output clock pin.\n
+ *      false: Disable 32kHz output clock pin.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::outputClockPinEnable(bool enable)
+{
+    return updateRegister(DS3231_REG_STATUS, (1 << DS3231_STAT_EN32KHZ),
+                          enable ? (1 << DS3231_STAT_EN32KHZ) : 0);
+}
+
+/*!
+ * \brief Record aging offset.
+ * \details
+ *      The aging offset is applied at the next temperature conversion. Call
+ *      ErriezDS3231::startTemperatureConversion() after commit() or wait up to 64 seconds.
+ * \param val
+ *      Aging offset value -127..127, 0.1ppm per LSB.
+ * \retval true
+ *      Success.
+ */
+bool ErriezDS3231Batch::setAgingOffset(int8_t val)
+{
+    return setRegister(DS3231_REG_AGING_OFFSET, (uint8_t)val);
+}
+
+/*!
+ * \brief Write recorded edits to the RTC.
+ * \details
+ *      The edits are kept when a transfer fails, so commit() can be retried.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C transfer failed, see ErriezDS3231::getLastError().
+ */
+bool ErriezDS3231Batch::commit()
+{
+    uint8_t buffer[DS3231_NUM_REGS];
+    uint32_t dirty = 0;
+    uint32_t bridge = 0;
+    uint8_t first = 0xFF;
+    uint8_t last = 0;
+    uint8_t gap;
+    uint8_t reg;
+
+    _transactions = 0;
+
+    // Registers with partial edits must be read
+    for (reg = 0; reg < DS3231_NUM_REGS; reg++) {
+        if (!_mask[reg]) {
+            continue;
+        }
+        dirty |= (1UL << reg);
+        if ((_mask[reg] & requiredMask(reg)) != requiredMask(reg)) {
+            if (first == 0xFF) {
+                first = reg;
+            }
+            last = reg;
+        }
+    }
+
+    if (!dirty) {
+        return true;
+    }
+
+    if (first != 0xFF) {
+        // Write short gaps between edited registers with the value read
+        for (reg = DS3231_REG_ALARM1_SEC; reg < DS3231_REG_AGING_OFFSET; reg++) {
+            if (!(dirty & (1UL << reg)) || (dirty & (1UL << (reg + 1)))) {
+                continue;
+            }
+            for (gap = 1; (reg + gap) <= DS3231_REG_AGING_OFFSET; gap++) {
+                if (dirty & (1UL << (reg + gap))) {
+                    break;
+                }
+            }
+            if (((reg + gap) <= DS3231_REG_AGING_OFFSET) && ((gap - 1) <= DS3231_BATCH_GAP_MAX)) {
+                bridge |= ((1UL << gap) - 2) << reg;
+                if ((reg + 1) < first) {
+                    first = reg + 1;
+                }
+                if ((reg + gap - 1) > last) {
+                    last = reg + gap - 1;
+                }
+            }
+        }
+
+        // Read all registers with partial edits and gaps in one transfer
+        if (!_rtc->readBuffer(first, &buffer[first], last - first + 1)) {
+            return false;
+        }
+        _transactions++;
+
+        dirty |= bridge;
+        for (reg = first; reg <= last; reg++) {
+            if (!(dirty & (1UL << reg))) {
+                continue;
+            }
+
+            // Merge edited bits with the register value
+            _regs[reg] = (buffer[reg] & ~_mask[reg]) | (_regs[reg] & _mask[reg]);
+        }
+    }
+
+    // Leave alarm and oscillator stop flags unchanged
+    _regs[DS3231_REG_STATUS] |= (DS3231_STAT_KEEP & ~_mask[DS3231_REG_STATUS]);
+
+    // Do not start a temperature conversion
+    _regs[DS3231_REG_CONTROL] &= ~(DS3231_CTRL_VOLATILE & ~_mask[DS3231_REG_CONTROL]);
+
+    if (!writeRuns(dirty)) {
+        return false;
+    }
+
+    if (_unbatched > _transactions) {
+        _saved += _unbatched - _transactions;
+    }
+    clear();
+
+    return true;
+}
+
+/*!
+ * \brief Discard recorded edits.
+ */
+void ErriezDS3231Batch::clear()
+{
+    memset(_regs, 0, sizeof(_regs));
+    memset(_mask, 0, sizeof(_mask));
+    _unbatched = 0;
+}
+
+/*!
+ * \brief Get number of I2C transactions of the last commit().
+ * \return
+ *      Number of register reads and writes.
+ */
+uint8_t ErriezDS3231Batch::getTransactions()
+{
+    return _transactions;
+}
+
+/*!
+ * \brief Get number of I2C transactions saved by all commits.
+ * \details
+ *      Compared to the same edits with ErriezDS3231 functions without shadow register cache.
+ * \return
+ *      Number of saved I2C transactions.
+ */
+uint32_t ErriezDS3231Batch::getSavedTransactions()
+{
+    return _saved;
+}
+
+/*!
+ * \brief Get register bits which must be edited to write a register without reading it.
+ * \param reg
+ *      RTC register number.
+ * \return
+ *      Bit mask.
+ */
+uint8_t ErriezDS3231Batch::requiredMask(uint8_t reg)
+{
+    if (reg == DS3231_REG_STATUS) {
+        // Flags are written with a logic 1, BSY is read-only
+        return (1 << DS3231_STAT_EN32KHZ);
+    } else if (reg == DS3231_REG_CONTROL) {
+        return (uint8_t)~DS3231_CTRL_VOLATILE;
+    }
+
+    return 0xFF;
+}
+
+/*!
+ * \brief Write ranges of adjacent registers.
+ * \param regMask
+ *      Bit n set: write register n.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C write failed.
+ */
+bool ErriezDS3231Batch::writeRuns(uint32_t regMask)
+{
+    uint8_t reg = 0;
+    uint8_t len;
+
+    while (reg < DS3231_NUM_REGS) {
+        if (!(regMask & (1UL << reg))) {
+            reg++;
+            continue;
+        }
+
+        // Adjacent registers up to the Wire buffer size
+        for (len = 1; (len < DS3231_BATCH_BURST_MAX) && ((reg + len) < DS3231_NUM_REGS); len++) {
+            if (!(regMask & (1UL << (reg + len)))) {
+                break;
+            }
+        }
+
+        if (!_rtc->writeBuffer(reg, &_regs[reg], len)) {
+            return false;
+        }
+        _transactions++;
+
+        reg += len;
+    }
+
+    return true;
+}
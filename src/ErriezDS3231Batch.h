@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Batch.h
+ * \brief DS3231 high precision RTC library for Arduino: batched register writes
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_BATCH_H_
+#define ERRIEZ_DS3231_BATCH_H_
+
+#include "ErriezDS3231.h"
+
+#ifndef DS3231_BATCH_BURST_MAX
+//! Maximum number of registers per write: 32 byte Wire buffer minus the register number
+#define DS3231_BATCH_BURST_MAX      31
+#endif
+
+//! Maximum number of unchanged registers written between two edited register ranges
+#define DS3231_BATCH_GAP_MAX        3
+
+/*!
+ * \brief Batch of register writes
+ * \details
+ *      Configuration functions record register edits instead of accessing the bus. commit()
+ *      reads all registers with partial edits in one transfer, merges the edits and writes
+ *      adjacent registers in one burst. Short gaps between edited alarm, control, status and
+ *      aging offset registers are written with the value read, when a read is needed anyway.
+ *
+ *      For example, setAlarm1(), alarmInterruptEnable() and setSquareWave() take 9 I2C
+ *      transactions with ErriezDS3231 and 2 with a batch: read 0x0B..0x0F, write 0x07..0x0F.
+ *
+ *      Alarm flags which are not edited are written with a logic 1 which leaves them unchanged.
+ */
+class ErriezDS3231Batch
+{
+public:
+    explicit ErriezDS3231Batch(ErriezDS3231 *rtc);
+
+    // Record register edits
+    bool setRegister(uint8_t reg, uint8_t value);
+    bool updateRegister(uint8_t reg, uint8_t mask, uint8_t value);
+    bool setEpoch(time_t t);
+    bool setAlarm1(Alarm1Type alarmType,
+                   uint8_t dayDate, uint8_t hours, uint8_t minutes, uint8_t seconds);
+    bool setAlarm2(Alarm2Type alarmType, uint8_t dayDate, uint8_t hours, uint8_t minutes);
+    bool alarmInterruptEnable(AlarmId alarmId, bool enable);
+    bool clearAlarmFlag(AlarmId alarmId);
+    bool setSquareWave(SquareWave squareWave);
+    bool outputClockPinEnable(bool enable);
+    bool setAgingOffset(int8_t val);
+
+    // Write recorded edits
+    bool commit();
+    void clear();
+
+    // Statistics
+    uint8_t getTransactions();
+    uint32_t getSavedTransactions();
+
+private:
+    ErriezDS3231 *_rtc;                 //!< RTC object
+    uint8_t _regs[DS3231_NUM_REGS];     //!< Edited register values
+    uint8_t _mask[DS3231_NUM_REGS];     //!< Edited register bits, 0: register not edited
+    uint8_t _unbatched;                 //!< I2C transactions of the edits without batch
+    uint8_t _transactions;              //!< I2C transactions of the last commit
+    uint32_t _saved;                    //!< Number of I2C transactions saved by all commits
+
+    static uint8_t requiredMask(uint8_t reg);
+    bool writeRuns(uint32_t regMask);
+};
+
+#endif // ERRIEZ_DS3231_BATCH_H_
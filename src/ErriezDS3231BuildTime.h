@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231BuildTime.h
+ * \brief DS3231 high precision RTC library for Arduino: compile-time build date and time
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ *
+ *      Converts the __DATE__ ("Mmm dd yyyy") and __TIME__ ("hh:mm:ss") macros to a BCD register
+ *      image and Unix epoch at compile time. No parsing code is linked in. The macros contain the
+ *      local time of the build machine.
+ */
+
+#ifndef ERRIEZ_DS3231_BUILD_TIME_H_
+#define ERRIEZ_DS3231_BUILD_TIME_H_
+
+#include "ErriezDS3231.h"
+
+/*!
+ * \brief Initializer of the 7 date and time registers 0x00..0x06 at build time
+ * \details
+ *      Example: const uint8_t buildTime[DS3231_TIME_IMAGE_SIZE] = DS3231_BUILD_TIME_IMAGE;
+ */
+#define DS3231_BUILD_TIME_IMAGE { \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_SECONDS), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_MINUTES), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_HOURS), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_DAY_WEEK), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_DAY_MONTH), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_MONTH), \
+    ErriezDS3231BuildTime::timeRegister(__DATE__, __TIME__, DS3231_REG_YEAR) \
+}
+
+//! Unix epoch at build time
+#define DS3231_BUILD_EPOCH      ErriezDS3231BuildTime::epoch(__DATE__, __TIME__)
+
+//! True when the build date is in the RTC range 2000..2099
+#define DS3231_BUILD_TIME_VALID ErriezDS3231BuildTime::valid(__DATE__, __TIME__)
+
+/*!
+ * \brief Compile-time conversion of __DATE__ and __TIME__
+ */
+class ErriezDS3231BuildTime
+{
+public:
+    /*!
+     * \brief Two digit field.
+     * \param str
+     *      String with two digits, a leading space is allowed.
+     * \return
+     *      Value 0..99.
+     */
+    static constexpr uint8_t digits(const char *str)
+    {
+        return (uint8_t)(((str[0] == ' ') ? 0 : (str[0] - '0') * 10) + (str[1] - '0'));
+    }
+
+    /*!
+     * \brief Month from __DATE__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \return
+     *      Month 1..12 (1=January).
+     */
+    static constexpr uint8_t month(const char *date)
+    {
+        return (date[0] == 'J') ? ((date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7)) :
+               (date[0] == 'F') ? 2 :
+               (date[0] == 'M') ? ((date[2] == 'r') ? 3 : 5) :
+               (date[0] == 'A') ? ((date[1] == 'p') ? 4 : 8) :
+               (date[0] == 'S') ? 9 :
+               (date[0] == 'O') ? 10 :
+               (date[0] == 'N') ? 11 : 12;
+    }
+
+    /*!
+     * \brief Day of the month from __DATE__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \return
+     *      Day of the month 1..31.
+     */
+    static constexpr uint8_t mday(const char *date)
+    {
+        return digits(&date[4]);
+    }
+
+    /*!
+     * \brief Year from __DATE__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \return
+     *      Year, for example 2020.
+     */
+    static constexpr uint16_t year(const char *date)
+    {
+        return (uint16_t)(digits(&date[7]) * 100U + digits(&date[9]));
+    }
+
+    /*!
+     * \brief Date in the RTC range.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \param time
+     *      Time string "hh:mm:ss".
+     * \retval true
+     *      Year 2000..2099 and valid time.
+     * \retval false
+     *      Out of range.
+     */
+    static constexpr bool valid(const char *date, const char *time)
+    {
+        return (year(date) >= 2000) && (year(date) <= 2099) &&
+               (digits(&time[0]) <= 23) && (digits(&time[3]) <= 59) && (digits(&time[6]) <= 59);
+    }
+
+    /*!
+     * \brief Days since 1 January 1970 of __DATE__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \return
+     *      Days since 1970.
+     */
+    static constexpr uint16_t days(const char *date)
+    {
+        return ErriezDS3231::daysFromCivil(year(date), month(date), mday(date));
+    }
+
+    /*!
+     * \brief Unix epoch of __DATE__ and __TIME__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \param time
+     *      Time string "hh:mm:ss".
+     * \return
+     *      Seconds since 1970.
+     */
+    static constexpr uint32_t epoch(const char *date, const char *time)
+    {
+        return ErriezDS3231::epochFromCivil(year(date), month(date), mday(date),
+                                            digits(&time[0]), digits(&time[3]), digits(&time[6]));
+    }
+
+    /*!
+     * \brief BCD date or time register of __DATE__ and __TIME__.
+     * \param date
+     *      Date string "Mmm dd yyyy".
+     * \param time
+     *      Time string "hh:mm:ss".
+     * \param reg
+     *      Register 0x00..0x06.
+     * \return
+     *      BCD register value, 24-hour mode.
+     */
+    static constexpr uint8_t timeRegister(const char *date, const char *time, uint8_t reg)
+    {
+        return (reg == DS3231_REG_SECONDS) ? ErriezDS3231::decToBcd(digits(&time[6])) :
+               (reg == DS3231_REG_MINUTES) ? ErriezDS3231::decToBcd(digits(&time[3])) :
+               (reg == DS3231_REG_HOURS) ? ErriezDS3231::decToBcd(digits(&time[0])) :
+               (reg == DS3231_REG_DAY_WEEK) ?
+                    (uint8_t)(ErriezDS3231::weekdayFromDays(days(date)) + 1) :
+               (reg == DS3231_REG_DAY_MONTH) ? ErriezDS3231::decToBcd(mday(date)) :
+               (reg == DS3231_REG_MONTH) ? ErriezDS3231::decToBcd(month(date)) :
+               ErriezDS3231::decToBcd(digits(&date[9]));
+    }
+};
+
+#endif // ERRIEZ_DS3231_BUILD_TIME_H_
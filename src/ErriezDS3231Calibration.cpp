@@ -0,0 +1,306 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Calibration.cpp
+ * \brief DS3231 high precision RTC library for Arduino: aging offset calibration
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include "ErriezDS3231Calibration.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Calibration::ErriezDS3231Calibration(ErriezDS3231 *rtc) :
+    _rtc(rtc), _state(CalIdle), _window(DS3231_CAL_WINDOW), _maxSteps(DS3231_CAL_MAX_STEPS),
+    _steps(0), _aging(0), _errorPpb(0), _conversionPending(false)
+{
+    restartWindow();
+}
+
+/*!
+ * \brief Start calibration.
+ * \details
+ *      Reads the current aging offset and enables the 1Hz SQW output. Calibrate at a stable
+ *      temperature, preferably 25 degree Celsius.
+ * \param windowSeconds
+ *      Measurement window in seconds 2..DS3231_CAL_WINDOW_MAX.
+ * \param maxSteps
+ *      Maximum number of aging offset steps.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid window or I2C transfer failed.
+ */
+bool ErriezDS3231Calibration::begin(uint16_t windowSeconds, uint8_t maxSteps)
+{
+    uint8_t regVal;
+
+    if ((windowSeconds < 2) || (windowSeconds > DS3231_CAL_WINDOW_MAX)) {
+        return false;
+    }
+
+    if (!_rtc->readRegister(DS3231_REG_AGING_OFFSET, &regVal) ||
+        !_rtc->setSquareWave(SquareWave1Hz)) {
+        return false;
+    }
+
+    _aging = (int8_t)regVal;
+    _window = windowSeconds;
+    _maxSteps = maxSteps;
+    _steps = 0;
+    _errorPpb = 0;
+    _conversionPending = false;
+    _state = CalMeasuring;
+    restartWindow();
+
+    // The first SQW edge after enabling the output may be incomplete
+    _settle = 1;
+
+    return true;
+}
+
+/*!
+ * \brief Add reference timestamp of a 1Hz SQW edge.
+ * \details
+ *      Call once for every falling edge of the SQW pin. Missed edges disturb the measurement.
+ * \param refMicros
+ *      Reference timestamp of the edge in us, may wrap. The window must be shorter than 71
+ *      minutes.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Aging offset write failed.
+ */
+bool ErriezDS3231Calibration::addEdge(uint32_t refMicros)
+{
+    uint32_t elapsed;
+
+    if (!acceptSample()) {
+        return true;
+    }
+
+    if (_samples == 0) {
+        _refStart = refMicros;
+    }
+
+    // RTC seconds minus reference time since the first edge: positive when the RTC runs fast
+    elapsed = refMicros - _refStart;
+
+    return addPhase((int32_t)((uint32_t)_samples * 1000000UL - elapsed) * 1000L);
+}
+
+/*!
+ * \brief Add number of 32kHz output cycles counted during one reference second.
+ * \param cycles
+ *      Number of cycles, nominal 32768.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Aging offset write failed.
+ */
+bool ErriezDS3231Calibration::addCycles(uint32_t cycles)
+{
+    if (!acceptSample()) {
+        return true;
+    }
+
+    // Accumulated phase in cycles, 1 cycle is 1e9 / 32768 = 1953125 / 64 ns
+    _cycleLead += (int32_t)cycles - 32768L;
+
+    return addPhase((int32_t)(((int64_t)_cycleLead * 1953125L) / 64));
+}
+
+/*!
+ * \brief Get calibration state.
+ * \return
+ *      CalState.
+ */
+CalState ErriezDS3231Calibration::getState()
+{
+    return _state;
+}
+
+/*!
+ * \brief Get frequency error of the last measurement window.
+ * \return
+ *      Frequency error in ppb, positive: RTC runs fast.
+ */
+int32_t ErriezDS3231Calibration::getErrorPpb()
+{
+    return _errorPpb;
+}
+
+/*!
+ * \brief Get aging offset.
+ * \return
+ *      Aging offset register value -128..127.
+ */
+int8_t ErriezDS3231Calibration::getAgingOffset()
+{
+    return _aging;
+}
+
+/*!
+ * \brief Get number of aging offset steps.
+ * \return
+ *      Number of steps.
+ */
+uint8_t ErriezDS3231Calibration::getSteps()
+{
+    return _steps;
+}
+
+/*!
+ * \brief Check if a sample is used for the measurement.
+ * \details
+ *      After an aging offset step, a temperature conversion is started to apply the new offset,
+ *      retried every second while the RTC is busy, followed by DS3231_CAL_SETTLE seconds.
+ * \retval true
+ *      Use sample.
+ * \retval false
+ *      Skip sample.
+ */
+bool ErriezDS3231Calibration::acceptSample()
+{
+    if ((_state != CalMeasuring) && (_state != CalSettling)) {
+        return false;
+    }
+
+    if (_conversionPending) {
+        if (_rtc->startTemperatureConversion()) {
+            _conversionPending = false;
+            _settle = DS3231_CAL_SETTLE;
+        }
+        return false;
+    }
+
+    if (_settle) {
+        _settle--;
+        return false;
+    }
+
+    _state = CalMeasuring;
+
+    return true;
+}
+
+/*!
+ * \brief Add phase sample.
+ * \param leadNs
+ *      RTC phase ahead of the reference in ns.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Aging offset write failed.
+ */
+bool ErriezDS3231Calibration::addPhase(int32_t leadNs)
+{
+    _sumY += leadNs;
+    _sumXY += (int64_t)_samples * leadNs;
+
+    if (++_samples < _window) {
+        return true;
+    }
+
+    return finishWindow();
+}
+
+/*!
+ * \brief Fit frequency error and step the aging offset.
+ * \details
+ *      Least squares slope of the phase y over sample index x = 0..N-1. With centered
+ *      x' = 2x - (N-1): slope = 2 * sum(x'y) / sum(x'^2), sum(x'^2) = N(N^2-1)/3. The phase slope
+ *      in ns per second is the frequency error in ppb.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Aging offset write failed, the step is retried after the next window.
+ */
+bool ErriezDS3231Calibration::finishWindow()
+{
+    int64_t n = _samples;
+    int64_t sumCentered = 2 * _sumXY - (n - 1) * _sumY;
+    int64_t sumSquares = n * (n * n - 1) / 3;
+    int32_t step;
+    int16_t aging;
+
+    // Round to nearest ppb
+    sumCentered *= 2;
+    if (sumCentered < 0) {
+        _errorPpb = (int32_t)((sumCentered - sumSquares / 2) / sumSquares);
+    } else {
+        _errorPpb = (int32_t)((sumCentered + sumSquares / 2) / sumSquares);
+    }
+
+    restartWindow();
+
+    // Round to nearest LSB: a fast RTC needs a higher aging offset
+    if (_errorPpb < 0) {
+        step = (_errorPpb - (DS3231_CAL_PPB_PER_LSB / 2)) / DS3231_CAL_PPB_PER_LSB;
+    } else {
+        step = (_errorPpb + (DS3231_CAL_PPB_PER_LSB / 2)) / DS3231_CAL_PPB_PER_LSB;
+    }
+
+    if (step == 0) {
+        _state = CalConverged;
+        return true;
+    }
+
+    aging = _aging + step;
+    if ((_steps >= _maxSteps) || (aging < -128) || (aging > 127)) {
+        _state = CalFailed;
+        return true;
+    }
+
+    // Write aging offset, applied by the next temperature conversion
+    if (!_rtc->writeRegister(DS3231_REG_AGING_OFFSET, (uint8_t)aging)) {
+        return false;
+    }
+
+    _aging = (int8_t)aging;
+    _steps++;
+    _state = CalSettling;
+    _conversionPending = true;
+
+    return true;
+}
+
+/*!
+ * \brief Clear samples of the measurement window.
+ */
+void ErriezDS3231Calibration::restartWindow()
+{
+    _samples = 0;
+    _settle = 0;
+    _refStart = 0;
+    _cycleLead = 0;
+    _sumY = 0;
+    _sumXY = 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Calibration.h
+ * \brief DS3231 high precision RTC library for Arduino: aging offset calibration
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_CALIBRATION_H_
+#define ERRIEZ_DS3231_CALIBRATION_H_
+
+#include "ErriezDS3231.h"
+
+//! Default measurement window in seconds
+#define DS3231_CAL_WINDOW           120
+
+//! Maximum measurement window in seconds
+#define DS3231_CAL_WINDOW_MAX       3600
+
+//! Default maximum number of aging offset steps
+#define DS3231_CAL_MAX_STEPS        8
+
+//! Typical frequency change per aging offset LSB at 25 degree Celsius in ppb
+#define DS3231_CAL_PPB_PER_LSB      100
+
+//! Seconds skipped after the temperature conversion which applies an aging offset step
+#define DS3231_CAL_SETTLE           1
+
+/*!
+ * \brief Calibration state
+ */
+typedef enum {
+    CalIdle = 0,                //!< Not started
+    CalMeasuring = 1,           //!< Collecting samples
+    CalSettling = 2,            //!< Waiting for the aging offset to be applied
+    CalConverged = 3,           //!< Frequency error below half an aging offset LSB
+    CalFailed = 4,              //!< Not converged within the maximum steps or aging offset limit
+} CalState;
+
+/*!
+ * \brief Closed-loop aging offset calibration
+ * \details
+ *      Measures the phase of the RTC against a reference once per second, fits the frequency
+ *      error with an integer least squares line over a measurement window and steps the aging
+ *      offset register. Positive aging offsets slow the oscillator by about 0.1ppm per LSB.
+ *      The loop repeats until the error is below half an LSB, so the result does not depend on
+ *      the exact LSB size of a device.
+ *
+ *      Feed one sample per second with one of:
+ *      - addEdge(): reference timestamp in us of each 1Hz SQW edge, for example micros() of a
+ *        PPS disciplined MCU or a timestamp supplied by a host.
+ *      - addCycles(): number of 32kHz output cycles counted during one reference second, for
+ *        example with a hardware counter gated by a PPS input.
+ *
+ *      The phase is accumulated, so counter quantization does not accumulate. With 1us edge
+ *      jitter, a 120 second window resolves about 3ppb. A 32kHz cycle count has 30.5us resolution
+ *      and needs a window of about 1800 seconds for the same aging offset result.
+ */
+class ErriezDS3231Calibration
+{
+public:
+    explicit ErriezDS3231Calibration(ErriezDS3231 *rtc);
+
+    bool begin(uint16_t windowSeconds=DS3231_CAL_WINDOW, uint8_t maxSteps=DS3231_CAL_MAX_STEPS);
+    bool addEdge(uint32_t refMicros);
+    bool addCycles(uint32_t cycles);
+
+    CalState getState();
+    int32_t getErrorPpb();
+    int8_t getAgingOffset();
+    uint8_t getSteps();
+
+private:
+    ErriezDS3231 *_rtc;         //!< RTC object
+    CalState _state;            //!< Calibration state
+    uint16_t _window;           //!< Samples per measurement window
+    uint8_t _maxSteps;          //!< Maximum number of aging offset steps
+    uint8_t _steps;             //!< Number of aging offset steps
+    int8_t _aging;              //!< Aging offset register value
+    int32_t _errorPpb;          //!< Last measured frequency error, positive: RTC runs fast
+    uint16_t _samples;          //!< Samples in the current window
+    uint8_t _settle;            //!< Samples to skip before the next window
+    bool _conversionPending;    //!< Temperature conversion to apply the aging offset not started
+    uint32_t _refStart;         //!< Reference timestamp of the first edge in the window
+    int32_t _cycleLead;         //!< 32kHz cycles ahead of the reference in the window
+    int64_t _sumY;              //!< Sum of phase samples
+    int64_t _sumXY;             //!< Sum of sample index times phase
+
+    bool acceptSample();
+    bool addPhase(int32_t leadNs);
+    bool finishWindow();
+    void restartWindow();
+};
+
+#endif // ERRIEZ_DS3231_CALIBRATION_H_
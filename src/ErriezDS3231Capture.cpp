@@ -0,0 +1,424 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Capture.cpp
+ * \brief DS3231 high precision RTC library for Arduino: ISR-safe event timestamp capture
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include "ErriezDS3231Capture.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ * \param buffer
+ *      Ring buffer with size entries. One entry is kept free, so size - 1 events can be queued.
+ * \param size
+ *      Number of entries 2..255.
+ * \param clockMicros
+ *      Local microseconds clock, for example micros(). Required for SquareWave1Hz, may be NULL for
+ *      higher square wave frequencies.
+ */
+ErriezDS3231Capture::ErriezDS3231Capture(ErriezDS3231 *rtc, DS3231CaptureEvent *buffer,
+                                         uint8_t size, unsigned long (*clockMicros)(void)) :
+    _rtc(rtc), _buffer(buffer), _size(size), _clockMicros(clockMicros),
+    _head(0), _tail(0), _overflows(0), _seconds(0), _subTicks(0), _edgeMicros(0),
+    _ticksPerSecond(0), _anchorValid(false), _anchorSeconds(0), _anchorEpoch(0), _errors(0),
+    _missedEdges(0)
+{
+}
+
+/*!
+ * \brief Start capturing.
+ * \details
+ *      Configures the square wave on the INT/SQW pin, discards queued events and aligns the SQW
+ *      counters with the seconds register, which blocks up to 1.1 seconds. The SQW falling edge
+ *      interrupt handler calling tick() must be attached before calling this function.
+ *
+ *      Call begin() again after writing the RTC date/time.
+ * \param squareWave
+ *      SquareWave1Hz, SquareWave1024Hz, SquareWave4096Hz or SquareWave8192Hz.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid argument, set square wave or alignment failed.
+ */
+bool ErriezDS3231Capture::begin(SquareWave squareWave)
+{
+    uint16_t ticksPerSecond;
+
+    switch (squareWave) {
+        case SquareWave1Hz:     ticksPerSecond = 1;    break;
+        case SquareWave1024Hz:  ticksPerSecond = 1024; break;
+        case SquareWave4096Hz:  ticksPerSecond = 4096; break;
+        case SquareWave8192Hz:  ticksPerSecond = 8192; break;
+        default:
+            return false;
+    }
+
+    if (!_rtc || !_buffer || (_size < 2) || ((ticksPerSecond == 1) && !_clockMicros)) {
+        return false;
+    }
+
+    // Stop capturing during reconfiguration
+#ifdef ARDUINO
+    noInterrupts();
+#endif
+    _ticksPerSecond = 0;
+    _subTicks = 0;
+#ifdef ARDUINO
+    interrupts();
+#endif
+    _anchorValid = false;
+
+    // Discard queued events, the tail is owned by the main loop side
+    _tail = _head;
+
+    if (!_rtc->setSquareWave(squareWave)) {
+        return false;
+    }
+
+    _ticksPerSecond = ticksPerSecond;
+
+    return align();
+}
+
+/*!
+ * \brief SQW tick.
+ * \details
+ *      Call this function from the interrupt handler of the SQW falling edge.
+ */
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+void ErriezDS3231Capture::tick()
+{
+    if (_ticksPerSecond > 1) {
+        if (++_subTicks < _ticksPerSecond) {
+            return;
+        }
+        _subTicks = 0;
+    } else if (_ticksPerSecond) {
+        // The seconds register increments at the 1Hz falling edge
+        _edgeMicros = _clockMicros();
+    }
+
+    _seconds++;
+}
+
+/*!
+ * \brief Capture event timestamp.
+ * \details
+ *      Call this function from the event interrupt handler, with the same or lower priority as
+ *      tick(). Stores the SQW counters in the ring buffer without I2C transfer. The counters are
+ *      sampled again when tick() interrupts the sample.
+ * \param source
+ *      Application defined event source, returned by drain().
+ * \retval true
+ *      Event queued.
+ * \retval false
+ *      Not started or ring buffer full. Lost events are counted by getOverflows().
+ */
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+ICACHE_RAM_ATTR
+#endif
+bool ErriezDS3231Capture::capture(uint8_t source)
+{
+    volatile DS3231CaptureEvent *event;
+    uint32_t sub;
+    uint16_t seconds;
+    uint8_t head = _head;
+    uint8_t next;
+
+    // Sample the time first, again when changed by tick()
+    do {
+        seconds = _seconds;
+        if (_ticksPerSecond > 1) {
+            sub = _subTicks;
+        } else if (_ticksPerSecond) {
+            sub = (uint32_t)(_clockMicros() - _edgeMicros);
+        } else {
+            return false;
+        }
+    } while (seconds != _seconds);
+
+    next = head + 1;
+    if (next >= _size) {
+        next = 0;
+    }
+
+    if (next == _tail) {
+        if (_overflows != 0xFFFF) {
+            _overflows++;
+        }
+        return false;
+    }
+
+    event = &_buffer[head];
+    event->sub = sub;
+    event->seconds = seconds;
+    event->source = source;
+
+    // Publish the event after writing it
+    _head = next;
+
+    return true;
+}
+
+/*!
+ * \brief Get number of queued events.
+ * \return
+ *      Number of events which can be drained.
+ */
+uint8_t ErriezDS3231Capture::available()
+{
+    uint8_t head = _head;
+    uint8_t tail = _tail;
+
+    return (head >= tail) ? (head - tail) : (_size - tail + head);
+}
+
+/*!
+ * \brief Convert queued events to RTC time.
+ * \details
+ *      Reads the date/time registers once and converts up to maxCount queued events relative to
+ *      this anchor. Events remain queued when the register read fails. Events must be drained
+ *      within 9 hours after capturing.
+ *
+ *      A difference between the RTC registers and the SQW seconds counter since the previous
+ *      drain is counted by getMissedEdges(). With 1Hz, the registers are used from then on.
+ *      Above 1Hz, the sub-second ticks are aligned again, which blocks up to 1.1 seconds. Events
+ *      queued before the missed edge are converted with the new anchor.
+ * \param times
+ *      Converted events, oldest first.
+ * \param maxCount
+ *      Number of entries in times.
+ * \return
+ *      Number of converted events.
+ */
+uint8_t ErriezDS3231Capture::drain(DS3231CaptureTime *times, uint8_t maxCount)
+{
+    volatile DS3231CaptureEvent *event;
+    DS3231Timestamp timestamp;
+    DS3231CaptureTime *t;
+    uint16_t seconds;
+    uint32_t epoch;
+    uint8_t tail = _tail;
+    uint8_t count = 0;
+
+    if (!maxCount || (tail == _head)) {
+        return 0;
+    }
+
+    if (!readAnchor(&seconds, &epoch)) {
+        _errors++;
+        return 0;
+    }
+
+    timestamp.ticksPerSecond = _ticksPerSecond;
+
+    while ((tail != _head) && (count < maxCount)) {
+        event = &_buffer[tail];
+        t = &times[count++];
+
+        t->epoch = epoch + (int16_t)(uint16_t)(event->seconds - seconds);
+        if (_ticksPerSecond > 1) {
+            timestamp.ticks = (uint16_t)event->sub;
+            t->micros = ErriezDS3231::timestampMicros(&timestamp);
+        } else {
+            // The local clock may run slightly slower than the RTC
+            t->micros = (event->sub > 999999UL) ? 999999UL : event->sub;
+        }
+        t->source = event->source;
+
+        if (++tail >= _size) {
+            tail = 0;
+        }
+    }
+
+    // Release the entries to the interrupt side
+    _tail = tail;
+
+    return count;
+}
+
+/*!
+ * \brief Get number of lost events.
+ * \return
+ *      Number of events lost because the ring buffer was full, saturates at 65535.
+ */
+uint16_t ErriezDS3231Capture::getOverflows()
+{
+    return _overflows;
+}
+
+/*!
+ * \brief Get number of failed drains.
+ * \return
+ *      Number of drain() calls which could not read the RTC.
+ */
+uint32_t ErriezDS3231Capture::getErrors()
+{
+    return _errors;
+}
+
+/*!
+ * \brief Get number of missed edge detections.
+ * \return
+ *      Number of anchors which did not match the SQW seconds counter, caused by missed SQW edges
+ *      or writing the RTC date/time.
+ */
+uint32_t ErriezDS3231Capture::getMissedEdges()
+{
+    return _missedEdges;
+}
+
+/*!
+ * \brief Read SQW seconds counter without disabling interrupts.
+ * \return
+ *      SQW seconds counter.
+ */
+uint16_t ErriezDS3231Capture::readSeconds()
+{
+    uint16_t seconds;
+
+    // Read again when the multi-byte value was changed by the interrupt handler
+    do {
+        seconds = _seconds;
+    } while (seconds != _seconds);
+
+    return seconds;
+}
+
+/*!
+ * \brief Read the date/time registers with the matching SQW seconds counter.
+ * \details
+ *      Above 1Hz, the alignment of the sub-second ticks is accurate to one register read. A
+ *      difference of one second with the previous anchor close to the start of the second is
+ *      therefore not counted as missed edge.
+ * \param seconds
+ *      SQW seconds counter.
+ * \param epoch
+ *      RTC epoch at the start of this SQW second.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read or alignment failed.
+ */
+bool ErriezDS3231Capture::readAnchor(uint16_t *seconds, uint32_t *epoch)
+{
+    uint8_t buffer[7];
+    uint16_t guard = (_ticksPerSecond >> 9) + 1;
+    uint16_t sec;
+    uint16_t sub;
+    int16_t diff;
+    time_t t;
+
+    if (!_anchorValid && !align()) {
+        return false;
+    }
+
+    for (uint8_t retry = 0; retry < 3; retry++) {
+        // Read seconds and sub-second ticks of the same second
+        do {
+            sec = _seconds;
+            sub = _subTicks;
+        } while (sec != _seconds);
+
+        // Read date/time registers
+        if (!_rtc->readBuffer(0x00, buffer, sizeof(buffer)) ||
+            !ErriezDS3231::decodeEpochRegisters(buffer, &t)) {
+            return false;
+        }
+
+        // Retry when an SQW second started during the register read
+        if (sec != readSeconds()) {
+            continue;
+        }
+
+        // Compare elapsed seconds with the previous anchor, modulo 2^16 seconds
+        diff = (int16_t)((uint16_t)(sec - _anchorSeconds) -
+                         (uint16_t)((uint32_t)t - _anchorEpoch));
+        if (diff) {
+            if ((_ticksPerSecond > 1) && ((diff == 1) || (diff == -1)) &&
+                ((sub < guard) || (sub >= (_ticksPerSecond - guard)))) {
+                // Register read at the start of the second
+                t += diff;
+            } else {
+                _missedEdges++;
+
+                // Missed edges above 1Hz invalidate the phase of the second
+                if (_ticksPerSecond > 1) {
+                    if (!align()) {
+                        return false;
+                    }
+                    *seconds = _anchorSeconds;
+                    *epoch = _anchorEpoch;
+                    return true;
+                }
+            }
+        }
+
+        _anchorSeconds = sec;
+        _anchorEpoch = (uint32_t)t;
+        *seconds = sec;
+        *epoch = (uint32_t)t;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Align the SQW counters with the seconds register.
+ * \details
+ *      Restarts the sub-second ticks at the start of the second and stores the anchor. Blocks up
+ *      to 1.1 seconds.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read failed or no SQW ticks detected.
+ */
+bool ErriezDS3231Capture::align()
+{
+    uint16_t seconds;
+    time_t t;
+
+    _anchorValid = false;
+
+    if (!_rtc->alignSecond(&_seconds, (_ticksPerSecond > 1) ? &_subTicks : NULL, &seconds, &t)) {
+        return false;
+    }
+
+    _anchorSeconds = seconds;
+    _anchorEpoch = (uint32_t)t;
+    _anchorValid = true;
+
+    return true;
+}
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Capture.h
+ * \brief DS3231 high precision RTC library for Arduino: ISR-safe event timestamp capture
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_CAPTURE_H_
+#define ERRIEZ_DS3231_CAPTURE_H_
+
+#include "ErriezDS3231.h"
+
+/*!
+ * \brief Raw event, stored by the interrupt handler
+ */
+typedef struct {
+    uint32_t sub;               //!< SQW ticks in the second, or us since the 1Hz SQW edge
+    uint16_t seconds;           //!< SQW seconds counter
+    uint8_t source;             //!< Application event source
+} DS3231CaptureEvent;
+
+/*!
+ * \brief Event with absolute RTC time
+ */
+typedef struct {
+    uint32_t epoch;             //!< Unix epoch seconds since 1970
+    uint32_t micros;            //!< Microseconds since the start of the second 0..999999
+    uint8_t source;             //!< Application event source
+} DS3231CaptureTime;
+
+/*!
+ * \brief ISR-safe event timestamp capture
+ * \details
+ *      The interrupt side consists of tick(), called from the SQW falling edge interrupt, and
+ *      capture(), called from the event interrupt. capture() stores the SQW seconds counter and
+ *      the SQW ticks or micros() offset in a lock-free single-producer/single-consumer ring
+ *      buffer, without I2C transfer.
+ *
+ *      The main loop calls drain(), which reads the date/time registers once per batch together
+ *      with the seconds counter and converts all queued events to absolute RTC time.
+ *
+ *      With 1Hz, the seconds register increments at the SQW falling edge and the sub-second
+ *      resolution is that of micros(). With 1024, 4096 or 8192Hz the resolution is one SQW
+ *      period and begin() aligns the ticks with the seconds register, which blocks up to one
+ *      second. capture() must be called from interrupts with the same or lower priority as
+ *      tick(), on the same core as drain(): tick() may interrupt capture(), but capture() must
+ *      not interrupt tick().
+ */
+class ErriezDS3231Capture
+{
+public:
+    ErriezDS3231Capture(ErriezDS3231 *rtc, DS3231CaptureEvent *buffer, uint8_t size,
+                        unsigned long (*clockMicros)(void));
+
+    bool begin(SquareWave squareWave=SquareWave1Hz);
+
+    // Interrupt side
+    void tick();
+    bool capture(uint8_t source=0);
+
+    // Main loop side
+    uint8_t available();
+    uint8_t drain(DS3231CaptureTime *times, uint8_t maxCount);
+    uint16_t getOverflows();
+    uint32_t getErrors();
+    uint32_t getMissedEdges();
+
+private:
+    ErriezDS3231 *_rtc;                     //!< RTC
+    volatile DS3231CaptureEvent *_buffer;   //!< Ring buffer
+    uint8_t _size;                          //!< Ring buffer size, one entry is kept free
+    unsigned long (*_clockMicros)(void);    //!< Local clock for 1Hz SQW
+
+    volatile uint8_t _head;                 //!< Next write index, written by the ISR side
+    volatile uint8_t _tail;                 //!< Next read index, written by the main side
+    volatile uint16_t _overflows;           //!< Events lost because the buffer was full
+
+    volatile uint16_t _seconds;             //!< SQW seconds counter
+    volatile uint16_t _subTicks;            //!< SQW ticks since the start of the second
+    volatile unsigned long _edgeMicros;     //!< Local clock at the start of the second
+    uint16_t _ticksPerSecond;               //!< SQW frequency
+
+    bool _anchorValid;                      //!< Previous anchor valid
+    uint16_t _anchorSeconds;                //!< Seconds counter of the previous anchor
+    uint32_t _anchorEpoch;                  //!< Epoch of the previous anchor
+    uint32_t _errors;                       //!< Failed register reads
+    uint32_t _missedEdges;                  //!< Anchors which detected missed SQW edges
+
+    uint16_t readSeconds();
+    bool readAnchor(uint16_t *seconds, uint32_t *epoch);
+    bool align();
+};
+
+#endif // ERRIEZ_DS3231_CAPTURE_H_
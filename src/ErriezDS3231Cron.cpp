@@ -0,0 +1,530 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Cron.cpp
+ * \brief DS3231 high precision RTC library for Arduino: cron schedules on alarm 2
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Cron.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Cron::ErriezDS3231Cron(ErriezDS3231 *rtc) :
+    _rtc(rtc), _wdays(0), _mdayAll(true), _wdayAll(true), _valid(false), _persistent(false),
+    _alarmType(Alarm2MatchDate), _alarmDayDate(0), _alarmHour(0), _alarmMinute(0),
+    _matches(0), _spurious(0)
+{
+    memset(_minutes, 0, sizeof(_minutes));
+    memset(_hours, 0, sizeof(_hours));
+    memset(_mdays, 0, sizeof(_mdays));
+    memset(_months, 0, sizeof(_months));
+}
+
+/*!
+ * \brief Parse cron expression.
+ * \param expr
+ *      Expression "minute hour day-of-month month day-of-week", for example "0-59/15 * * * 1-5"
+ *      for every 15 minutes on weekdays or "30 3 1 * *" for 03:30 on the 1st of each month.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Syntax error or value out of range.
+ */
+bool ErriezDS3231Cron::parse(const char *expr)
+{
+    bool all;
+
+    memset(_minutes, 0, sizeof(_minutes));
+    memset(_hours, 0, sizeof(_hours));
+    memset(_mdays, 0, sizeof(_mdays));
+    memset(_months, 0, sizeof(_months));
+    _wdays = 0;
+    _valid = false;
+
+    if (!parseField(&expr, _minutes, 0, 59, &all) ||
+        !parseField(&expr, _hours, 0, 23, &all) ||
+        !parseField(&expr, _mdays, 1, 31, &_mdayAll) ||
+        !parseField(&expr, _months, 1, 12, &all) ||
+        !parseField(&expr, &_wdays, 0, 7, &_wdayAll)) {
+        return false;
+    }
+
+    // Trailing characters
+    while (*expr == ' ') {
+        expr++;
+    }
+    if (*expr != '\0') {
+        return false;
+    }
+
+    // Day of the week 7 is Sunday
+    if (_wdays & 0x80) {
+        _wdays = (_wdays | 0x01) & 0x7F;
+    }
+
+    _valid = true;
+    selectAlarm();
+
+    return true;
+}
+
+/*!
+ * \brief Check if a time matches the schedule.
+ * \param epoch
+ *      Unix epoch, seconds are ignored.
+ * \retval true
+ *      Match.
+ * \retval false
+ *      No match or no valid expression.
+ */
+bool ErriezDS3231Cron::matches(uint32_t epoch)
+{
+    uint16_t days = (uint16_t)(epoch / 86400UL);
+    uint32_t secs = epoch % 86400UL;
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+
+    if (!_valid) {
+        return false;
+    }
+
+    ErriezDS3231::civilFromDays(days, &year, &mon, &mday);
+
+    return testBit(_minutes, (secs / 60) % 60) && testBit(_hours, secs / 3600) &&
+           dayMatches(mon, mday, ErriezDS3231::weekdayFromDays(days));
+}
+
+/*!
+ * \brief Calculate next fire time.
+ * \param after
+ *      Unix epoch, the result is later than this time.
+ * \param next
+ *      Next fire time at seconds 00.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      No valid expression or no match within 4 years or before 2100.
+ */
+bool ErriezDS3231Cron::nextFire(uint32_t after, uint32_t *next)
+{
+    uint32_t t = after - (after % 60) + 60;
+    uint16_t days = (uint16_t)(t / 86400UL);
+    uint16_t minuteOfDay = (uint16_t)((t % 86400UL) / 60);
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+    uint8_t minute;
+
+    if (!_valid) {
+        return false;
+    }
+
+    for (uint16_t n = 0; n < DS3231_CRON_SEARCH_DAYS; n++, days++, minuteOfDay = 0) {
+        ErriezDS3231::civilFromDays(days, &year, &mon, &mday);
+        if (year > 2099) {
+            return false;
+        }
+        if (!dayMatches(mon, mday, ErriezDS3231::weekdayFromDays(days))) {
+            continue;
+        }
+
+        // First matching hour and minute on this day
+        for (uint8_t hour = minuteOfDay / 60; hour < 24; hour++) {
+            if (!testBit(_hours, hour)) {
+                continue;
+            }
+            minute = (hour == (minuteOfDay / 60)) ? (minuteOfDay % 60) : 0;
+            for (; minute < 60; minute++) {
+                if (testBit(_minutes, minute)) {
+                    *next = days * 86400UL + hour * 3600UL + minute * 60U;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Check if alarm 2 is programmed once.
+ * \retval true
+ *      The schedule is exactly an alarm 2 match mode.
+ * \retval false
+ *      Alarm 2 is programmed after every match.
+ */
+bool ErriezDS3231Cron::isPersistent()
+{
+    return _persistent;
+}
+
+/*!
+ * \brief Get alarm 2 match mode.
+ * \return
+ *      Match mode of a persistent schedule, otherwise Alarm2MatchDate.
+ */
+Alarm2Type ErriezDS3231Cron::getAlarmType()
+{
+    return _alarmType;
+}
+
+/*!
+ * \brief Program alarm 2 and enable the alarm 2 interrupt.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      No valid expression, no next fire time or I2C transfer failed.
+ */
+bool ErriezDS3231Cron::begin()
+{
+    uint32_t now;
+
+    if (!_valid) {
+        return false;
+    }
+
+    now = (uint32_t)_rtc->getEpoch();
+    if (!now || !arm(now)) {
+        return false;
+    }
+
+    return _rtc->alarmInterruptEnable(Alarm2, true);
+}
+
+/*!
+ * \brief Handle alarm 2 interrupt.
+ * \details
+ *      Checks the current minute against the schedule, programs the next fire time when the
+ *      schedule is not persistent and clears the alarm 2 flag. A persistent schedule only
+ *      clears the alarm 2 flag.
+ * \param matched
+ *      true: The current minute matches the schedule. false: Spurious wakeup.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C transfer failed.
+ */
+bool ErriezDS3231Cron::service(bool *matched)
+{
+    uint32_t now = (uint32_t)_rtc->getEpoch();
+
+    *matched = false;
+    if (!now) {
+        return false;
+    }
+
+    if (matches(now)) {
+        *matched = true;
+        _matches++;
+    } else {
+        _spurious++;
+    }
+
+    if (_persistent) {
+        // Alarm 2 registers are programmed once by begin()
+        return _rtc->clearAlarmFlag(Alarm2);
+    }
+
+    return arm(now);
+}
+
+/*!
+ * \brief Get number of matching alarm 2 interrupts.
+ * \return
+ *      Number of matches.
+ */
+uint32_t ErriezDS3231Cron::getMatches()
+{
+    return _matches;
+}
+
+/*!
+ * \brief Get number of alarm 2 interrupts without a schedule match.
+ * \return
+ *      Number of spurious wakeups.
+ */
+uint32_t ErriezDS3231Cron::getSpuriousWakeups()
+{
+    return _spurious;
+}
+
+/*!
+ * \brief Parse one field of the expression.
+ * \param expr
+ *      Expression pointer, moved to the end of the field.
+ * \param map
+ *      Bit map, bit n is set when value n matches.
+ * \param min
+ *      Minimum value.
+ * \param max
+ *      Maximum value.
+ * \param all
+ *      Set when the field is '*'.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Syntax error or value out of range.
+ */
+bool ErriezDS3231Cron::parseField(const char **expr, uint8_t *map, uint8_t min, uint8_t max,
+                                  bool *all)
+{
+    const char *p = *expr;
+    uint8_t first;
+    uint8_t last;
+    uint8_t step;
+
+    while (*p == ' ') {
+        p++;
+    }
+
+    *all = (p[0] == '*') && ((p[1] == ' ') || (p[1] == '\0'));
+
+    do {
+        // Range: '*', 'a' or 'a-b'
+        if (*p == '*') {
+            p++;
+            first = min;
+            last = max;
+        } else {
+            if (!parseNumber(&p, &first)) {
+                return false;
+            }
+            last = first;
+            if (*p == '-') {
+                p++;
+                if (!parseNumber(&p, &last)) {
+                    return false;
+                }
+            }
+        }
+
+        // Optional step '/n'
+        step = 1;
+        if (*p == '/') {
+            p++;
+            if (!parseNumber(&p, &step) || (step == 0)) {
+                return false;
+            }
+        }
+
+        if ((first < min) || (last > max) || (first > last)) {
+            return false;
+        }
+
+        for (uint16_t v = first; v <= last; v += step) {
+            map[v / 8] |= (1 << (v % 8));
+        }
+    } while ((*p == ',') && p++);
+
+    // Field must end with a space or the end of the expression
+    if ((*p != ' ') && (*p != '\0')) {
+        return false;
+    }
+
+    *expr = p;
+
+    return true;
+}
+
+/*!
+ * \brief Parse decimal number.
+ * \param expr
+ *      Expression pointer, moved after the number.
+ * \param value
+ *      Number 0..255.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      No digits or value out of range.
+ */
+bool ErriezDS3231Cron::parseNumber(const char **expr, uint8_t *value)
+{
+    const char *p = *expr;
+    uint16_t v = 0;
+
+    if ((*p < '0') || (*p > '9')) {
+        return false;
+    }
+
+    while ((*p >= '0') && (*p <= '9')) {
+        v = v * 10 + (*p++ - '0');
+        if (v > 255) {
+            return false;
+        }
+    }
+
+    *value = (uint8_t)v;
+    *expr = p;
+
+    return true;
+}
+
+/*!
+ * \brief Test bit in bit map.
+ * \param map
+ *      Bit map.
+ * \param bit
+ *      Bit number.
+ * \return
+ *      Bit value.
+ */
+bool ErriezDS3231Cron::testBit(const uint8_t *map, uint8_t bit)
+{
+    return map[bit / 8] & (1 << (bit % 8));
+}
+
+/*!
+ * \brief Count bits in bit map.
+ * \param map
+ *      Bit map.
+ * \param min
+ *      First bit.
+ * \param max
+ *      Last bit.
+ * \param first
+ *      First bit set.
+ * \return
+ *      Number of bits set.
+ */
+uint8_t ErriezDS3231Cron::countBits(const uint8_t *map, uint8_t min, uint8_t max, uint8_t *first)
+{
+    uint8_t n = 0;
+
+    for (uint8_t bit = max + 1; bit-- > min;) {
+        if (testBit(map, bit)) {
+            *first = bit;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/*!
+ * \brief Check month and day against the schedule.
+ * \param mon
+ *      Month 1..12.
+ * \param mday
+ *      Day of the month 1..31.
+ * \param wday
+ *      Day of the week 0..6 (0=Sunday).
+ * \retval true
+ *      Match.
+ */
+bool ErriezDS3231Cron::dayMatches(uint8_t mon, uint8_t mday, uint8_t wday)
+{
+    bool mdayMatch = testBit(_mdays, mday);
+    bool wdayMatch = _wdays & (1 << wday);
+
+    if (!testBit(_months, mon)) {
+        return false;
+    }
+
+    // Both restricted: either matches
+    if (!_mdayAll && !_wdayAll) {
+        return mdayMatch || wdayMatch;
+    }
+
+    return mdayMatch && wdayMatch;
+}
+
+/*!
+ * \brief Select the coarsest alarm 2 match mode which fires exactly at the schedule.
+ */
+void ErriezDS3231Cron::selectAlarm()
+{
+    uint8_t mday = 0;
+    uint8_t wday = 0;
+    uint8_t mon;
+    uint8_t minutes = countBits(_minutes, 0, 59, &_alarmMinute);
+    uint8_t hours = countBits(_hours, 0, 23, &_alarmHour);
+    uint8_t mdays = countBits(_mdays, 1, 31, &mday);
+    uint8_t months = countBits(_months, 1, 12, &mon);
+    uint8_t wdays = countBits(&_wdays, 0, 6, &wday);
+    bool allDays = (months == 12) && (mdays == 31) && (wdays == 7);
+
+    _persistent = true;
+
+    if ((minutes == 60) && (hours == 24) && allDays) {
+        _alarmType = Alarm2EveryMinute;
+    } else if ((minutes == 1) && (hours == 24) && allDays) {
+        _alarmType = Alarm2MatchMinutes;
+    } else if ((minutes == 1) && (hours == 1) && allDays) {
+        _alarmType = Alarm2MatchHours;
+    } else if ((minutes == 1) && (hours == 1) && (months == 12) && _mdayAll && (wdays == 1)) {
+        // DS3231 day of the week register 1..7 is tm_wday + 1
+        _alarmDayDate = wday + 1;
+        _alarmType = Alarm2MatchDay;
+    } else if ((minutes == 1) && (hours == 1) && (months == 12) && _wdayAll && (mdays == 1)) {
+        _alarmDayDate = mday;
+        _alarmType = Alarm2MatchDate;
+    } else {
+        // Program the next fire time after every match
+        _alarmType = Alarm2MatchDate;
+        _persistent = false;
+    }
+}
+
+/*!
+ * \brief Program alarm 2.
+ * \param now
+ *      Current Unix epoch.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      No next fire time, alarm 2 interrupt disabled, or I2C transfer failed.
+ */
+bool ErriezDS3231Cron::arm(uint32_t now)
+{
+    uint32_t next;
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+
+    if (_persistent) {
+        // Also clears the alarm 2 flag
+        return _rtc->setAlarm2(_alarmType, _alarmDayDate, _alarmHour, _alarmMinute);
+    }
+
+    if (!nextFire(now, &next)) {
+        // Schedule expired: release the INT/SQW pin
+        _rtc->alarmInterruptEnable(Alarm2, false);
+        _rtc->clearAlarmFlag(Alarm2);
+        return false;
+    }
+
+    ErriezDS3231::civilFromDays((uint16_t)(next / 86400UL), &year, &mon, &mday);
+
+    return _rtc->setAlarm2(Alarm2MatchDate, mday, (next / 3600UL) % 24, (next / 60) % 60);
+}
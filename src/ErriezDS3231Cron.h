@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Cron.h
+ * \brief DS3231 high precision RTC library for Arduino: cron schedules on alarm 2
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_CRON_H_
+#define ERRIEZ_DS3231_CRON_H_
+
+#include "ErriezDS3231.h"
+
+//! Number of days searched for the next fire time: today and 4 years for 29 February
+#define DS3231_CRON_SEARCH_DAYS     (4 * 365 + 2)
+
+/*!
+ * \brief Cron-style recurring schedule on alarm 2
+ * \details
+ *      Parses a 5-field cron expression "minute hour day-of-month month day-of-week" with
+ *      numbers, '*', ranges 'a-b', steps '/n' and lists 'a,b'. Day of the week 0..7, 0 and 7
+ *      are Sunday. When day-of-month and day-of-week are both restricted, either matches.
+ *
+ *      When the schedule is exactly an alarm 2 match mode, such as "30 3 1 * *" for
+ *      Alarm2MatchDate, alarm 2 is programmed once. Otherwise, alarm 2 is programmed with the
+ *      next fire time after every match, so the MCU only wakes for real matches. A schedule
+ *      more than a month ahead fires early on the same date and is counted as spurious wakeup.
+ */
+class ErriezDS3231Cron
+{
+public:
+    explicit ErriezDS3231Cron(ErriezDS3231 *rtc);
+
+    bool parse(const char *expr);
+    bool matches(uint32_t epoch);
+    bool nextFire(uint32_t after, uint32_t *next);
+    bool isPersistent();
+    Alarm2Type getAlarmType();
+
+    // Program alarm 2 and handle alarm 2 interrupts
+    bool begin();
+    bool service(bool *matched);
+
+    // Statistics
+    uint32_t getMatches();
+    uint32_t getSpuriousWakeups();
+
+private:
+    ErriezDS3231 *_rtc;         //!< RTC object
+    uint8_t _minutes[8];        //!< Bit n: minute n matches
+    uint8_t _hours[3];          //!< Bit n: hour n matches
+    uint8_t _mdays[4];          //!< Bit n: day of the month n matches
+    uint8_t _months[2];         //!< Bit n: month n matches
+    uint8_t _wdays;             //!< Bit n: day of the week n matches (0=Sunday)
+    bool _mdayAll;              //!< Day of the month is '*'
+    bool _wdayAll;              //!< Day of the week is '*'
+    bool _valid;                //!< Expression parsed
+    bool _persistent;           //!< Alarm 2 programmed once
+    Alarm2Type _alarmType;      //!< Alarm 2 match mode
+    uint8_t _alarmDayDate;      //!< Alarm 2 day or date of a persistent alarm
+    uint8_t _alarmHour;         //!< Alarm 2 hour of a persistent alarm
+    uint8_t _alarmMinute;       //!< Alarm 2 minute of a persistent alarm
+    uint32_t _matches;          //!< Number of matching alarm 2 interrupts
+    uint32_t _spurious;         //!< Number of alarm 2 interrupts without match
+
+    static bool parseField(const char **expr, uint8_t *map, uint8_t min, uint8_t max,
+                           bool *all);
+    static bool parseNumber(const char **expr, uint8_t *value);
+    static bool testBit(const uint8_t *map, uint8_t bit);
+    static uint8_t countBits(const uint8_t *map, uint8_t min, uint8_t max, uint8_t *first);
+    bool dayMatches(uint8_t mon, uint8_t mday, uint8_t wday);
+    void selectAlarm();
+    bool arm(uint32_t now);
+};
+
+#endif // ERRIEZ_DS3231_CRON_H_
@@ -0,0 +1,318 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Drift.cpp
+ * \brief DS3231 high precision RTC library for Arduino: temperature drift compensation
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Drift.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Drift::ErriezDS3231Drift(ErriezDS3231 *rtc) :
+    _rtc(rtc), _lastEpoch(0), _lastTemperature(0), _synced(false),
+    _baseMicros(0), _driftMicros(0), _driftNanos(0)
+{
+    resetModel();
+}
+
+/*!
+ * \brief Add temperature measurement.
+ * \details
+ *      Call after every temperature measurement, for example every 64 seconds. The time since
+ *      the previous call is accounted to the previous temperature.
+ * \param epoch
+ *      RTC epoch of the measurement.
+ * \param centiDegrees
+ *      Temperature in 0.01 degree Celsius, see ErriezDS3231TempMonitor.
+ */
+void ErriezDS3231Drift::update(uint32_t epoch, int16_t centiDegrees)
+{
+    integrate(epoch);
+
+    _lastEpoch = epoch;
+    _lastTemperature = centiDegrees;
+}
+
+/*!
+ * \brief Add offset to an external time reference and fit the model.
+ * \details
+ *      The drift since the previous sync is compared to the prediction of the model. The error
+ *      is distributed over the bins visited since the previous sync, in proportion to the time
+ *      spent in each bin (normalized least mean squares). A bin visited for the whole interval
+ *      is set to the measured frequency error on its first fit and averaged afterwards.
+ * \param epoch
+ *      RTC epoch of the offset measurement.
+ * \param offsetMicros
+ *      RTC time minus reference time in us, positive: RTC ahead.
+ * \param rtcCorrected
+ *      true: The RTC was set to the reference time after the measurement.
+ */
+void ErriezDS3231Drift::sync(uint32_t epoch, int32_t offsetMicros, bool rtcCorrected)
+{
+    int16_t start[DS3231_DRIFT_BINS];
+    int64_t sumSquares = 0;
+    int64_t errorNanos;
+    int32_t ppb;
+    uint8_t average;
+    uint8_t bin;
+
+    integrate(epoch);
+    _lastEpoch = epoch;
+
+    if (_synced) {
+        for (bin = 0; bin < DS3231_DRIFT_BINS; bin++) {
+            sumSquares += (int64_t)_binSeconds[bin] * _binSeconds[bin];
+            start[bin] = binPpb(bin);
+        }
+
+        // Measured minus predicted drift in ns
+        errorNanos = ((int64_t)offsetMicros - _baseMicros - _driftMicros) * 1000 - _driftNanos;
+
+        for (bin = 0; (bin < DS3231_DRIFT_BINS) && sumSquares; bin++) {
+            if (!_binSeconds[bin]) {
+                continue;
+            }
+
+            average = _model.weight[bin] + 1;
+            if (average > DS3231_DRIFT_AVERAGE_MAX) {
+                average = DS3231_DRIFT_AVERAGE_MAX;
+            }
+
+            // Unfitted bins start from the neighbour prediction
+            ppb = start[bin];
+            ppb += (int32_t)((errorNanos * _binSeconds[bin]) / (sumSquares * average));
+            if (ppb > 32767) {
+                ppb = 32767;
+            } else if (ppb < -32767) {
+                ppb = -32767;
+            }
+            _model.ppb[bin] = (int16_t)ppb;
+
+            if (_model.weight[bin] < 255) {
+                _model.weight[bin]++;
+            }
+        }
+    }
+
+    // Start next interval
+    memset(_binSeconds, 0, sizeof(_binSeconds));
+    _baseMicros = rtcCorrected ? 0 : offsetMicros;
+    _driftMicros = 0;
+    _driftNanos = 0;
+    _synced = true;
+}
+
+/*!
+ * \brief Get predicted RTC offset to the reference time.
+ * \param epoch
+ *      Current RTC epoch.
+ * \return
+ *      RTC time minus reference time in us, positive: RTC ahead. 0 before the first sync.
+ */
+int32_t ErriezDS3231Drift::getOffsetMicros(uint32_t epoch)
+{
+    int32_t micros = _baseMicros + _driftMicros;
+
+    if (!_synced) {
+        return 0;
+    }
+
+    // Extrapolate with the last temperature
+    if (_lastEpoch && (epoch > _lastEpoch)) {
+        micros += (int32_t)(((int64_t)(epoch - _lastEpoch) * getPpb(_lastTemperature)) / 1000);
+    }
+
+    return micros;
+}
+
+/*!
+ * \brief Read RTC epoch corrected by the predicted offset.
+ * \param epoch
+ *      Corrected Unix epoch.
+ * \param milliseconds
+ *      Corrected milliseconds 0..999 since the start of the RTC second.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read failed.
+ */
+bool ErriezDS3231Drift::getEpoch(uint32_t *epoch, uint16_t *milliseconds)
+{
+    uint32_t t = (uint32_t)_rtc->getEpoch();
+    int32_t offset;
+    int32_t ms;
+
+    if (!t) {
+        return false;
+    }
+
+    // Subtract offset from the start of the RTC second
+    offset = getOffsetMicros(t) / 1000;
+    ms = -(offset % 1000);
+    t -= offset / 1000;
+    if (ms < 0) {
+        ms += 1000;
+        t--;
+    }
+
+    *epoch = t;
+    *milliseconds = (uint16_t)ms;
+
+    return true;
+}
+
+/*!
+ * \brief Get drift model, for example to store it in EEPROM.
+ * \return
+ *      Model of sizeof(DS3231DriftModel) bytes.
+ */
+const DS3231DriftModel *ErriezDS3231Drift::getModel()
+{
+    return &_model;
+}
+
+/*!
+ * \brief Set drift model, for example loaded from EEPROM.
+ * \param model
+ *      Model.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Unsupported model version, model not changed.
+ */
+bool ErriezDS3231Drift::setModel(const DS3231DriftModel *model)
+{
+    if (model->version != DS3231_DRIFT_VERSION) {
+        return false;
+    }
+
+    memcpy(&_model, model, sizeof(_model));
+
+    return true;
+}
+
+/*!
+ * \brief Clear drift model.
+ */
+void ErriezDS3231Drift::resetModel()
+{
+    memset(&_model, 0, sizeof(_model));
+    _model.version = DS3231_DRIFT_VERSION;
+}
+
+/*!
+ * \brief Get frequency error of the model at a temperature.
+ * \param centiDegrees
+ *      Temperature in 0.01 degree Celsius.
+ * \return
+ *      Frequency error in ppb, positive: RTC runs fast.
+ */
+int16_t ErriezDS3231Drift::getPpb(int16_t centiDegrees)
+{
+    return binPpb(binIndex(centiDegrees));
+}
+
+/*!
+ * \brief Get temperature bin.
+ * \param centiDegrees
+ *      Temperature in 0.01 degree Celsius.
+ * \return
+ *      Bin 0..DS3231_DRIFT_BINS-1, temperatures out of range use the first or last bin.
+ */
+uint8_t ErriezDS3231Drift::binIndex(int16_t centiDegrees)
+{
+    int16_t bin = (centiDegrees - DS3231_DRIFT_BIN_MIN) / DS3231_DRIFT_BIN_WIDTH;
+
+    if (centiDegrees < DS3231_DRIFT_BIN_MIN) {
+        return 0;
+    } else if (bin >= DS3231_DRIFT_BINS) {
+        return DS3231_DRIFT_BINS - 1;
+    }
+
+    return (uint8_t)bin;
+}
+
+/*!
+ * \brief Get frequency error of a bin.
+ * \details
+ *      Bins without fit use the nearest fitted bin.
+ * \param bin
+ *      Bin 0..DS3231_DRIFT_BINS-1.
+ * \return
+ *      Frequency error in ppb, 0 without fitted bins.
+ */
+int16_t ErriezDS3231Drift::binPpb(uint8_t bin)
+{
+    if (_model.weight[bin]) {
+        return _model.ppb[bin];
+    }
+
+    for (uint8_t distance = 1; distance < DS3231_DRIFT_BINS; distance++) {
+        if ((bin >= distance) && _model.weight[bin - distance]) {
+            return _model.ppb[bin - distance];
+        }
+        if (((bin + distance) < DS3231_DRIFT_BINS) && _model.weight[bin + distance]) {
+            return _model.ppb[bin + distance];
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * \brief Account the time since the last update to the last temperature bin.
+ * \param epoch
+ *      RTC epoch.
+ */
+void ErriezDS3231Drift::integrate(uint32_t epoch)
+{
+    uint32_t seconds;
+    int64_t drift;
+    uint8_t bin;
+
+    if (!_lastEpoch || (epoch <= _lastEpoch)) {
+        return;
+    }
+
+    seconds = epoch - _lastEpoch;
+    bin = binIndex(_lastTemperature);
+    _binSeconds[bin] += seconds;
+
+    // Predicted drift: seconds * ppb = ns
+    drift = (int64_t)seconds * getPpb(_lastTemperature);
+    _driftMicros += (int32_t)(drift / 1000);
+    _driftNanos += (int32_t)(drift % 1000);
+    _driftMicros += _driftNanos / 1000;
+    _driftNanos %= 1000;
+}
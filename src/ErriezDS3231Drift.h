@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Drift.h
+ * \brief DS3231 high precision RTC library for Arduino: temperature drift compensation
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_DRIFT_H_
+#define ERRIEZ_DS3231_DRIFT_H_
+
+#include "ErriezDS3231.h"
+
+//! Number of temperature bins
+#define DS3231_DRIFT_BINS           12
+
+//! Lower limit of the first temperature bin in 0.01 degree Celsius
+#define DS3231_DRIFT_BIN_MIN        -1000
+
+//! Width of a temperature bin in 0.01 degree Celsius
+#define DS3231_DRIFT_BIN_WIDTH      500
+
+//! Maximum averaging of a bin: new fits contribute at least 1/8
+#define DS3231_DRIFT_AVERAGE_MAX    8
+
+//! Model format version
+#define DS3231_DRIFT_VERSION        1
+
+/*!
+ * \brief Drift model, 38 bytes which can be stored in EEPROM
+ */
+typedef struct {
+    uint8_t version;                        //!< DS3231_DRIFT_VERSION
+    uint8_t reserved;                       //!< Reserved, 0
+    int16_t ppb[DS3231_DRIFT_BINS];         //!< Frequency error per bin in ppb, positive: fast
+    uint8_t weight[DS3231_DRIFT_BINS];      //!< Number of fits per bin, saturates at 255
+} DS3231DriftModel;
+
+/*!
+ * \brief Temperature-aware drift compensation of the RTC time
+ * \details
+ *      Bins of 5 degree Celsius from -10 to +50 degree Celsius store the residual frequency
+ *      error of the RTC. update() accumulates the time spent in each bin and the predicted
+ *      drift. sync() compares the offset to an external time reference with the prediction and
+ *      fits the bins visited since the previous sync, weighted by the time spent in them.
+ *      getEpoch() returns the RTC time corrected by the predicted offset with millisecond
+ *      resolution. Integer arithmetic only.
+ */
+class ErriezDS3231Drift
+{
+public:
+    explicit ErriezDS3231Drift(ErriezDS3231 *rtc);
+
+    // Temperature and reference input
+    void update(uint32_t epoch, int16_t centiDegrees);
+    void sync(uint32_t epoch, int32_t offsetMicros, bool rtcCorrected=false);
+
+    // Corrected time
+    int32_t getOffsetMicros(uint32_t epoch);
+    bool getEpoch(uint32_t *epoch, uint16_t *milliseconds);
+
+    // Model
+    const DS3231DriftModel *getModel();
+    bool setModel(const DS3231DriftModel *model);
+    void resetModel();
+    int16_t getPpb(int16_t centiDegrees);
+
+private:
+    ErriezDS3231 *_rtc;                     //!< RTC object
+    DS3231DriftModel _model;                //!< Drift model
+    uint32_t _binSeconds[DS3231_DRIFT_BINS];//!< Seconds per bin since the last sync
+    uint32_t _lastEpoch;                    //!< RTC epoch of the last update, 0: none
+    int16_t _lastTemperature;               //!< Temperature of the last update
+    bool _synced;                           //!< Reference offset known
+    int32_t _baseMicros;                    //!< RTC offset to the reference at the last sync
+    int32_t _driftMicros;                   //!< Predicted drift since the last sync
+    int32_t _driftNanos;                    //!< Predicted drift remainder
+
+    static uint8_t binIndex(int16_t centiDegrees);
+    int16_t binPpb(uint8_t bin);
+    void integrate(uint32_t epoch);
+};
+
+#endif // ERRIEZ_DS3231_DRIFT_H_
@@ -0,0 +1,640 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Fleet.cpp
+ * \brief DS3231 high precision RTC library for Arduino: multiple RTCs behind a TCA9548A mux
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Fleet.h"
+
+/*!
+ * \brief Constructor.
+ * \details
+ *      The selected channel is unknown until the first select().
+ * \param bus
+ *      Upstream bus transport, for example ErriezDS3231WireTransport.
+ * \param addr
+ *      Mux 7-bit I2C address 0x70..0x77.
+ */
+ErriezDS3231Mux::ErriezDS3231Mux(ErriezDS3231Transport *bus, uint8_t addr) :
+    _bus(bus), _addr(addr), _channel(DS3231_MUX_UNKNOWN), _switches(0)
+{
+}
+
+/*!
+ * \brief Select a channel.
+ * \details
+ *      Writes the control register only when another channel is selected.
+ * \param channel
+ *      Channel 0..7 or DS3231_MUX_NONE to disconnect all channels.
+ * \retval true
+ *      Channel selected.
+ * \retval false
+ *      Invalid channel or mux not acknowledged.
+ */
+bool ErriezDS3231Mux::select(uint8_t channel)
+{
+    uint8_t control;
+
+    if (channel == _channel) {
+        return true;
+    }
+
+    if (channel == DS3231_MUX_NONE) {
+        control = 0;
+    } else if (channel < DS3231_MUX_CHANNELS) {
+        control = (1 << channel);
+    } else {
+        return false;
+    }
+
+    // The control register is the only register: it is written as the first byte
+    _switches++;
+    if (_bus->writeBurst(_addr, control, NULL, 0, true) != DS3231_BUS_OK) {
+        _channel = DS3231_MUX_UNKNOWN;
+        return false;
+    }
+    _channel = channel;
+
+    return true;
+}
+
+/*!
+ * \brief Disconnect all channels.
+ * \details
+ *      Required before another mux on the same bus selects a channel.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Mux not acknowledged.
+ */
+bool ErriezDS3231Mux::disable()
+{
+    return select(DS3231_MUX_NONE);
+}
+
+/*!
+ * \brief Forget the cached channel.
+ * \details
+ *      The next transfer writes the control register.
+ */
+void ErriezDS3231Mux::invalidate()
+{
+    _channel = DS3231_MUX_UNKNOWN;
+}
+
+/*!
+ * \brief Get cached channel.
+ * \return
+ *      Channel 0..7, DS3231_MUX_NONE or DS3231_MUX_UNKNOWN.
+ */
+uint8_t ErriezDS3231Mux::getChannel()
+{
+    return _channel;
+}
+
+/*!
+ * \brief Get number of channel switches.
+ * \return
+ *      Number of control register writes.
+ */
+uint32_t ErriezDS3231Mux::getSwitches()
+{
+    return _switches;
+}
+
+/*!
+ * \brief Get upstream bus.
+ * \return
+ *      Bus transport.
+ */
+ErriezDS3231Transport *ErriezDS3231Mux::getBus()
+{
+    return _bus;
+}
+
+/*!
+ * \brief Constructor.
+ * \param mux
+ *      Multiplexer.
+ * \param channel
+ *      Channel 0..7.
+ */
+ErriezDS3231MuxTransport::ErriezDS3231MuxTransport(ErriezDS3231Mux *mux, uint8_t channel) :
+    _mux(mux), _channel(channel)
+{
+}
+
+/*!
+ * \brief Select channel, then write register pointer and data.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      true: Generate stop. false: Keep bus for a repeated start by readBurst().
+ * \return
+ *      DS3231_BUS_OK on success, or DS3231_BUS_ERR_... code.
+ */
+uint8_t ErriezDS3231MuxTransport::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                             uint8_t len, bool stop)
+{
+    uint8_t result;
+
+    if (!_mux->select(_channel)) {
+        return DS3231_BUS_ERR_NACK_ADDR;
+    }
+
+    result = _mux->getBus()->writeBurst(addr, reg, buffer, len, stop);
+    if (result != DS3231_BUS_OK) {
+        // The mux state is unknown after a bus error
+        _mux->invalidate();
+    }
+
+    return result;
+}
+
+/*!
+ * \brief Select channel, then read data from the current register pointer.
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231MuxTransport::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    uint8_t received;
+
+    if (!_mux->select(_channel)) {
+        return 0;
+    }
+
+    received = _mux->getBus()->readBurst(addr, buffer, len);
+    if (received != len) {
+        _mux->invalidate();
+    }
+
+    return received;
+}
+
+/*!
+ * \brief Release a stuck bus via the upstream transport.
+ * \retval true
+ *      Bus released.
+ * \retval false
+ *      Not supported or failed.
+ */
+bool ErriezDS3231MuxTransport::busClear()
+{
+    _mux->invalidate();
+
+    return _mux->getBus()->busClear();
+}
+
+/*!
+ * \brief Get channel.
+ * \return
+ *      Channel 0..7.
+ */
+uint8_t ErriezDS3231MuxTransport::getChannel()
+{
+    return _channel;
+}
+
+/*!
+ * \brief Constructor.
+ * \param mux
+ *      Multiplexer of all RTCs in the fleet.
+ * \param clockMicros
+ *      Local microseconds clock for the skew measurement, for example micros.
+ */
+ErriezDS3231Fleet::ErriezDS3231Fleet(ErriezDS3231Mux *mux, unsigned long (*clockMicros)(void)) :
+    _mux(mux), _clockMicros(clockMicros), _count(0), _reverse(false), _sweeps(0), _errors(0)
+{
+    memset(_members, 0, sizeof(_members));
+}
+
+/*!
+ * \brief Add RTC.
+ * \details
+ *      Resets the skew statistics, because the first RTC is the reference.
+ * \param rtc
+ *      RTC constructed with an ErriezDS3231MuxTransport of the channel on the fleet mux.
+ * \param channel
+ *      Mux channel 0..7.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Fleet full, invalid channel or channel already in use.
+ */
+bool ErriezDS3231Fleet::add(ErriezDS3231 *rtc, uint8_t channel)
+{
+    uint8_t i;
+
+    if ((_count >= DS3231_FLEET_MAX) || (channel >= DS3231_MUX_CHANNELS)) {
+        return false;
+    }
+
+    // Find position, sorted by channel
+    for (i = 0; i < _count; i++) {
+        if (_members[i].channel == channel) {
+            return false;
+        }
+        if (_members[i].channel > channel) {
+            break;
+        }
+    }
+
+    // Insert member
+    memmove(&_members[i + 1], &_members[i], (_count - i) * sizeof(DS3231FleetMember));
+    memset(&_members[i], 0, sizeof(DS3231FleetMember));
+    _members[i].rtc = rtc;
+    _members[i].channel = channel;
+    _count++;
+
+    resetSkew();
+
+    return true;
+}
+
+/*!
+ * \brief Get number of RTCs.
+ * \return
+ *      Number of RTCs.
+ */
+uint8_t ErriezDS3231Fleet::count()
+{
+    return _count;
+}
+
+/*!
+ * \brief Run work on all RTCs, grouped per channel.
+ * \details
+ *      Uses the same alternating sweep order as poll(), so the first RTC is on the channel which
+ *      is still selected. All calls for one RTC should be made within its callback.
+ * \param callback
+ *      Work function.
+ * \param context
+ *      Passed to the callback.
+ * \retval true
+ *      All callbacks returned true.
+ * \retval false
+ *      At least one callback returned false.
+ */
+bool ErriezDS3231Fleet::forEach(DS3231FleetCallback callback, void *context)
+{
+    bool success = true;
+    uint8_t index;
+
+    for (uint8_t step = 0; step < _count; step++) {
+        index = sweepIndex(step);
+        if (!callback(_members[index].rtc, index, context)) {
+            success = false;
+        }
+    }
+    _reverse = !_reverse;
+
+    return success;
+}
+
+/*!
+ * \brief Read date/time and status of all RTCs in one sweep.
+ * \details
+ *      Reads registers 0x00..0x0F of each RTC in a single transaction and updates the skew
+ *      statistics.
+ * \retval true
+ *      All RTCs read with a valid date/time.
+ * \retval false
+ *      At least one read failed.
+ */
+bool ErriezDS3231Fleet::poll()
+{
+    bool success = true;
+    DS3231FleetMember *member;
+
+    for (uint8_t step = 0; step < _count; step++) {
+        member = &_members[sweepIndex(step)];
+        pollMember(member);
+        if (!member->valid) {
+            success = false;
+        }
+    }
+    _reverse = !_reverse;
+    _sweeps++;
+
+    return success;
+}
+
+/*!
+ * \brief Get read result.
+ * \param index
+ *      RTC index 0..count()-1, sorted by channel.
+ * \retval true
+ *      Last read successful with a valid date/time.
+ * \retval false
+ *      Last read failed or invalid index.
+ */
+bool ErriezDS3231Fleet::isValid(uint8_t index)
+{
+    return (index < _count) && _members[index].valid;
+}
+
+/*!
+ * \brief Get epoch of the last read.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Unix epoch, 0 when not valid.
+ */
+uint32_t ErriezDS3231Fleet::getEpoch(uint8_t index)
+{
+    return isValid(index) ? _members[index].epoch : 0;
+}
+
+/*!
+ * \brief Get status register of the last read.
+ * \details
+ *      Contains the OSF, BSY, A2F and A1F flags.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Status register, 0 when not valid.
+ */
+uint8_t ErriezDS3231Fleet::getStatus(uint8_t index)
+{
+    return isValid(index) ? _members[index].status : 0;
+}
+
+/*!
+ * \brief Get mux channel.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Channel 0..7, DS3231_MUX_NONE for an invalid index.
+ */
+uint8_t ErriezDS3231Fleet::getChannel(uint8_t index)
+{
+    return (index < _count) ? _members[index].channel : DS3231_MUX_NONE;
+}
+
+/*!
+ * \brief Get RTC.
+ * \param index
+ *      RTC index.
+ * \return
+ *      RTC, NULL for an invalid index.
+ */
+ErriezDS3231 *ErriezDS3231Fleet::getRtc(uint8_t index)
+{
+    return (index < _count) ? _members[index].rtc : NULL;
+}
+
+/*!
+ * \brief Skew statistics available.
+ * \param index
+ *      RTC index.
+ * \retval true
+ *      At least one rollover of this RTC and the reference RTC measured.
+ * \retval false
+ *      No skew measured.
+ */
+bool ErriezDS3231Fleet::isSkewValid(uint8_t index)
+{
+    return (index < _count) && _members[index].skewValid;
+}
+
+/*!
+ * \brief Get last skew.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Skew to the reference RTC in us, positive when the RTC is ahead.
+ */
+int32_t ErriezDS3231Fleet::getSkew(uint8_t index)
+{
+    return isSkewValid(index) ? _members[index].skew : 0;
+}
+
+/*!
+ * \brief Get minimum skew.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Minimum skew in us since resetSkew().
+ */
+int32_t ErriezDS3231Fleet::getSkewMin(uint8_t index)
+{
+    return isSkewValid(index) ? _members[index].skewMin : 0;
+}
+
+/*!
+ * \brief Get maximum skew.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Maximum skew in us since resetSkew().
+ */
+int32_t ErriezDS3231Fleet::getSkewMax(uint8_t index)
+{
+    return isSkewValid(index) ? _members[index].skewMax : 0;
+}
+
+/*!
+ * \brief Get mean skew.
+ * \param index
+ *      RTC index.
+ * \return
+ *      Mean skew in us since resetSkew().
+ */
+int32_t ErriezDS3231Fleet::getSkewMean(uint8_t index)
+{
+    return isSkewValid(index) ? _members[index].skewMean : 0;
+}
+
+/*!
+ * \brief Get spread of the fleet.
+ * \return
+ *      Difference between the largest and smallest last skew in us.
+ */
+int32_t ErriezDS3231Fleet::getSpread()
+{
+    bool first = true;
+    int32_t low = 0;
+    int32_t high = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        if (!_members[i].skewValid) {
+            continue;
+        }
+        if (first || (_members[i].skew < low)) {
+            low = _members[i].skew;
+        }
+        if (first || (_members[i].skew > high)) {
+            high = _members[i].skew;
+        }
+        first = false;
+    }
+
+    return high - low;
+}
+
+/*!
+ * \brief Reset skew statistics and rollover measurements.
+ */
+void ErriezDS3231Fleet::resetSkew()
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        _members[i].rolloverValid = false;
+        _members[i].skewValid = false;
+        _members[i].skew = 0;
+        _members[i].skewSamples = 0;
+    }
+}
+
+/*!
+ * \brief Get number of sweeps.
+ * \return
+ *      Number of poll() calls.
+ */
+uint32_t ErriezDS3231Fleet::getSweeps()
+{
+    return _sweeps;
+}
+
+/*!
+ * \brief Get number of failed reads.
+ * \return
+ *      Failed reads or invalid date/time.
+ */
+uint32_t ErriezDS3231Fleet::getErrors()
+{
+    return _errors;
+}
+
+/*!
+ * \brief RTC index at a step of the current sweep.
+ * \param step
+ *      Step 0..count()-1.
+ * \return
+ *      RTC index.
+ */
+uint8_t ErriezDS3231Fleet::sweepIndex(uint8_t step)
+{
+    return _reverse ? (uint8_t)(_count - 1 - step) : step;
+}
+
+/*!
+ * \brief Read date/time and status of one RTC.
+ * \details
+ *      A second rollover is measured when two consecutive reads within DS3231_FLEET_ROLLOVER_US
+ *      return consecutive seconds. The rollover is halfway between the reads.
+ * \param member
+ *      RTC.
+ */
+void ErriezDS3231Fleet::pollMember(DS3231FleetMember *member)
+{
+    uint8_t buffer[DS3231_FLEET_READ_LEN];
+    unsigned long now;
+    time_t t;
+
+    // Select the channel first: registers are latched at the start of the read transfer
+    _mux->select(member->channel);
+    now = _clockMicros();
+    if (!member->rtc->readBuffer(DS3231_REG_SECONDS, buffer, sizeof(buffer)) ||
+        !ErriezDS3231::decodeEpochRegisters(buffer, &t)) {
+        member->valid = false;
+        _errors++;
+        return;
+    }
+
+    if (member->valid && ((uint32_t)t == (member->epoch + 1)) &&
+        ((now - member->readMicros) <= DS3231_FLEET_ROLLOVER_US)) {
+        member->rolloverMicros = member->readMicros + (now - member->readMicros) / 2;
+        member->rolloverEpoch = (uint32_t)t;
+        member->rolloverValid = true;
+        updateSkew(member);
+    }
+
+    member->valid = true;
+    member->epoch = (uint32_t)t;
+    member->status = buffer[DS3231_REG_STATUS];
+    member->readMicros = now;
+}
+
+/*!
+ * \brief Update skew statistics after a rollover measurement.
+ * \param member
+ *      RTC with a new rollover.
+ */
+void ErriezDS3231Fleet::updateSkew(DS3231FleetMember *member)
+{
+    DS3231FleetMember *reference = &_members[0];
+    int32_t seconds;
+    int32_t skew;
+
+    if (!reference->rolloverValid) {
+        return;
+    }
+
+    // The RTC is ahead when its second starts before the same second of the reference
+    seconds = (int32_t)(member->rolloverEpoch - reference->rolloverEpoch);
+    if ((seconds > DS3231_FLEET_SKEW_MAX_SEC) || (seconds < -DS3231_FLEET_SKEW_MAX_SEC)) {
+        return;
+    }
+    skew = seconds * 1000000L - (int32_t)(member->rolloverMicros - reference->rolloverMicros);
+
+    // Update statistics
+    member->skew = skew;
+    if (member->skewSamples == 0) {
+        member->skewMin = skew;
+        member->skewMax = skew;
+        member->skewMean = skew;
+    } else {
+        if (skew < member->skewMin) {
+            member->skewMin = skew;
+        }
+        if (skew > member->skewMax) {
+            member->skewMax = skew;
+        }
+        member->skewMean += (skew - member->skewMean) / ((int32_t)member->skewSamples + 1);
+    }
+    if (member->skewSamples < 0xFFFF) {
+        member->skewSamples++;
+    }
+    member->skewValid = true;
+}
@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Fleet.h
+ * \brief DS3231 high precision RTC library for Arduino: multiple RTCs behind a TCA9548A mux
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_FLEET_H_
+#define ERRIEZ_DS3231_FLEET_H_
+
+#include "ErriezDS3231.h"
+
+//! No channel selected
+#define DS3231_MUX_NONE             0xFF
+
+//! Selected channel unknown, for example after a bus error
+#define DS3231_MUX_UNKNOWN          0xFE
+
+//! Maximum number of RTCs in a fleet, one per mux channel
+#ifndef DS3231_FLEET_MAX
+#define DS3231_FLEET_MAX            DS3231_MUX_CHANNELS
+#endif
+
+//! Registers read per RTC in a sweep: date/time, alarms, control and status 0x00..0x0F
+#define DS3231_FLEET_READ_LEN       (DS3231_REG_STATUS + 1)
+
+//! Maximum time between two reads of an RTC to measure its second rollover in us
+#define DS3231_FLEET_ROLLOVER_US    20000UL
+
+//! Maximum skew in seconds, larger skews are not measured
+#define DS3231_FLEET_SKEW_MAX_SEC   1000
+
+/*!
+ * \brief TCA9548A I2C multiplexer with a cached channel selection
+ * \details
+ *      All DS3231 RTCs have the same I2C address 0x68, so each RTC is connected to its own mux
+ *      channel. The selected channel is cached and the control register is only written when a
+ *      transfer is made on another channel. Call invalidate() when the mux is accessed without
+ *      this object.
+ */
+class ErriezDS3231Mux
+{
+public:
+    explicit ErriezDS3231Mux(ErriezDS3231Transport *bus, uint8_t addr=DS3231_MUX_ADDR);
+
+    bool select(uint8_t channel);
+    bool disable();
+    void invalidate();
+    uint8_t getChannel();
+    uint32_t getSwitches();
+    ErriezDS3231Transport *getBus();
+
+private:
+    ErriezDS3231Transport *_bus;    //!< Upstream bus transport
+    uint8_t _addr;                  //!< Mux I2C address
+    uint8_t _channel;               //!< Selected channel, DS3231_MUX_NONE or DS3231_MUX_UNKNOWN
+    uint32_t _switches;             //!< Number of control register writes
+};
+
+/*!
+ * \brief Bus transport to one mux channel
+ * \details
+ *      Selects the channel before each transfer when needed and forwards the transfer to the
+ *      upstream bus. Pass it to the ErriezDS3231 constructor.
+ */
+class ErriezDS3231MuxTransport : public ErriezDS3231Transport
+{
+public:
+    ErriezDS3231MuxTransport(ErriezDS3231Mux *mux, uint8_t channel);
+
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+    bool busClear();
+
+    uint8_t getChannel();
+
+private:
+    ErriezDS3231Mux *_mux;          //!< Multiplexer
+    uint8_t _channel;               //!< Channel 0..7
+};
+
+/*!
+ * \brief Work callback, called once per RTC by ErriezDS3231Fleet::forEach()
+ */
+typedef bool (*DS3231FleetCallback)(ErriezDS3231 *rtc, uint8_t index, void *context);
+
+/*!
+ * \brief State of one RTC in a fleet
+ */
+typedef struct {
+    ErriezDS3231 *rtc;              //!< RTC on a mux channel transport
+    uint8_t channel;                //!< Mux channel
+    bool valid;                     //!< Last read successful with valid date/time
+    uint8_t status;                 //!< Status register of the last read
+    uint32_t epoch;                 //!< Epoch of the last read
+    unsigned long readMicros;       //!< Time of the last read
+    unsigned long rolloverMicros;   //!< Measured start of second rolloverEpoch
+    uint32_t rolloverEpoch;         //!< Epoch which started at rolloverMicros
+    bool rolloverValid;             //!< Rollover measured
+    bool skewValid;                 //!< Skew statistics valid
+    int32_t skew;                   //!< Last skew to the reference RTC in us, positive: ahead
+    int32_t skewMin;                //!< Minimum skew in us
+    int32_t skewMax;                //!< Maximum skew in us
+    int32_t skewMean;               //!< Mean skew in us
+    uint16_t skewSamples;           //!< Number of skew samples, saturates at 65535
+} DS3231FleetMember;
+
+/*!
+ * \brief Fleet of DS3231 RTCs behind a TCA9548A mux
+ * \details
+ *      RTCs are kept sorted by channel. Sweeps alternate direction, so each sweep starts on the
+ *      channel where the previous sweep ended: a sweep over N RTCs costs N-1 channel switches and
+ *      one read transaction per RTC.
+ *
+ *      The skew between the RTCs is measured from the moment their seconds roll over. Poll at
+ *      least every 20 ms; each rollover is timed to half the poll interval, so a skew is accurate
+ *      to one poll interval. The skew is relative to the first RTC (lowest channel).
+ */
+class ErriezDS3231Fleet
+{
+public:
+    ErriezDS3231Fleet(ErriezDS3231Mux *mux, unsigned long (*clockMicros)(void));
+
+    bool add(ErriezDS3231 *rtc, uint8_t channel);
+    uint8_t count();
+
+    // Work grouped per channel
+    bool forEach(DS3231FleetCallback callback, void *context=NULL);
+    bool poll();
+
+    // Results of the last poll
+    bool isValid(uint8_t index);
+    uint32_t getEpoch(uint8_t index);
+    uint8_t getStatus(uint8_t index);
+    uint8_t getChannel(uint8_t index);
+    ErriezDS3231 *getRtc(uint8_t index);
+
+    // Skew statistics
+    bool isSkewValid(uint8_t index);
+    int32_t getSkew(uint8_t index);
+    int32_t getSkewMin(uint8_t index);
+    int32_t getSkewMax(uint8_t index);
+    int32_t getSkewMean(uint8_t index);
+    int32_t getSpread();
+    void resetSkew();
+
+    // Counters
+    uint32_t getSweeps();
+    uint32_t getErrors();
+
+private:
+    ErriezDS3231Mux *_mux;                          //!< Multiplexer
+    unsigned long (*_clockMicros)(void);            //!< Local clock
+    DS3231FleetMember _members[DS3231_FLEET_MAX];   //!< RTCs sorted by channel
+    uint8_t _count;                                 //!< Number of RTCs
+    bool _reverse;                                  //!< Direction of the next sweep
+    uint32_t _sweeps;                               //!< Number of polls
+    uint32_t _errors;                               //!< Number of failed reads
+
+    uint8_t sweepIndex(uint8_t step);
+    void pollMember(DS3231FleetMember *member);
+    void updateSkew(DS3231FleetMember *member);
+};
+
+#endif // ERRIEZ_DS3231_FLEET_H_
@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231LinuxI2C.cpp
+ * \brief DS3231 high precision RTC library: Linux i2c-dev bus transport
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "ErriezDS3231LinuxI2C.h"
+
+/*!
+ * \brief Constructor.
+ */
+ErriezDS3231LinuxI2C::ErriezDS3231LinuxI2C() :
+    _fd(-1), _pending(false), _pendingLen(0), _readError(DS3231_BUS_OK)
+{
+}
+
+/*!
+ * \brief Destructor, closes the device.
+ */
+ErriezDS3231LinuxI2C::~ErriezDS3231LinuxI2C()
+{
+    close();
+}
+
+/*!
+ * \brief Open i2c-dev device.
+ * \param device
+ *      Device name, such as /dev/i2c-1.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Open failed.
+ */
+bool ErriezDS3231LinuxI2C::open(const char *device)
+{
+    close();
+
+    _fd = ::open(device, O_RDWR);
+
+    return (_fd >= 0);
+}
+
+/*!
+ * \brief Close i2c-dev device.
+ */
+void ErriezDS3231LinuxI2C::close()
+{
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _pending = false;
+}
+
+/*!
+ * \brief Write register pointer and data.
+ * \details
+ *      Without stop, the register pointer and data are stored. They are transmitted by
+ *      readBurst() in the same ioctl as the read, with a repeated start.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      true: Generate stop. false: Repeated start by readBurst().
+ * \return
+ *      DS3231_BUS_OK on success, or DS3231_BUS_ERR_... code.
+ */
+uint8_t ErriezDS3231LinuxI2C::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                         uint8_t len, bool stop)
+{
+    struct i2c_rdwr_ioctl_data xfer;
+    struct i2c_msg msg;
+
+    if (_fd < 0) {
+        return DS3231_BUS_ERR_OTHER;
+    }
+    if (len > (sizeof(_pendingData) - 1)) {
+        return DS3231_BUS_ERR_LENGTH;
+    }
+
+    _pendingData[0] = reg;
+    if (len) {
+        memcpy(&_pendingData[1], buffer, len);
+    }
+    _pendingLen = len + 1;
+
+    if (!stop) {
+        _pending = true;
+        return DS3231_BUS_OK;
+    }
+
+    _pending = false;
+
+    msg.addr = addr;
+    msg.flags = 0;
+    msg.len = _pendingLen;
+    msg.buf = _pendingData;
+    xfer.msgs = &msg;
+    xfer.nmsgs = 1;
+
+    if (ioctl(_fd, I2C_RDWR, &xfer) < 0) {
+        return busError(errno);
+    }
+
+    return DS3231_BUS_OK;
+}
+
+/*!
+ * \brief Read data, preceded by the pending register write.
+ * \details
+ *      The buffer is left unchanged when the transfer failed. The error, which may have occurred
+ *      during the pending register write, is returned by getReadError().
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231LinuxI2C::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    struct i2c_rdwr_ioctl_data xfer;
+    struct i2c_msg msgs[2];
+    uint8_t n = 0;
+
+    if (_fd < 0) {
+        _pending = false;
+        _readError = DS3231_BUS_ERR_OTHER;
+        return 0;
+    }
+
+    if (_pending) {
+        msgs[n].addr = addr;
+        msgs[n].flags = 0;
+        msgs[n].len = _pendingLen;
+        msgs[n].buf = _pendingData;
+        n++;
+        _pending = false;
+    }
+
+    msgs[n].addr = addr;
+    msgs[n].flags = I2C_M_RD;
+    msgs[n].len = len;
+    msgs[n].buf = buffer;
+    n++;
+
+    xfer.msgs = msgs;
+    xfer.nmsgs = n;
+
+    if (ioctl(_fd, I2C_RDWR, &xfer) < 0) {
+        _readError = busError(errno);
+        return 0;
+    }
+
+    _readError = DS3231_BUS_OK;
+
+    return len;
+}
+
+/*!
+ * \brief Get the error of the last readBurst().
+ * \return
+ *      DS3231_BUS_OK or DS3231_BUS_ERR_... code.
+ */
+uint8_t ErriezDS3231LinuxI2C::getReadError()
+{
+    return _readError;
+}
+
+/*!
+ * \brief Convert errno of a failed I2C_RDWR ioctl.
+ * \param err
+ *      errno value.
+ * \return
+ *      DS3231_BUS_ERR_... code.
+ */
+uint8_t ErriezDS3231LinuxI2C::busError(int err)
+{
+    switch (err) {
+        case ENXIO:
+        case EREMOTEIO:
+            // Address not acknowledged
+            return DS3231_BUS_ERR_NACK_ADDR;
+        case ETIMEDOUT:
+            return DS3231_BUS_ERR_TIMEOUT;
+        default:
+            return DS3231_BUS_ERR_OTHER;
+    }
+}
+
+#endif // __linux__ && !ARDUINO
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231LinuxI2C.h
+ * \brief DS3231 high precision RTC library: Linux i2c-dev bus transport
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_LINUX_I2C_H_
+#define ERRIEZ_DS3231_LINUX_I2C_H_
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "ErriezDS3231Transport.h"
+
+/*!
+ * \brief Linux i2c-dev bus transport, for example for a Raspberry Pi
+ * \details
+ *      A register read, optionally preceded by a register write, is executed as a single
+ *      I2C_RDWR ioctl with a repeated start, identical to the Arduino Wire sequence. The errno of
+ *      a failed ioctl is converted to a DS3231_BUS_ERR_... code, also for a combined register
+ *      write and read, see getReadError().
+ */
+class ErriezDS3231LinuxI2C : public ErriezDS3231Transport
+{
+public:
+    ErriezDS3231LinuxI2C();
+    ~ErriezDS3231LinuxI2C();
+
+    bool open(const char *device="/dev/i2c-1");
+    void close();
+
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+    uint8_t getReadError();
+
+private:
+    int _fd;                  //!< File descriptor
+    bool _pending;            //!< Write pending for repeated start
+    uint8_t _pendingLen;      //!< Pending register pointer and data length
+    uint8_t _pendingData[33]; //!< Pending register pointer and up to 32 data bytes
+    uint8_t _readError;       //!< DS3231_BUS_... code of the last read
+
+    static uint8_t busError(int err);
+};
+
+#endif // __linux__ && !ARDUINO
+
+#endif // ERRIEZ_DS3231_LINUX_I2C_H_
@@ -0,0 +1,404 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Scheduler.cpp
+ * \brief DS3231 high precision RTC library for Arduino: software alarm multiplexer
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include "ErriezDS3231Scheduler.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ * \param pool
+ *      Application supplied event array, for example a global DS3231Event events[16].
+ * \param poolSize
+ *      Number of elements in the event array.
+ */
+ErriezDS3231Scheduler::ErriezDS3231Scheduler(ErriezDS3231 *rtc, DS3231Event *pool,
+                                             uint8_t poolSize) :
+    _rtc(rtc), _events(pool), _poolSize(poolSize), _count(0), _armed(0), _armedValid(false),
+    _enabled(false), _dispatched(0), _wakeups(0), _spurious(0)
+{
+}
+
+/*!
+ * \brief Enable alarm 1 interrupt on the INT/SQW pin.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C transfer failed.
+ */
+bool ErriezDS3231Scheduler::begin()
+{
+    _armedValid = false;
+    _enabled = _rtc->alarmInterruptEnable(Alarm1, true);
+
+    return _enabled;
+}
+
+/*!
+ * \brief Schedule event.
+ * \details
+ *      An event with the same ID is replaced. Alarm 1 is programmed when the event is the new
+ *      nearest deadline. An event with a deadline in the past is dispatched by the next
+ *      service() call.
+ * \param id
+ *      Application event ID.
+ * \param epoch
+ *      First deadline, Unix epoch.
+ * \param period
+ *      Repeat interval in seconds, 0: single shot.
+ * \param callback
+ *      Function called at the deadline.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Pool full or I2C transfer failed.
+ */
+bool ErriezDS3231Scheduler::schedule(uint8_t id, uint32_t epoch, uint32_t period,
+                                     DS3231EventCallback callback)
+{
+    int16_t i = find(id);
+
+    if (i >= 0) {
+        remove((uint8_t)i);
+    } else if (_count >= _poolSize) {
+        return false;
+    }
+
+    // Add at the end of the heap
+    _events[_count].deadline = epoch;
+    _events[_count].period = period;
+    _events[_count].callback = callback;
+    _events[_count].id = id;
+    siftUp(_count++);
+
+    return arm();
+}
+
+/*!
+ * \brief Cancel event.
+ * \param id
+ *      Application event ID.
+ * \retval true
+ *      Event removed.
+ * \retval false
+ *      Event not scheduled or I2C transfer failed.
+ */
+bool ErriezDS3231Scheduler::cancel(uint8_t id)
+{
+    int16_t i = find(id);
+
+    if (i < 0) {
+        return false;
+    }
+
+    remove((uint8_t)i);
+
+    return arm();
+}
+
+/*!
+ * \brief Get number of scheduled events.
+ * \return
+ *      Number of events.
+ */
+uint8_t ErriezDS3231Scheduler::count()
+{
+    return _count;
+}
+
+/*!
+ * \brief Get nearest deadline.
+ * \param epoch
+ *      Nearest deadline, Unix epoch.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      No events scheduled.
+ */
+bool ErriezDS3231Scheduler::nextDeadline(uint32_t *epoch)
+{
+    if (!_count) {
+        return false;
+    }
+
+    *epoch = _events[0].deadline;
+
+    return true;
+}
+
+/*!
+ * \brief Dispatch due events and program alarm 1 with the nearest deadline.
+ * \details
+ *      Call after an alarm 1 interrupt, or periodically. Repeating events are scheduled again at
+ *      the next multiple of their period; missed periods are skipped. Callbacks may schedule or
+ *      cancel events.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C transfer failed.
+ */
+bool ErriezDS3231Scheduler::service()
+{
+    DS3231Event event;
+    uint32_t now;
+    uint32_t dispatched = _dispatched;
+
+    _wakeups++;
+
+    // Program alarm 1 again to clear the alarm flag
+    _armedValid = false;
+
+    now = (uint32_t)_rtc->getEpoch();
+
+    for (;;) {
+        if (!now) {
+            return false;
+        }
+
+        while (_count && (_events[0].deadline <= now)) {
+            event = _events[0];
+            remove(0);
+
+            if (event.period) {
+                // Next deadline after now
+                _events[_count] = event;
+                _events[_count].deadline += event.period *
+                                            ((now - event.deadline) / event.period + 1);
+                siftUp(_count++);
+            }
+
+            _dispatched++;
+            if (event.callback) {
+                event.callback(event.id, event.deadline);
+            }
+        }
+
+        if (!_count) {
+            // Last single shot event dispatched
+            if (!_rtc->clearAlarmFlag(Alarm1) || !arm()) {
+                return false;
+            }
+            break;
+        }
+
+        if (!arm()) {
+            return false;
+        }
+
+        // A deadline in the next second may have passed while programming alarm 1
+        if (_events[0].deadline > (now + 1)) {
+            break;
+        }
+        now = (uint32_t)_rtc->getEpoch();
+        if (now && (now < _events[0].deadline)) {
+            break;
+        }
+    }
+
+    if (_dispatched == dispatched) {
+        _spurious++;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Get number of dispatched events.
+ * \return
+ *      Number of callbacks.
+ */
+uint32_t ErriezDS3231Scheduler::getDispatched()
+{
+    return _dispatched;
+}
+
+/*!
+ * \brief Get number of service() calls.
+ * \return
+ *      Number of wakeups.
+ */
+uint32_t ErriezDS3231Scheduler::getWakeups()
+{
+    return _wakeups;
+}
+
+/*!
+ * \brief Get number of service() calls without due event.
+ * \details
+ *      Alarm 1 matches the day of the month, so a deadline more than a month ahead produces one
+ *      spurious wakeup per month.
+ * \return
+ *      Number of spurious wakeups.
+ */
+uint32_t ErriezDS3231Scheduler::getSpuriousWakeups()
+{
+    return _spurious;
+}
+
+/*!
+ * \brief Find event by ID.
+ * \param id
+ *      Application event ID.
+ * \return
+ *      Heap index, or -1 when not found.
+ */
+int16_t ErriezDS3231Scheduler::find(uint8_t id)
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_events[i].id == id) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * \brief Swap two heap elements.
+ * \param a
+ *      Heap index.
+ * \param b
+ *      Heap index.
+ */
+void ErriezDS3231Scheduler::swap(uint8_t a, uint8_t b)
+{
+    DS3231Event tmp = _events[a];
+
+    _events[a] = _events[b];
+    _events[b] = tmp;
+}
+
+/*!
+ * \brief Move element up until the heap order is restored.
+ * \param i
+ *      Heap index.
+ */
+void ErriezDS3231Scheduler::siftUp(uint8_t i)
+{
+    uint8_t parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (_events[parent].deadline <= _events[i].deadline) {
+            break;
+        }
+        swap(i, parent);
+        i = parent;
+    }
+}
+
+/*!
+ * \brief Move element down until the heap order is restored.
+ * \param i
+ *      Heap index.
+ */
+void ErriezDS3231Scheduler::siftDown(uint8_t i)
+{
+    uint8_t child;
+
+    while ((child = 2 * i + 1) < _count) {
+        if (((child + 1) < _count) && (_events[child + 1].deadline < _events[child].deadline)) {
+            child++;
+        }
+        if (_events[i].deadline <= _events[child].deadline) {
+            break;
+        }
+        swap(i, child);
+        i = child;
+    }
+}
+
+/*!
+ * \brief Remove element from the heap.
+ * \param i
+ *      Heap index.
+ */
+void ErriezDS3231Scheduler::remove(uint8_t i)
+{
+    if (i != --_count) {
+        _events[i] = _events[_count];
+        siftDown(i);
+        siftUp(i);
+    }
+}
+
+/*!
+ * \brief Program alarm 1 with the nearest deadline when changed.
+ * \details
+ *      Without events, the alarm 1 interrupt is disabled, because the programmed deadline would
+ *      match again in the next month. It is enabled again with the next event.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      I2C transfer failed.
+ */
+bool ErriezDS3231Scheduler::arm()
+{
+    uint32_t deadline;
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+
+    if (!_count) {
+        _armedValid = false;
+        if (_enabled) {
+            if (!_rtc->alarmInterruptEnable(Alarm1, false)) {
+                return false;
+            }
+            _enabled = false;
+        }
+        return true;
+    }
+
+    if (_armedValid && (_armed == _events[0].deadline)) {
+        return true;
+    }
+
+    deadline = _events[0].deadline;
+    ErriezDS3231::civilFromDays((uint16_t)(deadline / 86400UL), &year, &mon, &mday);
+
+    // Alarm at date, hours, minutes and seconds of the deadline
+    if (!_rtc->setAlarm1(Alarm1MatchDate, mday, (deadline / 3600UL) % 24,
+                         (deadline / 60) % 60, deadline % 60)) {
+        _armedValid = false;
+        return false;
+    }
+
+    _armed = deadline;
+    _armedValid = true;
+
+    if (!_enabled) {
+        _enabled = _rtc->alarmInterruptEnable(Alarm1, true);
+    }
+
+    return _enabled;
+}
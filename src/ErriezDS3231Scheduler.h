@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Scheduler.h
+ * \brief DS3231 high precision RTC library for Arduino: software alarm multiplexer
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_SCHEDULER_H_
+#define ERRIEZ_DS3231_SCHEDULER_H_
+
+#include "ErriezDS3231.h"
+
+/*!
+ * \brief Scheduled event callback
+ * \param id
+ *      Event ID passed to ErriezDS3231Scheduler::schedule().
+ * \param epoch
+ *      Deadline of the event.
+ */
+typedef void (*DS3231EventCallback)(uint8_t id, uint32_t epoch);
+
+/*!
+ * \brief Scheduled event, element of the application supplied event pool
+ */
+typedef struct {
+    uint32_t deadline;              //!< Next deadline, Unix epoch
+    uint32_t period;                //!< Repeat interval in seconds, 0: single shot
+    DS3231EventCallback callback;   //!< Callback
+    uint8_t id;                     //!< Application event ID
+} DS3231Event;
+
+/*!
+ * \brief Software alarm multiplexer on top of alarm 1
+ * \details
+ *      Keeps any number of scheduled events in a min-heap in an application supplied array,
+ *      without dynamic memory allocation. Alarm 1 is always programmed with the nearest deadline
+ *      (Alarm1MatchDate). Call service() after an alarm 1 interrupt: all due events are
+ *      dispatched and alarm 1 is programmed again. The MCU can sleep between events. The alarm 1
+ *      interrupt is disabled while no event is scheduled. Alarm 2 remains available to the
+ *      application.
+ */
+class ErriezDS3231Scheduler
+{
+public:
+    ErriezDS3231Scheduler(ErriezDS3231 *rtc, DS3231Event *pool, uint8_t poolSize);
+
+    bool begin();
+
+    // Events
+    bool schedule(uint8_t id, uint32_t epoch, uint32_t period, DS3231EventCallback callback);
+    bool cancel(uint8_t id);
+    uint8_t count();
+    bool nextDeadline(uint32_t *epoch);
+
+    // Dispatch due events and program alarm 1
+    bool service();
+
+    // Statistics
+    uint32_t getDispatched();
+    uint32_t getWakeups();
+    uint32_t getSpuriousWakeups();
+
+private:
+    ErriezDS3231 *_rtc;         //!< RTC object
+    DS3231Event *_events;       //!< Event pool, ordered as min-heap on deadline
+    uint8_t _poolSize;          //!< Number of elements in the pool
+    uint8_t _count;             //!< Number of scheduled events
+    uint32_t _armed;            //!< Deadline programmed in alarm 1
+    bool _armedValid;           //!< Alarm 1 is programmed
+    bool _enabled;              //!< Alarm 1 interrupt enabled
+    uint32_t _dispatched;       //!< Number of callbacks
+    uint32_t _wakeups;          //!< Number of service() calls
+    uint32_t _spurious;         //!< Number of service() calls without due event
+
+    int16_t find(uint8_t id);
+    void swap(uint8_t a, uint8_t b);
+    void siftUp(uint8_t i);
+    void siftDown(uint8_t i);
+    void remove(uint8_t i);
+    bool arm();
+};
+
+#endif // ERRIEZ_DS3231_SCHEDULER_H_
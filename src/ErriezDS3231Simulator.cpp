@@ -0,0 +1,1059 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Simulator.cpp
+ * \brief DS3231 high precision RTC library: behavioural DS3231 simulator
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Simulator.h"
+
+/*!
+ * \brief Constructor.
+ * \details
+ *      The simulator starts in the power-on reset state at 25.00 degree Celsius, running from
+ *      VCC, with bus transfers taking no virtual time.
+ */
+ErriezDS3231Simulator::ErriezDS3231Simulator() :
+    _pointer(0), _transfer(false),
+    _now(0), _phase(0), _phaseFraction(0), _oscError(0), _agingApplied(0), _busClock(0),
+    _onBattery(false), _oscFault(false),
+    _temperature(25 * 4), _convTime(DS3231_SIM_CONV_TIME_US), _convRemaining(0),
+    _convSeconds(0),
+    _fault(SimFaultNone), _faultSkip(0), _faultCount(0)
+{
+    resetCounters();
+    powerOnReset();
+}
+
+/*!
+ * \brief Write register pointer and data.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      true: Generate stop. false: Repeated start by readBurst().
+ * \return
+ *      DS3231_BUS_OK on success, or DS3231_BUS_ERR_... code.
+ */
+uint8_t ErriezDS3231Simulator::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                          uint8_t len, bool stop)
+{
+    SimFault fault = nextFault(false);
+
+    if ((addr != DS3231_ADDR) || (fault != SimFaultNone)) {
+        // Transfer aborted with a stop
+        _transfer = false;
+        _transactions++;
+        busTime(1);
+
+        if ((fault == SimFaultTimeout) || (fault == SimFaultBusStuck)) {
+            return DS3231_BUS_ERR_TIMEOUT;
+        }
+        if (fault == SimFaultNackData) {
+            return DS3231_BUS_ERR_NACK_DATA;
+        }
+        return DS3231_BUS_ERR_NACK_ADDR;
+    }
+
+    // Register pointer
+    _pointer = reg % DS3231_NUM_REGS;
+    _bytesWritten++;
+
+    // Data with auto-increment, wrapping from 0x12 to 0x00
+    for (uint8_t i = 0; i < len; i++) {
+        writeRegisterValue(_pointer, buffer[i]);
+        _pointer = (_pointer + 1) % DS3231_NUM_REGS;
+        _bytesWritten++;
+    }
+
+    if (stop) {
+        _transfer = false;
+        _transactions++;
+    } else {
+        // Transaction completes at the stop after the repeated start read
+        _transfer = true;
+    }
+
+    busTime(2 + len);
+
+    return DS3231_BUS_OK;
+}
+
+/*!
+ * \brief Read data from the register pointer.
+ * \details
+ *      Bytes which are not received are left unchanged.
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231Simulator::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    SimFault fault = nextFault(true);
+    uint8_t received = len;
+
+    _transfer = false;
+    _transactions++;
+
+    if ((addr != DS3231_ADDR) ||
+        ((fault != SimFaultNone) && (fault != SimFaultShortRead))) {
+        busTime(1);
+        return 0;
+    }
+
+    if (fault == SimFaultShortRead) {
+        received = len / 2;
+    }
+
+    // Data with auto-increment, wrapping from 0x12 to 0x00
+    for (uint8_t i = 0; i < received; i++) {
+        buffer[i] = _regs[_pointer];
+        _pointer = (_pointer + 1) % DS3231_NUM_REGS;
+    }
+    _bytesRead += received;
+
+    busTime(1 + received);
+
+    return received;
+}
+
+/*!
+ * \brief Clear bus by clocking out SCL.
+ * \details
+ *      Releases an injected SimFaultBusStuck fault.
+ * \retval true
+ *      Bus released.
+ */
+bool ErriezDS3231Simulator::busClear()
+{
+    if (_fault == SimFaultBusStuck) {
+        _fault = SimFaultNone;
+        _faultCount = 0;
+    }
+
+    // 9 clocks and a stop condition at 100kHz
+    advance(100);
+
+    return true;
+}
+
+/*!
+ * \brief Power-on reset.
+ * \details
+ *      Sets the registers to the datasheet power-on values: 01/01/00 00:00:00, alarms cleared,
+ *      control 0x1C and status 0x88 with the Oscillator Stop Flag set. Virtual time and counters
+ *      are not changed.
+ */
+void ErriezDS3231Simulator::powerOnReset()
+{
+    memset(_regs, 0, sizeof(_regs));
+
+    _regs[DS3231_REG_DAY_WEEK] = 0x01;
+    _regs[DS3231_REG_DAY_MONTH] = 0x01;
+    _regs[DS3231_REG_MONTH] = 0x01;
+    _regs[DS3231_REG_CONTROL] = (1 << DS3231_CTRL_RS2) | (1 << DS3231_CTRL_RS1) |
+                                (1 << DS3231_CTRL_INTCN);
+    _regs[DS3231_REG_STATUS] = (1 << DS3231_STAT_OSF) | (1 << DS3231_STAT_EN32KHZ);
+
+    _pointer = 0;
+    _transfer = false;
+    _phase = 0;
+    _convRemaining = 0;
+    _convSeconds = 0;
+
+    // A conversion is executed at power-on
+    finishConversion();
+}
+
+/*!
+ * \brief Select power supply.
+ * \details
+ *      On V-BAT, the oscillator stops when the EOSC bit is set and the square wave output is
+ *      disabled unless the BBSQW bit is set.
+ * \param onBattery
+ *      true: Powered from V-BAT, false: Powered from VCC.
+ */
+void ErriezDS3231Simulator::setBatteryPower(bool onBattery)
+{
+    _onBattery = onBattery;
+}
+
+/*!
+ * \brief Simulate an external oscillator fault, such as a damaged crystal.
+ * \param fault
+ *      true: Stop the oscillator, false: Oscillator can run.
+ */
+void ErriezDS3231Simulator::setOscillatorFault(bool fault)
+{
+    _oscFault = fault;
+
+    if (fault) {
+        _regs[DS3231_REG_STATUS] |= (1 << DS3231_STAT_OSF);
+    }
+}
+
+/*!
+ * \brief Get oscillator state.
+ * \retval true
+ *      Oscillator running.
+ * \retval false
+ *      Oscillator stopped by a fault or by EOSC on V-BAT.
+ */
+bool ErriezDS3231Simulator::isOscillatorRunning()
+{
+    if (_oscFault) {
+        return false;
+    }
+
+    return !(_onBattery && (_regs[DS3231_REG_CONTROL] & (1 << DS3231_CTRL_EOSC)));
+}
+
+/*!
+ * \brief Advance virtual time.
+ * \details
+ *      Increments the time registers at each second boundary, sets the alarm flags on a match
+ *      and completes temperature conversions. The RTC runs with the frequency error set by
+ *      setFrequencyError() and the aging offset register.
+ * \param us
+ *      Microseconds.
+ */
+void ErriezDS3231Simulator::advance(uint32_t us)
+{
+    uint32_t step;
+    bool running;
+
+    while (us) {
+        running = isOscillatorRunning();
+        if (!running) {
+            _regs[DS3231_REG_STATUS] |= (1 << DS3231_STAT_OSF);
+        }
+
+        // Stop at the next event
+        step = us;
+        if (running && (step > (1000000UL - _phase))) {
+            step = 1000000UL - _phase;
+        }
+        if (_convRemaining && (step > _convRemaining)) {
+            step = _convRemaining;
+        }
+
+        _now += step;
+        us -= step;
+
+        if (_convRemaining) {
+            _convRemaining -= step;
+            if (_convRemaining == 0) {
+                finishConversion();
+            }
+        }
+
+        if (running) {
+            // A fast oscillator passes the second boundary within the step
+            _phase += drift(step);
+            if (_phase >= 1000000UL) {
+                _phase -= 1000000UL;
+                tick();
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Convert virtual time to RTC time with the oscillator frequency error.
+ * \param us
+ *      Virtual time in us.
+ * \return
+ *      RTC time in us.
+ */
+uint32_t ErriezDS3231Simulator::drift(uint32_t us)
+{
+    int32_t carry;
+
+    _phaseFraction += (int64_t)us * getFrequencyError();
+    carry = (int32_t)(_phaseFraction / 1000000000L);
+    _phaseFraction -= (int64_t)carry * 1000000000L;
+
+    return us + carry;
+}
+
+/*!
+ * \brief Advance virtual time in seconds.
+ * \param seconds
+ *      Seconds.
+ */
+void ErriezDS3231Simulator::advanceSeconds(uint32_t seconds)
+{
+    while (seconds--) {
+        advance(1000000UL);
+    }
+}
+
+/*!
+ * \brief Get virtual time, compatible with Arduino micros().
+ * \return
+ *      Microseconds, wraps after 71 minutes.
+ */
+uint32_t ErriezDS3231Simulator::getMicros()
+{
+    return (uint32_t)_now;
+}
+
+/*!
+ * \brief Get virtual time, compatible with Arduino millis().
+ * \return
+ *      Milliseconds.
+ */
+uint32_t ErriezDS3231Simulator::getMillis()
+{
+    return (uint32_t)(_now / 1000U);
+}
+
+/*!
+ * \brief Get position in the current RTC second.
+ * \details
+ *      Writing the seconds register restarts the countdown chain at 0.
+ * \return
+ *      Microseconds 0..999999.
+ */
+uint32_t ErriezDS3231Simulator::getSubsecondMicros()
+{
+    return _phase;
+}
+
+/*!
+ * \brief Set bus clock to advance virtual time during bus transfers.
+ * \param hz
+ *      I2C clock in Hz, for example 100000 or 400000. 0: Transfers take no time (default).
+ */
+void ErriezDS3231Simulator::setBusClock(uint32_t hz)
+{
+    _busClock = hz;
+}
+
+/*!
+ * \brief Get register without bus transfer.
+ * \param reg
+ *      Register 0x00..0x12.
+ * \return
+ *      Register value.
+ */
+uint8_t ErriezDS3231Simulator::getRegister(uint8_t reg)
+{
+    return _regs[reg % DS3231_NUM_REGS];
+}
+
+/*!
+ * \brief Set register without bus transfer and without write side effects.
+ * \param reg
+ *      Register 0x00..0x12.
+ * \param value
+ *      Register value.
+ */
+void ErriezDS3231Simulator::setRegister(uint8_t reg, uint8_t value)
+{
+    _regs[reg % DS3231_NUM_REGS] = value;
+}
+
+/*!
+ * \brief Set date/time registers without bus transfer.
+ * \details
+ *      Restarts the countdown chain, like a write of the seconds register.
+ * \param t
+ *      Unix epoch in the range 2000..2099.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Epoch out of range.
+ */
+bool ErriezDS3231Simulator::setEpoch(time_t t)
+{
+    if (!ErriezDS3231::encodeEpochRegisters(t, _regs)) {
+        return false;
+    }
+    _phase = 0;
+
+    return true;
+}
+
+/*!
+ * \brief Get date/time registers without bus transfer.
+ * \param t
+ *      Unix epoch.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid date/time registers.
+ */
+bool ErriezDS3231Simulator::getEpoch(time_t *t)
+{
+    return ErriezDS3231::decodeEpochRegisters(_regs, t);
+}
+
+/*!
+ * \brief Set die temperature.
+ * \details
+ *      The temperature registers are updated at the end of the next conversion.
+ * \param quarterDegrees
+ *      Temperature in 0.25 degree Celsius, for example 101 for 25.25 degree Celsius.
+ */
+void ErriezDS3231Simulator::setTemperature(int16_t quarterDegrees)
+{
+    _temperature = quarterDegrees;
+}
+
+/*!
+ * \brief Set temperature conversion time.
+ * \param us
+ *      Conversion time in microseconds, default DS3231_SIM_CONV_TIME_US. Minimum 1.
+ */
+void ErriezDS3231Simulator::setConversionTime(uint32_t us)
+{
+    _convTime = us ? us : 1;
+}
+
+/*!
+ * \brief Get INT/SQW output pin level.
+ * \details
+ *      With INTCN set, the open-drain output is low while an enabled alarm flag is set.
+ *      Otherwise, the square wave output falls at the start of each second. On V-BAT, the output
+ *      is high impedance unless BBSQW is set.
+ * \retval true
+ *      High or high impedance.
+ * \retval false
+ *      Low.
+ */
+bool ErriezDS3231Simulator::getIntSqwPin()
+{
+    static const uint16_t rates[4] = { 1, 1024, 4096, 8192 };
+    uint8_t control = _regs[DS3231_REG_CONTROL];
+    uint8_t status = _regs[DS3231_REG_STATUS];
+
+    if (_onBattery && !(control & (1 << DS3231_CTRL_BBSQW))) {
+        return true;
+    }
+
+    if (control & (1 << DS3231_CTRL_INTCN)) {
+        return !((control & status) & ((1 << DS3231_CTRL_A2IE) | (1 << DS3231_CTRL_A1IE)));
+    }
+
+    if (!isOscillatorRunning()) {
+        return true;
+    }
+
+    // Low during the first half of each period
+    return (((uint64_t)_phase * rates[(control >> DS3231_CTRL_RS1) & 0x03] * 2) / 1000000UL) & 1;
+}
+
+/*!
+ * \brief Inject bus fault.
+ * \details
+ *      SimFaultShortRead only applies to reads, other faults apply to reads and writes.
+ *      SimFaultBusStuck lasts until busClear(), regardless of count.
+ * \param fault
+ *      Fault type, SimFaultNone to cancel.
+ * \param count
+ *      Number of consecutive transfers to fail.
+ * \param skip
+ *      Number of transfers to execute successfully before the first failure.
+ */
+void ErriezDS3231Simulator::injectFault(SimFault fault, uint16_t count, uint16_t skip)
+{
+    _fault = count ? fault : SimFaultNone;
+    _faultCount = count;
+    _faultSkip = skip;
+}
+
+/*!
+ * \brief Get number of I2C transactions from start to stop.
+ * \details
+ *      A register pointer write followed by a repeated start read counts as one transaction.
+ * \return
+ *      Number of transactions.
+ */
+uint32_t ErriezDS3231Simulator::getTransactions()
+{
+    return _transactions;
+}
+
+/*!
+ * \brief Get number of bytes written, including the register pointer.
+ * \return
+ *      Number of bytes.
+ */
+uint32_t ErriezDS3231Simulator::getBytesWritten()
+{
+    return _bytesWritten;
+}
+
+/*!
+ * \brief Get number of bytes read.
+ * \return
+ *      Number of bytes.
+ */
+uint32_t ErriezDS3231Simulator::getBytesRead()
+{
+    return _bytesRead;
+}
+
+/*!
+ * \brief Get number of transfers failed by fault injection.
+ * \return
+ *      Number of failed transfers.
+ */
+uint32_t ErriezDS3231Simulator::getFaults()
+{
+    return _faults;
+}
+
+/*!
+ * \brief Get number of alarm matches, regardless of the alarm flag and interrupt enable.
+ * \param alarmId
+ *      Alarm1 or Alarm2.
+ * \return
+ *      Number of matches.
+ */
+uint32_t ErriezDS3231Simulator::getAlarmMatches(AlarmId alarmId)
+{
+    return (alarmId == Alarm1) ? _alarm1Matches : _alarm2Matches;
+}
+
+/*!
+ * \brief Reset transaction, byte, fault and alarm counters.
+ */
+void ErriezDS3231Simulator::resetCounters()
+{
+    _transactions = 0;
+    _bytesWritten = 0;
+    _bytesRead = 0;
+    _faults = 0;
+    _alarm1Matches = 0;
+    _alarm2Matches = 0;
+}
+
+/*!
+ * \brief Get injected fault for the next transfer.
+ * \param read
+ *      true: Read transfer, false: Write transfer.
+ * \return
+ *      Fault for this transfer.
+ */
+SimFault ErriezDS3231Simulator::nextFault(bool read)
+{
+    SimFault fault;
+
+    if ((_fault == SimFaultNone) || ((_fault == SimFaultShortRead) && !read)) {
+        return SimFaultNone;
+    }
+
+    if (_faultSkip) {
+        _faultSkip--;
+        return SimFaultNone;
+    }
+
+    fault = _fault;
+    if ((fault != SimFaultBusStuck) && (--_faultCount == 0)) {
+        _fault = SimFaultNone;
+    }
+    _faults++;
+
+    return fault;
+}
+
+/*!
+ * \brief Write register via the bus with the RTC write side effects.
+ * \param reg
+ *      Register 0x00..0x12.
+ * \param value
+ *      Register value.
+ */
+void ErriezDS3231Simulator::writeRegisterValue(uint8_t reg, uint8_t value)
+{
+    static const uint8_t timeMasks[7] = { 0x7F, 0x7F, 0x7F, 0x07, 0x3F, 0x9F, 0xFF };
+    uint8_t keep;
+
+    switch (reg) {
+        case DS3231_REG_SECONDS:
+            // Writing the seconds register restarts the countdown chain
+            _regs[reg] = value & timeMasks[reg];
+            _phase = 0;
+            break;
+        case DS3231_REG_MINUTES:
+        case DS3231_REG_HOURS:
+        case DS3231_REG_DAY_WEEK:
+        case DS3231_REG_DAY_MONTH:
+        case DS3231_REG_MONTH:
+        case DS3231_REG_YEAR:
+            _regs[reg] = value & timeMasks[reg];
+            break;
+        case DS3231_REG_CONTROL:
+            // CONV can only be set and is cleared at the end of the conversion
+            keep = _regs[reg] & (1 << DS3231_CTRL_CONV);
+            _regs[reg] = value | keep;
+            if ((value & (1 << DS3231_CTRL_CONV)) && !_convRemaining) {
+                startConversion();
+            }
+            break;
+        case DS3231_REG_STATUS:
+            // BSY is read-only, OSF, A2F and A1F can only be cleared
+            keep = _regs[reg] & ((1 << DS3231_STAT_BSY) |
+                                 (value & ((1 << DS3231_STAT_OSF) |
+                                           (1 << DS3231_STAT_A2F) | (1 << DS3231_STAT_A1F))));
+            _regs[reg] = keep | (value & (1 << DS3231_STAT_EN32KHZ));
+            break;
+        case DS3231_REG_TEMP_MSB:
+        case DS3231_REG_TEMP_LSB:
+            // Read-only
+            break;
+        default:
+            _regs[reg] = value;
+            break;
+    }
+}
+
+/*!
+ * \brief Advance virtual time by the duration of a bus transfer.
+ * \param bytes
+ *      Number of bytes including the address byte, each 9 clocks, plus start and stop.
+ */
+void ErriezDS3231Simulator::busTime(uint8_t bytes)
+{
+    if (_busClock) {
+        advance((((uint32_t)bytes * 9 + 2) * 1000000UL) / _busClock);
+    }
+}
+
+/*!
+ * \brief Increment time registers by one second.
+ */
+void ErriezDS3231Simulator::tick()
+{
+    static const uint8_t daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    uint8_t *regs = _regs;
+    uint8_t hour;
+    uint8_t mday;
+    uint8_t mon;
+    uint8_t year;
+    uint8_t dim;
+    bool pm;
+    bool newDay = false;
+
+    // Automatic temperature conversion
+    if (++_convSeconds >= DS3231_SIM_CONV_INTERVAL) {
+        _convSeconds = 0;
+        if (!_convRemaining) {
+            startConversion();
+        }
+    }
+
+    // Seconds and minutes
+    if ((regs[0] & 0x7F) != 0x59) {
+        regs[0] = ErriezDS3231::decToBcd(ErriezDS3231::bcdToDec(regs[0] & 0x7F) + 1);
+        checkAlarms();
+        return;
+    }
+    regs[0] = 0x00;
+    if ((regs[1] & 0x7F) != 0x59) {
+        regs[1] = ErriezDS3231::decToBcd(ErriezDS3231::bcdToDec(regs[1] & 0x7F) + 1);
+        checkAlarms();
+        return;
+    }
+    regs[1] = 0x00;
+
+    // Hours in 12 or 24 hour mode
+    if (regs[2] & (1 << DS3231_HOUR_12H_24H)) {
+        hour = ErriezDS3231::bcdToDec(regs[2] & 0x1F);
+        pm = regs[2] & (1 << DS3231_HOUR_AM_PM);
+        if (hour == 11) {
+            newDay = pm;
+            pm = !pm;
+            hour = 12;
+        } else if (hour == 12) {
+            hour = 1;
+        } else {
+            hour++;
+        }
+        regs[2] = (1 << DS3231_HOUR_12H_24H) | (pm ? (1 << DS3231_HOUR_AM_PM) : 0) |
+                  ErriezDS3231::decToBcd(hour);
+    } else {
+        hour = ErriezDS3231::bcdToDec(regs[2] & 0x3F) + 1;
+        if (hour >= 24) {
+            hour = 0;
+            newDay = true;
+        }
+        regs[2] = ErriezDS3231::decToBcd(hour);
+    }
+
+    if (newDay) {
+        // Day of the week 1..7
+        regs[3] = (regs[3] & 0x07) % 7 + 1;
+
+        // Date, month and year with leap years and century
+        mday = ErriezDS3231::bcdToDec(regs[4] & 0x3F) + 1;
+        mon = ErriezDS3231::bcdToDec(regs[5] & 0x1F);
+        year = ErriezDS3231::bcdToDec(regs[6]);
+        dim = ((mon >= 1) && (mon <= 12)) ? daysInMonth[mon - 1] : 31;
+        if ((mon == 2) && ((year % 4) == 0)) {
+            dim++;
+        }
+        if (mday > dim) {
+            mday = 1;
+            if (++mon > 12) {
+                mon = 1;
+                if (++year > 99) {
+                    year = 0;
+                    regs[5] ^= (1 << DS3231_MONTH_CENTURY);
+                }
+                regs[6] = ErriezDS3231::decToBcd(year);
+            }
+            regs[5] = (regs[5] & (1 << DS3231_MONTH_CENTURY)) | ErriezDS3231::decToBcd(mon);
+        }
+        regs[4] = ErriezDS3231::decToBcd(mday);
+    }
+
+    checkAlarms();
+}
+
+/*!
+ * \brief Set alarm flags when the time registers match the alarm registers.
+ * \details
+ *      Alarm 2 has no seconds register and is only checked at seconds 00.
+ */
+void ErriezDS3231Simulator::checkAlarms()
+{
+    const uint8_t *regs = _regs;
+    uint8_t dayDate;
+
+    // Alarm 1
+    dayDate = regs[DS3231_REG_ALARM1_DD];
+    if (((regs[DS3231_REG_ALARM1_SEC] & (1 << DS3231_A1M1)) ||
+         ((regs[DS3231_REG_ALARM1_SEC] & 0x7F) == regs[DS3231_REG_SECONDS])) &&
+        ((regs[DS3231_REG_ALARM1_MIN] & (1 << DS3231_A1M2)) ||
+         ((regs[DS3231_REG_ALARM1_MIN] & 0x7F) == regs[DS3231_REG_MINUTES])) &&
+        ((regs[DS3231_REG_ALARM1_HOUR] & (1 << DS3231_A1M3)) ||
+         ((regs[DS3231_REG_ALARM1_HOUR] & 0x7F) == regs[DS3231_REG_HOURS])) &&
+        ((dayDate & (1 << DS3231_A1M4)) ||
+         ((dayDate & (1 << DS3231_DYDT)) ? ((dayDate & 0x0F) == regs[DS3231_REG_DAY_WEEK]) :
+                                           ((dayDate & 0x3F) == regs[DS3231_REG_DAY_MONTH])))) {
+        _regs[DS3231_REG_STATUS] |= (1 << DS3231_STAT_A1F);
+        _alarm1Matches++;
+    }
+
+    // Alarm 2
+    if (regs[DS3231_REG_SECONDS] != 0x00) {
+        return;
+    }
+    dayDate = regs[DS3231_REG_ALARM2_DD];
+    if (((regs[DS3231_REG_ALARM2_MIN] & (1 << DS3231_A2M2)) ||
+         ((regs[DS3231_REG_ALARM2_MIN] & 0x7F) == regs[DS3231_REG_MINUTES])) &&
+        ((regs[DS3231_REG_ALARM2_HOUR] & (1 << DS3231_A2M3)) ||
+         ((regs[DS3231_REG_ALARM2_HOUR] & 0x7F) == regs[DS3231_REG_HOURS])) &&
+        ((dayDate & (1 << DS3231_A2M4)) ||
+         ((dayDate & (1 << DS3231_DYDT)) ? ((dayDate & 0x0F) == regs[DS3231_REG_DAY_WEEK]) :
+                                           ((dayDate & 0x3F) == regs[DS3231_REG_DAY_MONTH])))) {
+        _regs[DS3231_REG_STATUS] |= (1 << DS3231_STAT_A2F);
+        _alarm2Matches++;
+    }
+}
+
+/*!
+ * \brief Set oscillator frequency error.
+ * \details
+ *      The aging offset register changes the frequency by DS3231_SIM_AGING_PPB per LSB at the
+ *      end of the next temperature conversion.
+ * \param ppb
+ *      Frequency error without aging offset in ppb, positive: RTC runs fast.
+ */
+void ErriezDS3231Simulator::setFrequencyError(int32_t ppb)
+{
+    _oscError = ppb;
+}
+
+/*!
+ * \brief Get oscillator frequency error.
+ * \return
+ *      Frequency error including the applied aging offset in ppb, positive: RTC runs fast.
+ */
+int32_t ErriezDS3231Simulator::getFrequencyError()
+{
+    return _oscError - (int32_t)_agingApplied * DS3231_SIM_AGING_PPB;
+}
+
+/*!
+ * \brief Start temperature conversion and set BSY.
+ */
+void ErriezDS3231Simulator::startConversion()
+{
+    _regs[DS3231_REG_STATUS] |= (1 << DS3231_STAT_BSY);
+    _convRemaining = _convTime;
+}
+
+/*!
+ * \brief Complete temperature conversion: update temperature registers, clear BSY and CONV and
+ *        apply the aging offset.
+ */
+void ErriezDS3231Simulator::finishConversion()
+{
+    uint16_t raw = (uint16_t)_temperature << 6;
+
+    _regs[DS3231_REG_TEMP_MSB] = (uint8_t)(raw >> 8);
+    _regs[DS3231_REG_TEMP_LSB] = (uint8_t)(raw & 0xC0);
+    _regs[DS3231_REG_STATUS] &= ~(1 << DS3231_STAT_BSY);
+    _regs[DS3231_REG_CONTROL] &= ~(1 << DS3231_CTRL_CONV);
+    _convRemaining = 0;
+
+    // The capacitance array is updated with the aging offset
+    _agingApplied = (int8_t)_regs[DS3231_REG_AGING_OFFSET];
+}
+
+/*!
+ * \brief Constructor.
+ * \details
+ *      All channels are disconnected, like after a power-on reset.
+ * \param addr
+ *      Mux 7-bit I2C address.
+ */
+ErriezDS3231MuxSimulator::ErriezDS3231MuxSimulator(uint8_t addr) :
+    _addr(addr), _control(0), _now(0)
+{
+    memset(_devices, 0, sizeof(_devices));
+    resetCounters();
+}
+
+/*!
+ * \brief Write control register, or forward write to the selected devices.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number, control register value for the mux.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      true: Generate stop. false: Keep bus for a repeated start by readBurst().
+ * \return
+ *      DS3231_BUS_OK when at least one device acknowledged, DS3231_BUS_ERR_... otherwise.
+ */
+uint8_t ErriezDS3231MuxSimulator::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                             uint8_t len, bool stop)
+{
+    uint8_t result = DS3231_BUS_ERR_NACK_ADDR;
+    uint8_t deviceResult;
+
+    if (addr == _addr) {
+        // Every byte is written to the control register
+        _control = (len > 0) ? buffer[len - 1] : reg;
+        _controlWrites++;
+        _transactions++;
+        return DS3231_BUS_OK;
+    }
+
+    for (uint8_t channel = 0; channel < DS3231_MUX_CHANNELS; channel++) {
+        if ((_control & (1 << channel)) && _devices[channel]) {
+            deviceResult = _devices[channel]->writeBurst(addr, reg, buffer, len, stop);
+            if ((result != DS3231_BUS_OK) && (deviceResult != DS3231_BUS_ERR_NACK_ADDR)) {
+                result = deviceResult;
+            }
+        }
+    }
+
+    if (stop || (result != DS3231_BUS_OK)) {
+        _transactions++;
+    }
+
+    return result;
+}
+
+/*!
+ * \brief Read control register, or read from the selected devices.
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231MuxSimulator::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    uint8_t data[DS3231_NUM_REGS + 1];
+    uint8_t received = 0;
+    uint8_t deviceReceived;
+    bool first = true;
+
+    _transactions++;
+
+    if (addr == _addr) {
+        for (uint8_t i = 0; i < len; i++) {
+            buffer[i] = _control;
+        }
+        return len;
+    }
+
+    if (len > sizeof(data)) {
+        return 0;
+    }
+
+    for (uint8_t channel = 0; channel < DS3231_MUX_CHANNELS; channel++) {
+        if (!(_control & (1 << channel)) || !_devices[channel]) {
+            continue;
+        }
+        deviceReceived = _devices[channel]->readBurst(addr, data, len);
+        if (deviceReceived == 0) {
+            continue;
+        }
+
+        // Open-drain bus: a zero bit of any device wins
+        for (uint8_t i = 0; i < len; i++) {
+            buffer[i] = first ? data[i] : (uint8_t)(buffer[i] & data[i]);
+        }
+        if (deviceReceived > received) {
+            received = deviceReceived;
+        }
+        first = false;
+    }
+
+    return received;
+}
+
+/*!
+ * \brief Bus clear on all devices.
+ * \return
+ *      true when all devices released the bus.
+ */
+bool ErriezDS3231MuxSimulator::busClear()
+{
+    bool released = true;
+
+    for (uint8_t channel = 0; channel < DS3231_MUX_CHANNELS; channel++) {
+        if (_devices[channel] && !_devices[channel]->busClear()) {
+            released = false;
+        }
+    }
+
+    return released;
+}
+
+/*!
+ * \brief Connect a simulated RTC to a channel.
+ * \param channel
+ *      Channel 0..7.
+ * \param device
+ *      Simulated RTC, NULL to disconnect.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Invalid channel.
+ */
+bool ErriezDS3231MuxSimulator::attach(uint8_t channel, ErriezDS3231Simulator *device)
+{
+    if (channel >= DS3231_MUX_CHANNELS) {
+        return false;
+    }
+    _devices[channel] = device;
+
+    return true;
+}
+
+/*!
+ * \brief Get control register.
+ * \return
+ *      Selected channels, bit 0: channel 0.
+ */
+uint8_t ErriezDS3231MuxSimulator::getControl()
+{
+    return _control;
+}
+
+/*!
+ * \brief Advance virtual time of the mux and all devices.
+ * \param us
+ *      Microseconds.
+ */
+void ErriezDS3231MuxSimulator::advance(uint32_t us)
+{
+    _now += us;
+
+    for (uint8_t channel = 0; channel < DS3231_MUX_CHANNELS; channel++) {
+        if (_devices[channel]) {
+            _devices[channel]->advance(us);
+        }
+    }
+}
+
+/*!
+ * \brief Get virtual time.
+ * \return
+ *      Microseconds, wraps after 71 minutes.
+ */
+uint32_t ErriezDS3231MuxSimulator::getMicros()
+{
+    return (uint32_t)_now;
+}
+
+/*!
+ * \brief Get number of I2C transactions.
+ * \return
+ *      Transactions, including control register writes.
+ */
+uint32_t ErriezDS3231MuxSimulator::getTransactions()
+{
+    return _transactions;
+}
+
+/*!
+ * \brief Get number of control register writes.
+ * \return
+ *      Channel switches.
+ */
+uint32_t ErriezDS3231MuxSimulator::getControlWrites()
+{
+    return _controlWrites;
+}
+
+/*!
+ * \brief Reset counters.
+ */
+void ErriezDS3231MuxSimulator::resetCounters()
+{
+    _transactions = 0;
+    _controlWrites = 0;
+}
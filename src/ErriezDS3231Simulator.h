@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Simulator.h
+ * \brief DS3231 high precision RTC library: behavioural DS3231 simulator
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_SIMULATOR_H_
+#define ERRIEZ_DS3231_SIMULATOR_H_
+
+#include "ErriezDS3231.h"
+
+//! Default temperature conversion time in us (datasheet tCONV max)
+#define DS3231_SIM_CONV_TIME_US     200000UL
+
+//! Automatic temperature conversion interval in seconds
+#define DS3231_SIM_CONV_INTERVAL    64
+
+//! Oscillator frequency change per aging offset LSB in ppb, positive values slow it down
+#define DS3231_SIM_AGING_PPB        100
+
+/*!
+ * \brief Injectable bus faults
+ */
+typedef enum {
+    SimFaultNone = 0,           //!< No fault
+    SimFaultNackAddress = 1,    //!< Address not acknowledged
+    SimFaultNackData = 2,       //!< Register pointer acknowledged, data not acknowledged
+    SimFaultShortRead = 3,      //!< Read returns half of the requested bytes
+    SimFaultTimeout = 4,        //!< Bus timeout
+    SimFaultBusStuck = 5,       //!< SDA held low: all transfers time out until busClear()
+} SimFault;
+
+/*!
+ * \brief Behavioural DS3231 simulator
+ * \details
+ *      Implements the bus transport interface on top of a model of the DS3231 register file
+ *      0x00..0x12 with register pointer auto-increment, BCD time keeping with rollover, alarm
+ *      matching, OSF/EOSC behaviour, temperature conversions with BSY timing and injectable bus
+ *      faults. Time is virtual and only advances by advance(), advanceSeconds() and optionally by
+ *      the duration of bus transfers, so years of operation can be simulated in seconds.
+ *      The simulator has no platform dependencies and can be linked on a Linux host.
+ */
+class ErriezDS3231Simulator : public ErriezDS3231Transport
+{
+public:
+    ErriezDS3231Simulator();
+
+    // Bus transport interface
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+    bool busClear();
+
+    // Power
+    void powerOnReset();
+    void setBatteryPower(bool onBattery);
+    void setOscillatorFault(bool fault);
+    bool isOscillatorRunning();
+
+    // Virtual time
+    void advance(uint32_t us);
+    void advanceSeconds(uint32_t seconds);
+    uint32_t getMicros();
+    uint32_t getMillis();
+    uint32_t getSubsecondMicros();
+    void setBusClock(uint32_t hz);
+
+    // Register file
+    uint8_t getRegister(uint8_t reg);
+    void setRegister(uint8_t reg, uint8_t value);
+    bool setEpoch(time_t t);
+    bool getEpoch(time_t *t);
+
+    // Temperature
+    void setTemperature(int16_t quarterDegrees);
+    void setConversionTime(uint32_t us);
+
+    // Oscillator frequency
+    void setFrequencyError(int32_t ppb);
+    int32_t getFrequencyError();
+
+    // Interrupt/square wave output pin
+    bool getIntSqwPin();
+
+    // Fault injection
+    void injectFault(SimFault fault, uint16_t count=1, uint16_t skip=0);
+
+    // Counters
+    uint32_t getTransactions();
+    uint32_t getBytesWritten();
+    uint32_t getBytesRead();
+    uint32_t getFaults();
+    uint32_t getAlarmMatches(AlarmId alarmId);
+    void resetCounters();
+
+private:
+    uint8_t _regs[DS3231_NUM_REGS];     //!< Register file
+    uint8_t _pointer;                   //!< Register pointer
+    bool _transfer;                     //!< Transfer with repeated start in progress
+
+    uint64_t _now;                      //!< Virtual time in us
+    uint32_t _phase;                    //!< Position in the current RTC second in us
+    int64_t _phaseFraction;             //!< Phase remainder in 1e-9 us
+    int32_t _oscError;                  //!< Oscillator frequency error without aging in ppb
+    int8_t _agingApplied;               //!< Aging offset applied by the last conversion
+    uint32_t _busClock;                 //!< Bus clock in Hz, 0: transfers take no time
+    bool _onBattery;                    //!< Powered from V-BAT
+    bool _oscFault;                     //!< External oscillator fault
+
+    int16_t _temperature;               //!< Die temperature in 0.25 degree Celsius
+    uint32_t _convTime;                 //!< Temperature conversion time in us
+    uint32_t _convRemaining;            //!< Remaining conversion time in us, 0: idle
+    uint8_t _convSeconds;               //!< Seconds since last automatic conversion
+
+    SimFault _fault;                    //!< Injected fault
+    uint16_t _faultSkip;                //!< Transfers before the fault is active
+    uint16_t _faultCount;               //!< Number of transfers to fail
+
+    uint32_t _transactions;             //!< Number of I2C transactions
+    uint32_t _bytesWritten;             //!< Bytes written, including register pointer
+    uint32_t _bytesRead;                //!< Bytes read
+    uint32_t _faults;                   //!< Number of failed transfers
+    uint32_t _alarm1Matches;            //!< Number of alarm 1 matches
+    uint32_t _alarm2Matches;            //!< Number of alarm 2 matches
+
+    SimFault nextFault(bool read);
+    void writeRegisterValue(uint8_t reg, uint8_t value);
+    void busTime(uint8_t bytes);
+    uint32_t drift(uint32_t us);
+    void tick();
+    void checkAlarms();
+    void startConversion();
+    void finishConversion();
+};
+
+/*!
+ * \brief TCA9548A I2C multiplexer simulator
+ * \details
+ *      Forwards transfers to the simulated RTCs on the selected channels. Reads from more than
+ *      one selected device return the wired-AND of the data, like an open-drain bus. All devices
+ *      share the virtual time of the mux.
+ */
+class ErriezDS3231MuxSimulator : public ErriezDS3231Transport
+{
+public:
+    explicit ErriezDS3231MuxSimulator(uint8_t addr=DS3231_MUX_ADDR);
+
+    // Bus transport interface
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+    bool busClear();
+
+    // Devices
+    bool attach(uint8_t channel, ErriezDS3231Simulator *device);
+    uint8_t getControl();
+
+    // Virtual time
+    void advance(uint32_t us);
+    uint32_t getMicros();
+
+    // Counters
+    uint32_t getTransactions();
+    uint32_t getControlWrites();
+    void resetCounters();
+
+private:
+    ErriezDS3231Simulator *_devices[DS3231_MUX_CHANNELS];  //!< Device per channel
+    uint8_t _addr;                      //!< Mux I2C address
+    uint8_t _control;                   //!< Control register: selected channels
+    uint64_t _now;                      //!< Virtual time in us
+    uint32_t _transactions;             //!< Number of I2C transactions, including the mux
+    uint32_t _controlWrites;            //!< Number of control register writes
+};
+
+#endif // ERRIEZ_DS3231_SIMULATOR_H_
@@ -0,0 +1,226 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Sleep.cpp
+ * \brief DS3231 high precision RTC library for Arduino: low-energy alarm 1 wake-up
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#include "ErriezDS3231Sleep.h"
+
+//! Index of a register in the register images
+#define SLEEP_INDEX(reg)    ((reg) - DS3231_REG_ALARM1_SEC)
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ */
+ErriezDS3231Sleep::ErriezDS3231Sleep(ErriezDS3231 *rtc) :
+    _rtc(rtc), _wakeControl(0), _valid(false), _armed(false), _alarmWake(false), _wakeup(0),
+    _epoch(0), _status(0), _transactions(0)
+{
+    memset(_image, 0, sizeof(_image));
+}
+
+/*!
+ * \brief Precompute register images.
+ * \details
+ *      Reads alarm 2, control and status registers 0x0B..0x0F in one transaction. Alarm 2 and
+ *      the A2IE and rate select bits are kept. The oscillator remains enabled on V-BAT.
+ * \param batteryWake
+ *      true: Set BBSQW, the alarm drives the INT/SQW pin when the RTC runs from V-BAT.\n
+ *      false: INT/SQW pin is high impedance on V-BAT, which saves battery current.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      RTC read failed.
+ */
+bool ErriezDS3231Sleep::begin(bool batteryWake)
+{
+    uint8_t control;
+
+    _valid = false;
+    _armed = false;
+
+    if (!_rtc->readBuffer(DS3231_REG_ALARM2_MIN, &_image[SLEEP_INDEX(DS3231_REG_ALARM2_MIN)],
+                          DS3231_REG_STATUS - DS3231_REG_ALARM2_MIN + 1)) {
+        return false;
+    }
+
+    // Alarm interrupt output, alarm 1 interrupt enabled, EOSC and CONV cleared
+    control = _image[SLEEP_INDEX(DS3231_REG_CONTROL)];
+    control &= (1 << DS3231_CTRL_RS2) | (1 << DS3231_CTRL_RS1) | (1 << DS3231_CTRL_A2IE);
+    control |= (1 << DS3231_CTRL_INTCN) | (1 << DS3231_CTRL_A1IE);
+    if (batteryWake) {
+        control |= (1 << DS3231_CTRL_BBSQW);
+    }
+    _image[SLEEP_INDEX(DS3231_REG_CONTROL)] = control;
+    _wakeControl = control & ~(1 << DS3231_CTRL_A1IE);
+
+    // Clear A1F, keep OSF and A2F, disable 32kHz output
+    _image[SLEEP_INDEX(DS3231_REG_STATUS)] = DS3231_STAT_KEEP & ~(1 << DS3231_STAT_A1F);
+
+    _valid = true;
+
+    return true;
+}
+
+/*!
+ * \brief Arm alarm 1 wake-up.
+ * \details
+ *      Writes registers 0x07..0x0F in one I2C transaction. Alarm 1 matches date, hours, minutes
+ *      and seconds, so the wake-up must be within 28 days after the current RTC time. A wake-up
+ *      time which has already passed results in a wake-up next month.
+ * \param t
+ *      Wake-up time as Unix epoch, for example getWakeEpoch() + period.
+ * \retval true
+ *      Success.
+ * \retval false
+ *      Not initialized or RTC write failed.
+ */
+bool ErriezDS3231Sleep::sleepUntil(time_t t)
+{
+    uint32_t wakeup = (uint32_t)t;
+    uint16_t year;
+    uint8_t mon;
+    uint8_t mday;
+
+    if (!_valid) {
+        return false;
+    }
+
+    // Alarm at date, hours, minutes and seconds of the wake-up time
+    ErriezDS3231::civilFromDays((uint16_t)(wakeup / 86400UL), &year, &mon, &mday);
+    ErriezDS3231::encodeAlarm1Registers(Alarm1MatchDate, mday, (wakeup / 3600UL) % 24,
+                                        (wakeup / 60) % 60, wakeup % 60, _image);
+
+    // Start of a new cycle
+    _transactions = 1;
+    _armed = false;
+
+    if (!_rtc->writeBuffer(DS3231_REG_ALARM1_SEC, _image, sizeof(_image))) {
+        return false;
+    }
+
+    _wakeup = wakeup;
+    _armed = true;
+
+    return true;
+}
+
+/*!
+ * \brief Handle wake-up.
+ * \details
+ *      Disables the alarm 1 interrupt and clears A1F, which releases the INT/SQW pin, and reads
+ *      all registers in one I2C transaction.
+ * \retval true
+ *      Success, use isAlarmWake(), getWakeEpoch() and getStatus().
+ * \retval false
+ *      Not initialized, RTC transfer failed or invalid date/time.
+ */
+bool ErriezDS3231Sleep::onWake()
+{
+    uint8_t images[2];
+    uint8_t buffer[DS3231_SLEEP_WAKE_LEN];
+    time_t t;
+
+    if (!_valid) {
+        return false;
+    }
+
+    images[0] = _wakeControl;
+    images[1] = _image[SLEEP_INDEX(DS3231_REG_STATUS)];
+
+    // Write control and status, read 0x10..0x12 and 0x00..0x0F
+    _transactions++;
+    if (!_rtc->writeReadBuffer(DS3231_REG_CONTROL, images, sizeof(images),
+                               buffer, sizeof(buffer))) {
+        return false;
+    }
+
+    _status = buffer[DS3231_NUM_REGS - DS3231_REG_AGING_OFFSET + DS3231_REG_STATUS];
+    if (!ErriezDS3231::decodeEpochRegisters(&buffer[DS3231_NUM_REGS - DS3231_REG_AGING_OFFSET],
+                                            &t)) {
+        return false;
+    }
+    _epoch = (uint32_t)t;
+
+    // A1F is cleared by the write, the alarm fired when the wake-up time has been reached
+    _alarmWake = _armed && ((int32_t)(_epoch - _wakeup) >= 0);
+    _armed = false;
+
+    return true;
+}
+
+/*!
+ * \brief Check wake-up source.
+ * \retval true
+ *      The armed wake-up time was reached at the last onWake().
+ * \retval false
+ *      Woken up before the alarm, or not armed.
+ */
+bool ErriezDS3231Sleep::isAlarmWake()
+{
+    return _alarmWake;
+}
+
+/*!
+ * \brief Get RTC time read by the last onWake().
+ * \return
+ *      Unix epoch.
+ */
+time_t ErriezDS3231Sleep::getWakeEpoch()
+{
+    return (time_t)_epoch;
+}
+
+/*!
+ * \brief Get status register read by the last onWake().
+ * \details
+ *      A1F is already cleared. Check DS3231_STAT_OSF for an oscillator stop during sleep.
+ * \return
+ *      Status register 0x0F.
+ */
+uint8_t ErriezDS3231Sleep::getStatus()
+{
+    return _status;
+}
+
+/*!
+ * \brief Get number of I2C transactions of the last sleep cycle.
+ * \details
+ *      Counts sleepUntil() and onWake() transfers, without bus retries.
+ * \return
+ *      Number of transactions since the last sleepUntil().
+ */
+uint8_t ErriezDS3231Sleep::getTransactions()
+{
+    return _transactions;
+}
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Sleep.h
+ * \brief DS3231 high precision RTC library for Arduino: low-energy alarm 1 wake-up
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_SLEEP_H_
+#define ERRIEZ_DS3231_SLEEP_H_
+
+#include "ErriezDS3231.h"
+
+//! Number of registers written by sleepUntil(): alarm 1, alarm 2, control and status
+#define DS3231_SLEEP_ARM_LEN    (DS3231_REG_STATUS - DS3231_REG_ALARM1_SEC + 1)
+
+//! Number of registers read by onWake(): 0x10..0x12 and 0x00..0x0F
+#define DS3231_SLEEP_WAKE_LEN   DS3231_NUM_REGS
+
+/*!
+ * \brief Low-energy alarm 1 wake-up
+ * \details
+ *      begin() reads the alarm 2, control and status registers once and precomputes the register
+ *      images 0x07..0x0F. Each sleep cycle then takes two I2C transactions:
+ *
+ *      sleepUntil() writes alarm 1 and the precomputed alarm 2, control and status images in one
+ *      burst: INTCN and A1IE set, A1F cleared, 32kHz output disabled and optionally BBSQW set,
+ *      so the INT/SQW pin also wakes the MCU while the RTC runs from V-BAT.
+ *
+ *      onWake() writes the control and status images with A1IE and A1F cleared, followed by a
+ *      repeated start read of all registers, so the date/time and status are available without
+ *      further transactions.
+ *
+ *      Call begin() again after changing alarm 2 or the square wave frequency.
+ */
+class ErriezDS3231Sleep
+{
+public:
+    explicit ErriezDS3231Sleep(ErriezDS3231 *rtc);
+
+    bool begin(bool batteryWake=true);
+    bool sleepUntil(time_t t);
+    bool onWake();
+
+    bool isAlarmWake();
+    time_t getWakeEpoch();
+    uint8_t getStatus();
+    uint8_t getTransactions();
+
+private:
+    ErriezDS3231 *_rtc;                         //!< RTC
+    uint8_t _image[DS3231_SLEEP_ARM_LEN];       //!< Register images 0x07..0x0F
+    uint8_t _wakeControl;                       //!< Control register image for onWake()
+    bool _valid;                                //!< Register images valid
+    bool _armed;                                //!< Alarm 1 armed by sleepUntil()
+    bool _alarmWake;                            //!< Wake time reached
+    uint32_t _wakeup;                           //!< Armed wake-up epoch
+    uint32_t _epoch;                            //!< Epoch read by onWake()
+    uint8_t _status;                            //!< Status register read by onWake()
+    uint8_t _transactions;                      //!< I2C transactions in the last cycle
+};
+
+#endif // ERRIEZ_DS3231_SLEEP_H_
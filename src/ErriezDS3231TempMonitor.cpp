@@ -0,0 +1,286 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231TempMonitor.cpp
+ * \brief DS3231 high precision RTC library for Arduino: non-blocking temperature conversions
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include "ErriezDS3231TempMonitor.h"
+
+/*!
+ * \brief Constructor.
+ * \param rtc
+ *      Initialized RTC object.
+ * \param history
+ *      Ring buffer with results.
+ * \param historySize
+ *      Number of results in the ring buffer 1..255.
+ */
+ErriezDS3231TempMonitor::ErriezDS3231TempMonitor(ErriezDS3231 *rtc, int16_t *history,
+                                                 uint8_t historySize) :
+    _rtc(rtc), _history(history), _historySize(historySize), _busy(false), _errors(0)
+{
+    resetStatistics();
+}
+
+/*!
+ * \brief Start temperature conversion.
+ * \details
+ *      When the RTC is busy with an automatic conversion, the result of that conversion is used.
+ * \retval true
+ *      Conversion started or in progress.
+ * \retval false
+ *      I2C transfer failed.
+ */
+bool ErriezDS3231TempMonitor::start()
+{
+    uint8_t regs[2];
+
+    if (_busy) {
+        return true;
+    }
+
+    // Read control and status registers
+    if (!_rtc->readBuffer(DS3231_REG_CONTROL, regs, sizeof(regs))) {
+        _errors++;
+        return false;
+    }
+
+    // Start conversion when the RTC is not busy
+    if (!(regs[0] & (1 << DS3231_CTRL_CONV)) && !(regs[1] & (1 << DS3231_STAT_BSY))) {
+        regs[0] |= (1 << DS3231_CTRL_CONV);
+        if (!_rtc->writeBuffer(DS3231_REG_CONTROL, regs, 1)) {
+            _errors++;
+            return false;
+        }
+    }
+
+    _busy = true;
+
+    return true;
+}
+
+/*!
+ * \brief Check conversion and store the result.
+ * \details
+ *      Call this function periodically from loop() after start(). Every call is one I2C
+ *      transfer of 5 registers.
+ * \param centiDegrees
+ *      Optional result in 0.01 degree Celsius.
+ * \retval true
+ *      Conversion completed, result stored.
+ * \retval false
+ *      No conversion started, conversion in progress or I2C transfer failed.
+ */
+bool ErriezDS3231TempMonitor::poll(int16_t *centiDegrees)
+{
+    uint8_t regs[5];
+    int16_t result;
+
+    if (!_busy) {
+        return false;
+    }
+
+    // Read control, status, aging offset and temperature registers
+    if (!_rtc->readBuffer(DS3231_REG_CONTROL, regs, sizeof(regs))) {
+        _errors++;
+        return false;
+    }
+
+    // Conversion in progress
+    if ((regs[0] & (1 << DS3231_CTRL_CONV)) || (regs[1] & (1 << DS3231_STAT_BSY))) {
+        return false;
+    }
+    _busy = false;
+
+    // 10-bit two's complement temperature in 0.25 degree Celsius
+    result = (int16_t)((int16_t)((regs[3] << 8) | regs[4]) >> 6) * 25;
+    add(result);
+
+    if (centiDegrees) {
+        *centiDegrees = result;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Check if a conversion is in progress.
+ * \retval true
+ *      Conversion started, result not yet stored.
+ * \retval false
+ *      Idle.
+ */
+bool ErriezDS3231TempMonitor::isBusy()
+{
+    return _busy;
+}
+
+/*!
+ * \brief Get number of failed I2C transfers.
+ * \return
+ *      Number of errors.
+ */
+uint16_t ErriezDS3231TempMonitor::getErrors()
+{
+    return _errors;
+}
+
+/*!
+ * \brief Get number of results in the ring buffer.
+ * \return
+ *      Number of results.
+ */
+uint8_t ErriezDS3231TempMonitor::getCount()
+{
+    return _count;
+}
+
+/*!
+ * \brief Get result from the ring buffer.
+ * \param index
+ *      0: Oldest result, getCount() - 1: Newest result.
+ * \return
+ *      Temperature in 0.01 degree Celsius, 0 when the index is out of range.
+ */
+int16_t ErriezDS3231TempMonitor::getHistory(uint8_t index)
+{
+    uint16_t pos;
+
+    if (index >= _count) {
+        return 0;
+    }
+
+    pos = (uint16_t)_head + _historySize - _count + index;
+    if (pos >= _historySize) {
+        pos -= _historySize;
+    }
+
+    return _history[pos];
+}
+
+/*!
+ * \brief Get last result.
+ * \return
+ *      Temperature in 0.01 degree Celsius, 0 without results.
+ */
+int16_t ErriezDS3231TempMonitor::getLast()
+{
+    return _count ? getHistory(_count - 1) : 0;
+}
+
+/*!
+ * \brief Get minimum result since resetStatistics().
+ * \return
+ *      Temperature in 0.01 degree Celsius, 0 without results.
+ */
+int16_t ErriezDS3231TempMonitor::getMin()
+{
+    return _conversions ? _min : 0;
+}
+
+/*!
+ * \brief Get maximum result since resetStatistics().
+ * \return
+ *      Temperature in 0.01 degree Celsius, 0 without results.
+ */
+int16_t ErriezDS3231TempMonitor::getMax()
+{
+    return _conversions ? _max : 0;
+}
+
+/*!
+ * \brief Get mean of the results in the ring buffer.
+ * \return
+ *      Temperature in 0.01 degree Celsius, 0 without results.
+ */
+int16_t ErriezDS3231TempMonitor::getMean()
+{
+    if (!_count) {
+        return 0;
+    }
+
+    // Round to nearest
+    if (_sum < 0) {
+        return (int16_t)((_sum - (_count / 2)) / _count);
+    }
+
+    return (int16_t)((_sum + (_count / 2)) / _count);
+}
+
+/*!
+ * \brief Get number of results since resetStatistics().
+ * \return
+ *      Number of completed conversions.
+ */
+uint32_t ErriezDS3231TempMonitor::getConversions()
+{
+    return _conversions;
+}
+
+/*!
+ * \brief Clear ring buffer and statistics.
+ */
+void ErriezDS3231TempMonitor::resetStatistics()
+{
+    _head = 0;
+    _count = 0;
+    _sum = 0;
+    _min = 32767;
+    _max = -32768;
+    _conversions = 0;
+}
+
+/*!
+ * \brief Store result in ring buffer and update statistics.
+ * \param centiDegrees
+ *      Temperature in 0.01 degree Celsius.
+ */
+void ErriezDS3231TempMonitor::add(int16_t centiDegrees)
+{
+    if (_count == _historySize) {
+        // Remove oldest result from the sum
+        _sum -= _history[_head];
+    } else {
+        _count++;
+    }
+
+    _history[_head] = centiDegrees;
+    _sum += centiDegrees;
+    if (++_head >= _historySize) {
+        _head = 0;
+    }
+
+    if (centiDegrees < _min) {
+        _min = centiDegrees;
+    }
+    if (centiDegrees > _max) {
+        _max = centiDegrees;
+    }
+    _conversions++;
+}
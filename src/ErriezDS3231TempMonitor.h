@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231TempMonitor.h
+ * \brief DS3231 high precision RTC library for Arduino: non-blocking temperature conversions
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_TEMP_MONITOR_H_
+#define ERRIEZ_DS3231_TEMP_MONITOR_H_
+
+#include "ErriezDS3231.h"
+
+/*!
+ * \brief Non-blocking temperature conversions with history and statistics
+ * \details
+ *      start() starts a temperature conversion, or waits for a conversion which is already
+ *      running. poll() reads the control, status and temperature registers 0x0E..0x12 in one
+ *      I2C transfer and returns the result when CONV and BSY are clear, so completion and result
+ *      do not need separate transfers. A conversion takes up to 200ms.
+ *
+ *      Temperatures are 16-bit signed values in 0.01 degree Celsius, without floating point.
+ *      Results are stored in an application supplied ring buffer. Minimum and maximum are kept
+ *      over all results, the mean over the results in the ring buffer.
+ */
+class ErriezDS3231TempMonitor
+{
+public:
+    ErriezDS3231TempMonitor(ErriezDS3231 *rtc, int16_t *history, uint8_t historySize);
+
+    // Conversion
+    bool start();
+    bool poll(int16_t *centiDegrees=NULL);
+    bool isBusy();
+    uint16_t getErrors();
+
+    // History
+    uint8_t getCount();
+    int16_t getHistory(uint8_t index);
+
+    // Statistics
+    int16_t getLast();
+    int16_t getMin();
+    int16_t getMax();
+    int16_t getMean();
+    uint32_t getConversions();
+    void resetStatistics();
+
+private:
+    ErriezDS3231 *_rtc;         //!< RTC object
+    int16_t *_history;          //!< Ring buffer with results
+    uint8_t _historySize;       //!< Ring buffer size
+    uint8_t _head;              //!< Index of the next result
+    uint8_t _count;             //!< Number of results in the ring buffer
+    int32_t _sum;               //!< Sum of the results in the ring buffer
+    int16_t _min;               //!< Minimum result
+    int16_t _max;               //!< Maximum result
+    uint32_t _conversions;      //!< Number of results
+    bool _busy;                 //!< Conversion in progress
+    uint16_t _errors;           //!< Number of failed I2C transfers
+
+    void add(int16_t centiDegrees);
+};
+
+#endif // ERRIEZ_DS3231_TEMP_MONITOR_H_
@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Transport.cpp
+ * \brief DS3231 high precision RTC library for Arduino: bus transports
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+#include "ErriezDS3231Transport.h"
+
+#ifdef ARDUINO
+/*!
+ * \brief Write register pointer and data to TwoWire.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      true: Generate stop. false: Keep bus for a repeated start.
+ * \return
+ *      TwoWire endTransmission() result.
+ */
+uint8_t ErriezDS3231WireTransport::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                              uint8_t len, bool stop)
+{
+    _wire.beginTransmission(addr);
+    _wire.write(reg);
+    for (uint8_t i = 0; i < len; i++) {
+        _wire.write(buffer[i]);
+    }
+    return _wire.endTransmission(stop);
+}
+
+/*!
+ * \brief Read data from TwoWire.
+ * \details
+ *      Bytes which are not received are left unchanged.
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231WireTransport::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    uint8_t received = _wire.requestFrom(addr, len);
+
+    if (received > len) {
+        received = len;
+    }
+    for (uint8_t i = 0; i < received; i++) {
+        buffer[i] = (uint8_t)_wire.read();
+    }
+
+    return received;
+}
+
+/*!
+ * \brief Configure bus clear pins.
+ * \param sdaPin
+ *      SDA pin.
+ * \param sclPin
+ *      SCL pin.
+ * \param clock
+ *      I2C clock in Hz, restored after the bus clear.
+ */
+void ErriezDS3231WireTransport::setBusClearPins(uint8_t sdaPin, uint8_t sclPin, uint32_t clock)
+{
+    _sdaPin = sdaPin;
+    _sclPin = sclPin;
+    _clock = clock;
+}
+
+/*!
+ * \brief Release a bus where a slave holds SDA low.
+ * \retval true
+ *      Bus released.
+ * \retval false
+ *      Pins not configured or bus still stuck.
+ */
+bool ErriezDS3231WireTransport::busClear()
+{
+    if (_sclPin == 0xFF) {
+        return false;
+    }
+
+    return busClearWire(_wire, _sdaPin, _sclPin, _clock);
+}
+
+/*!
+ * \brief Clear bus by clocking out SCL.
+ * \details
+ *      A slave interrupted in the middle of a read holds SDA low until it has shifted out the
+ *      remaining bits. SCL is clocked up to 9 times as open-drain output until SDA is released,
+ *      followed by a stop condition. The TwoWire object is initialized again afterwards.
+ * \param wire
+ *      TwoWire object.
+ * \param sdaPin
+ *      SDA pin.
+ * \param sclPin
+ *      SCL pin.
+ * \param clock
+ *      I2C clock in Hz.
+ * \retval true
+ *      Bus released.
+ * \retval false
+ *      SDA or SCL still held low.
+ */
+bool ErriezDS3231WireTransport::busClearWire(TwoWire &wire, uint8_t sdaPin, uint8_t sclPin,
+                                             uint32_t clock)
+{
+    bool released;
+
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_SAM)
+    // Release pins from the TWI peripheral
+    wire.end();
+#endif
+
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
+    delayMicroseconds(5);
+
+    // Clock out remaining bits until the slave releases SDA
+    for (uint8_t i = 0; (i < 9) && (digitalRead(sdaPin) == LOW); i++) {
+        digitalWrite(sclPin, LOW);
+        pinMode(sclPin, OUTPUT);
+        delayMicroseconds(5);
+        pinMode(sclPin, INPUT_PULLUP);
+        delayMicroseconds(5);
+    }
+
+    // Stop condition: SDA low to high while SCL is high
+    digitalWrite(sdaPin, LOW);
+    pinMode(sdaPin, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(sdaPin, INPUT_PULLUP);
+    delayMicroseconds(5);
+
+    released = (digitalRead(sdaPin) == HIGH) && (digitalRead(sclPin) == HIGH);
+
+    // Initialize TWI again
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+    wire.begin(sdaPin, sclPin);
+#else
+    wire.begin();
+#endif
+    wire.setClock(clock);
+
+    return released;
+}
+#endif
+
+/*!
+ * \brief Constructor.
+ * \param addr
+ *      7-bit I2C address to respond to.
+ */
+ErriezDS3231Loopback::ErriezDS3231Loopback(uint8_t addr) :
+    _addr(addr), _pointer(0)
+{
+    memset(regs, 0, sizeof(regs));
+}
+
+/*!
+ * \brief Write register pointer and data to register file.
+ * \param addr
+ *      7-bit I2C address.
+ * \param reg
+ *      Register number.
+ * \param buffer
+ *      Data, may be NULL when len is 0.
+ * \param len
+ *      Number of data bytes.
+ * \param stop
+ *      Unused.
+ * \return
+ *      DS3231_BUS_OK, or DS3231_BUS_ERR_NACK_ADDR for another I2C address.
+ */
+uint8_t ErriezDS3231Loopback::writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer,
+                                         uint8_t len, bool stop)
+{
+    (void)stop;
+
+    if (addr != _addr) {
+        return DS3231_BUS_ERR_NACK_ADDR;
+    }
+
+    _pointer = reg % sizeof(regs);
+    for (uint8_t i = 0; i < len; i++) {
+        regs[_pointer] = buffer[i];
+        _pointer = (_pointer + 1) % sizeof(regs);
+    }
+
+    return DS3231_BUS_OK;
+}
+
+/*!
+ * \brief Read data from register file.
+ * \details
+ *      The buffer is left unchanged when the address does not match.
+ * \param addr
+ *      7-bit I2C address.
+ * \param buffer
+ *      Data.
+ * \param len
+ *      Number of bytes to read.
+ * \return
+ *      Number of bytes received.
+ */
+uint8_t ErriezDS3231Loopback::readBurst(uint8_t addr, uint8_t *buffer, uint8_t len)
+{
+    if (addr != _addr) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < len; i++) {
+        buffer[i] = regs[_pointer];
+        _pointer = (_pointer + 1) % sizeof(regs);
+    }
+
+    return len;
+}
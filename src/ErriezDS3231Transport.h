@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Erriez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file ErriezDS3231Transport.h
+ * \brief DS3231 high precision RTC library for Arduino: bus transport interface
+ * \details
+ *      Source:         https://github.com/Erriez/ErriezDS3231
+ *      Documentation:  https://erriez.github.io/ErriezDS3231
+ */
+
+#ifndef ERRIEZ_DS3231_TRANSPORT_H_
+#define ERRIEZ_DS3231_TRANSPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Bus write result codes, compatible with Arduino Wire endTransmission()
+#define DS3231_BUS_OK           0       //!< Success
+#define DS3231_BUS_ERR_LENGTH   1       //!< Data too long for transmit buffer
+#define DS3231_BUS_ERR_NACK_ADDR 2      //!< NACK on transmit of address
+#define DS3231_BUS_ERR_NACK_DATA 3      //!< NACK on transmit of data
+#define DS3231_BUS_ERR_OTHER    4       //!< Other error
+#define DS3231_BUS_ERR_TIMEOUT  5       //!< Timeout
+
+/*!
+ * \brief Bus transport interface
+ * \details
+ *      The RTC uses the global Arduino Wire object directly by default. A transport is only
+ *      needed to access the RTC via another bus, such as Wire1, a DMA I2C driver, Linux i2c-dev
+ *      or an in-memory register file. The primitives follow the Arduino Wire semantics:
+ *      writeBurst() writes the register pointer followed by optional data, readBurst() reads
+ *      from the current register pointer.
+ */
+class ErriezDS3231Transport
+{
+public:
+    /*!
+     * \brief Write register pointer and data.
+     * \param addr
+     *      7-bit I2C address.
+     * \param reg
+     *      Register number.
+     * \param buffer
+     *      Data, may be NULL when len is 0.
+     * \param len
+     *      Number of data bytes.
+     * \param stop
+     *      true: Generate stop. false: Keep bus for a repeated start by readBurst().
+     * \return
+     *      DS3231_BUS_OK on success, or DS3231_BUS_ERR_... code.
+     */
+    virtual uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                               bool stop) = 0;
+
+    /*!
+     * \brief Read data from the current register pointer.
+     * \details
+     *      Bytes which are not received must be left unchanged.
+     * \param addr
+     *      7-bit I2C address.
+     * \param buffer
+     *      Data.
+     * \param len
+     *      Number of bytes to read.
+     * \return
+     *      Number of bytes received.
+     */
+    virtual uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len) = 0;
+
+    /*!
+     * \brief Get the error of the last readBurst().
+     * \details
+     *      Optional, for transports which transmit a register write without stop together with
+     *      the read. A read with less bytes received and without error is a short read.
+     * \return
+     *      DS3231_BUS_OK or DS3231_BUS_ERR_... code.
+     */
+    virtual uint8_t getReadError() { return DS3231_BUS_OK; }
+
+    /*!
+     * \brief Release a bus where a slave holds SDA low.
+     * \details
+     *      Optional, called by the bus error recovery of ErriezDS3231::setRetryPolicy().
+     * \retval true
+     *      Bus released.
+     * \retval false
+     *      Not supported or failed.
+     */
+    virtual bool busClear() { return false; }
+
+protected:
+    /*!
+     * \brief Destructor, not public because transports are never deleted via this interface.
+     */
+    ~ErriezDS3231Transport() { }
+};
+
+#ifdef ARDUINO
+#include <Wire.h>
+
+/*!
+ * \brief Arduino TwoWire bus transport for Wire1, Wire2, etc.
+ */
+class ErriezDS3231WireTransport : public ErriezDS3231Transport
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param wire
+     *      Initialized TwoWire object.
+     */
+    explicit ErriezDS3231WireTransport(TwoWire &wire) :
+        _wire(wire), _sdaPin(0xFF), _sclPin(0xFF), _clock(100000) { }
+
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+    bool busClear();
+
+    void setBusClearPins(uint8_t sdaPin, uint8_t sclPin, uint32_t clock=100000);
+    static bool busClearWire(TwoWire &wire, uint8_t sdaPin, uint8_t sclPin, uint32_t clock);
+
+private:
+    TwoWire &_wire;     //!< TwoWire object
+    uint8_t _sdaPin;    //!< Bus clear SDA pin
+    uint8_t _sclPin;    //!< Bus clear SCL pin, 0xFF: Not configured
+    uint32_t _clock;    //!< I2C clock restored after bus clear
+};
+#endif
+
+/*!
+ * \brief In-memory loopback transport
+ * \details
+ *      Emulates the DS3231 register file 0x00..0x12 including register pointer auto-increment,
+ *      without time keeping. Useful to run the library without hardware.
+ */
+class ErriezDS3231Loopback : public ErriezDS3231Transport
+{
+public:
+    explicit ErriezDS3231Loopback(uint8_t addr=0x68);
+
+    uint8_t writeBurst(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint8_t len,
+                       bool stop);
+    uint8_t readBurst(uint8_t addr, uint8_t *buffer, uint8_t len);
+
+    uint8_t regs[19];       //!< Register file, directly accessible
+
+private:
+    uint8_t _addr;          //!< I2C address
+    uint8_t _pointer;       //!< Register pointer
+};
+
+#endif // ERRIEZ_DS3231_TRANSPORT_H_